@@ -29,10 +29,18 @@ pc "$(oat frameserve gige --help)"
 ofs_g="$pc_res"
 pc "$(oat frameserve wcam --help)" 
 ofs_w="$pc_res"
+pc "$(oat frameserve v4l2 --help)" 
+ofs_v="$pc_res"
 pc "$(oat frameserve file --help)" 
 ofs_f="$pc_res"
+pc "$(oat frameserve raw --help)" 
+ofs_r="$pc_res"
+pc "$(oat frameserve images --help)" 
+ofs_i="$pc_res"
 pc "$(oat frameserve test --help)" 
 ofs_t="$pc_res"
+pc "$(oat frameserve synth --help)" 
+ofs_s="$pc_res"
 
 # oat-framefilt type configurations
 pc "$(oat framefilt bsub --help)" 
@@ -94,8 +102,12 @@ oca_h="$pc_res"
 awk -v ofs="$(oat frameserve --help)" \
     -v ofs_g="$ofs_g" \
     -v ofs_w="$ofs_w" \
+    -v ofs_v="$ofs_v" \
     -v ofs_f="$ofs_f" \
+    -v ofs_r="$ofs_r" \
+    -v ofs_i="$ofs_i" \
     -v ofs_t="$ofs_t" \
+    -v ofs_s="$ofs_s" \
     -v off="$(oat framefilt --help)" \
     -v off_b="$off_b" \
     -v off_ma="$off_ma" \
@@ -125,6 +137,8 @@ awk -v ofs="$(oat frameserve --help)" \
     -v ops_u="$ops_u" \
     -v obu="$(oat buffer --help)"  \
     -v ocl="$(oat clean --help)"  \
+    -v oto="$(oat top --help)"  \
+    -v oru="$(oat run --help)"  \
     -v oca="$(oat calibrate --help)"  \
     -v oca_c="$oca_c" \
     -v oca_h="$oca_h" \
@@ -132,8 +146,12 @@ awk -v ofs="$(oat frameserve --help)" \
     sub(/oat-frameserve-help/, ofs);
     sub(/oat-frameserve-gige-help/, ofs_g);
     sub(/oat-frameserve-wcam-help/, ofs_w);
+    sub(/oat-frameserve-v4l2-help/, ofs_v);
     sub(/oat-frameserve-file-help/, ofs_f);
+    sub(/oat-frameserve-raw-help/, ofs_r);
+    sub(/oat-frameserve-images-help/, ofs_i);
     sub(/oat-frameserve-test-help/, ofs_t);
+    sub(/oat-frameserve-synth-help/, ofs_s);
     sub(/oat-framefilt-help/, off);
     sub(/oat-framefilt-bsub-help/, off_b);
     sub(/oat-framefilt-mask-help/, off_ma);
@@ -163,6 +181,8 @@ awk -v ofs="$(oat frameserve --help)" \
     sub(/oat-posisock-udp-help/, ops_u);
     sub(/oat-buffer-help/, obu);
     sub(/oat-clean-help/, ocl);
+    sub(/oat-top-help/, oto);
+    sub(/oat-run-help/, oru);
     sub(/oat-calibrate-help/, oca);
     sub(/oat-calibrate-camera-help/, oca_c);
     sub(/oat-calibrate-homography-help/, oca_h);
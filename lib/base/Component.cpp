@@ -28,6 +28,8 @@
 
 #include <boost/interprocess/exceptions.hpp>
 
+#include "../../lib/shmemdf/Semaphore.h"
+#include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/ZMQHelpers.h"
 
 namespace oat {
@@ -39,8 +41,17 @@ volatile sig_atomic_t quit = 0;
 static void sigHandler(int)
 {
     quit = 1;
+
+    // Release any SINK or SOURCE that is blocked waiting on a node
+    wakeForShutdown();
 }
 
+// Registers stats for the calling thread for the lifetime of the scope
+struct ThreadStatsScope {
+    explicit ThreadStatsScope(ProcessStats *s) { telemetry::thread_stats() = s; }
+    ~ThreadStatsScope() { telemetry::thread_stats() = nullptr; }
+};
+
 Component::Component()
 {
     // Install Ctrl-c signal handler
@@ -53,8 +64,24 @@ void Component::run()
     runComponent();
 }
 
+const Scheduling *Component::scheduling() const
+{
+    // Concrete components are Configurable, which holds the options
+    auto s = dynamic_cast<const Schedulable *>(this);
+    return s != nullptr ? &s->scheduling() : nullptr;
+}
+
 void Component::runComponent()
 {
+    const Scheduling *sched = scheduling();
+    if (sched != nullptr)
+        sched->applyToProcessingThread();
+
+    JitterMeter jitter;
+
+    // SINKs and SOURCEs used by process() time their waits into this
+    const ThreadStatsScope stats_scope(&process_stats_);
+
     try {
 
         // TODO: throw "could not connect to node?"
@@ -63,7 +90,10 @@ void Component::runComponent()
 
         bool end_of_stream = false;
         while (!end_of_stream && !quit) {
+            const uint64_t t0 = telemetry::now();
             end_of_stream = process();
+            process_stats_.process.record(telemetry::now() - t0);
+            jitter.tick();
         }
 
     } catch (const boost::interprocess::interprocess_exception &ex) {
@@ -73,6 +103,10 @@ void Component::runComponent()
         if (ex.get_error_code() != 1)
             throw;
     }
+
+    if (sched != nullptr && sched->jitter)
+        std::cout << whoMessage(name(), "Processing loop: " + jitter.report())
+                  << std::endl;
 }
 
 } /* namespace oat */
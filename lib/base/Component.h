@@ -30,6 +30,8 @@
 #include <zmq.hpp>
 
 #include "Globals.h"
+#include "Scheduling.h"
+#include "../shmemdf/Telemetry.h"
 
 namespace oat {
 
@@ -76,6 +78,12 @@ public:
      */
     virtual oat::ComponentType type(void) const = 0;
 
+    /**
+     * @brief Timing of the processing loop. Safe to read from any thread
+     * while the component runs.
+     */
+    const ProcessStats &process_stats(void) const { return process_stats_; }
+
 protected:
 
     /**
@@ -84,6 +92,12 @@ protected:
      */
     void runComponent(void);
 
+    /**
+     * @brief Scheduling options of configurable components.
+     * @return Options, or nullptr if the component is not configurable.
+     */
+    const Scheduling *scheduling(void) const;
+
     /**
      * @brief Attach components to require shared memory segments and
      * synchronization structures.
@@ -95,6 +109,10 @@ protected:
      * @return Return code. 0 = More. 1 = End of stream.
      */
     virtual int process(void) = 0;
+
+private:
+
+    ProcessStats process_stats_;
 };
 }      /* namespace oat */
 #endif /* OAT_COMPONENT_H */
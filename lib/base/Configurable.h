@@ -28,14 +28,17 @@
 #include <boost/program_options.hpp>
 #include <zmq.hpp>
 
+#include "../utility/ProgramOptions.h"
 #include "../utility/TOMLSanitize.h"
 
+#include "Scheduling.h"
+
 namespace oat {
 
 namespace po = boost::program_options;
 
 template <bool CONTROLLABLE = false>
-class Configurable {
+class Configurable : public Schedulable {
 
 public:
     /**
@@ -44,6 +47,12 @@ public:
      */
     void appendOptions(po::options_description &opts) 
     {
+        // Thread placement and priority, common to all components
+        auto sched_options = config::schedulingOptions(CONTROLLABLE);
+        opts.add(sched_options);
+        for (auto &o : sched_options.options())
+            config_keys_.push_back(o->long_name());
+
         // Default program options
         opts.add_options()
             ("config,c", po::value<std::vector<std::string>>()->multitoken(),
@@ -83,6 +92,8 @@ public:
         auto config_table = oat::config::getConfigTable(vm);
         oat::config::checkKeys(config_keys_, config_table);
 
+        scheduling_.configure(vm, config_table);
+
         // Concrete component uses configuration map to configure itself
         applyConfiguration(vm, config_table);
     }
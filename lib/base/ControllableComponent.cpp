@@ -28,7 +28,10 @@
 #include <thread>
 
 #include <boost/interprocess/exceptions.hpp>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 
+#include "../../lib/shmemdf/Semaphore.h"
 #include "../../lib/utility/ZMQHelpers.h"
 
 namespace oat {
@@ -50,6 +53,18 @@ void ControllableComponent::run()
 {
     // TODO: Get endpoint from program options
     auto control_thread = std::thread([this] { runController(); });
+
+    // Keep the control thread off the processing thread's CPUs. Its native
+    // handle is only valid until it is detached.
+    const Scheduling *sched = scheduling();
+    try {
+        if (sched != nullptr)
+            sched->pinControlThread(control_thread.native_handle());
+    } catch (...) {
+        control_thread.detach();
+        throw;
+    }
+
     control_thread.detach();
 
     // Loop until quit
@@ -84,8 +99,20 @@ void ControllableComponent::runController(const char *endpoint)
                 // Found a command, run it.
                 oat::recvString(ctrl_socket); // Delimeter
                 auto command = oat::recvString(ctrl_socket);
+
+                // Built-in commands that reply to the controller
+                if (command == "stats") {
+                    oat::sendStringMore(ctrl_socket, ""); // Delimeter
+                    oat::sendString(ctrl_socket, stats());
+                    continue;
+                }
+
                 quit = control(command);
 
+                // Release the processing thread if it is blocked on a node
+                if (quit)
+                    wakeForShutdown();
+
             } else {
                 // If we did not get a reply on this socket
                 // REQUEST_TIMEOUT_MS, tear it down and make a new one
@@ -150,6 +177,73 @@ std::string ControllableComponent::whoAmI()
     return whoami.str();
 }
 
+template <typename Writer>
+static void serializeHistogram(const LatencyHistogram &h, Writer &writer)
+{
+    writer.StartObject();
+
+    writer.String("count");
+    writer.Uint64(h.count());
+    writer.String("mean_us");
+    writer.Double(h.mean_ns() / 1e3);
+    writer.String("p50_us");
+    writer.Double(h.quantile_ns(0.5) / 1e3);
+    writer.String("p90_us");
+    writer.Double(h.quantile_ns(0.9) / 1e3);
+    writer.String("p99_us");
+    writer.Double(h.quantile_ns(0.99) / 1e3);
+    writer.String("p999_us");
+    writer.Double(h.quantile_ns(0.999) / 1e3);
+    writer.String("max_us");
+    writer.Double(h.max_ns() / 1e3);
+
+    // Occupied buckets as [lowest ns, highest ns, count]
+    writer.String("buckets");
+    writer.StartArray();
+    for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS; i++) {
+        const uint64_t n = h.bucket_count(i);
+        if (n == 0)
+            continue;
+        writer.StartArray();
+        writer.Uint64(LatencyHistogram::lower_ns(i));
+        writer.Uint64(LatencyHistogram::upper_ns(i));
+        writer.Uint64(n);
+        writer.EndArray(3);
+    }
+    writer.EndArray();
+
+    writer.EndObject();
+}
+
+std::string ControllableComponent::stats() const
+{
+    const ProcessStats &s = process_stats();
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.SetMaxDecimalPlaces(3);
+
+    writer.StartObject();
+    writer.String("name");
+    writer.String(name().c_str());
+
+    writer.String("stats");
+    writer.StartObject();
+    writer.String("process");
+    serializeHistogram(s.process, writer);
+    writer.String("source_wait");
+    serializeHistogram(s.source_wait, writer);
+    writer.String("sink_wait");
+    serializeHistogram(s.sink_wait, writer);
+    writer.String("drops");
+    writer.Uint64(s.drops.load(std::memory_order_relaxed));
+    writer.EndObject();
+
+    writer.EndObject();
+
+    return buffer.GetString();
+}
+
 zmq::socket_t *ControllableComponent::getCtrlSocket(zmq::context_t &context,
                                                     const char *endpoint)
 {
@@ -89,6 +89,13 @@ private:
 
     std::string whoAmI();
 
+    /**
+     * @brief JSON reply to the built-in 'stats' command: histograms of
+     * process() duration and of time blocked in SOURCE and SINK waits, plus
+     * the number of samples dropped by LOSSY sources.
+     */
+    std::string stats() const;
+
     int control(const std::string &command);
 
     zmq::socket_t *getCtrlSocket(zmq::context_t &context, const char *endpoint);
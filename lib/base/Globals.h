@@ -21,11 +21,79 @@
 #define OAT_GLOBALS_H
 
 #include <csignal>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
 
 namespace oat {
 
 // Global, atomic quit flag
 extern volatile std::sig_atomic_t quit;
 
+/**
+ * @brief True if the OAT_OFFLINE environment variable is set. Offline,
+ * recorded data is reprocessed as fast as the slowest component allows and
+ * no sample may be dropped: frame servers do not pace themselves, SINKs wait
+ * for their readers, and all SOURCEs are synchronous.
+ */
+inline bool offline()
+{
+    static const bool on = [] {
+        const char *env = std::getenv("OAT_OFFLINE");
+        return env != nullptr && std::strcmp(env, "") != 0
+               && std::strcmp(env, "0") != 0;
+    }();
+    return on;
+}
+
+/**
+ * @brief Number of SOURCEs that the SINK at address waits for before its
+ * first write when offline, 0 if not offline. OAT_OFFLINE holds a comma
+ * separated list of counts. A bare count applies to every stream and
+ * <address>=<count> to a single stream, e.g. OAT_OFFLINE=1,raw=2. Streams
+ * without a count wait for one SOURCE.
+ */
+inline size_t offlineReaders(const std::string &address)
+{
+    if (!offline())
+        return 0;
+
+    auto count = [](const std::string &n) -> long {
+        char *end;
+        const long c = std::strtol(n.c_str(), &end, 10);
+        return n.empty() || *end != '\0' || c < 1 ? -1 : c;
+    };
+
+    const std::string env = std::getenv("OAT_OFFLINE");
+    size_t all = 1, stream = 0;
+    size_t begin = 0;
+    while (begin <= env.size()) {
+
+        size_t end = env.find(',', begin);
+        if (end == std::string::npos)
+            end = env.size();
+        const std::string item = env.substr(begin, end - begin);
+        begin = end + 1;
+
+        const size_t eq = item.find('=');
+        if (eq == std::string::npos) {
+            if (count(item) > 0)
+                all = count(item);
+            continue;
+        }
+
+        const long c = count(item.substr(eq + 1));
+        if (c < 1)
+            throw std::runtime_error("OAT_OFFLINE reader counts must be "
+                                     "positive integers: '" + item + "'.");
+        if (item.compare(0, eq, address) == 0)
+            stream = c;
+    }
+
+    return stream > 0 ? stream : all;
+}
+
 }      /* namespace oat */
 #endif /* OAT_GLOBALS_H */
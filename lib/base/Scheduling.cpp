@@ -0,0 +1,134 @@
+//******************************************************************************
+//* File:   Scheduling.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "Scheduling.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace oat {
+
+static void pin(pthread_t thread, const std::vector<int> &cpus)
+{
+    if (cpus.empty())
+        return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE)
+            throw std::runtime_error("CPU index " + std::to_string(cpu)
+                                     + " is out of range.");
+        CPU_SET(cpu, &set);
+    }
+
+    const int rc = pthread_setaffinity_np(thread, sizeof(set), &set);
+    if (rc != 0)
+        throw std::runtime_error(std::string("Could not pin thread to the "
+                                 "requested CPUs: ") + std::strerror(rc));
+}
+
+void Scheduling::configure(const po::variables_map &vm,
+                           const config::OptionTable &config_table)
+{
+    config::getArray<int>(vm, config_table, "cpus", cpus);
+    config::getArray<int>(vm, config_table, "control-cpus", control_cpus);
+    config::getNumericValue<int>(vm, config_table, "rt-priority", rt_priority, 1, 99);
+    config::getValue<bool>(vm, config_table, "mlock", lock_memory);
+    config::getValue<bool>(vm, config_table, "jitter", jitter);
+}
+
+void Scheduling::applyToProcessingThread() const
+{
+    // Process wide, so also covers the control thread
+    if (lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        throw std::runtime_error(std::string("Could not lock memory: ")
+                                 + std::strerror(errno)
+                                 + ". Raise the memlock limit.");
+
+    pin(pthread_self(), cpus);
+
+    if (rt_priority > 0) {
+        sched_param param;
+        param.sched_priority = rt_priority;
+        const int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc != 0)
+            throw std::runtime_error(std::string("Could not set SCHED_FIFO "
+                                     "priority: ") + std::strerror(rc)
+                                     + ". Raise the rtprio limit or grant "
+                                     "CAP_SYS_NICE.");
+    }
+}
+
+void Scheduling::pinControlThread(pthread_t thread) const
+{
+    pin(thread, control_cpus);
+}
+
+void JitterMeter::tick()
+{
+    const auto now = Clock::now();
+
+    // The first iteration includes connecting to nodes
+    if (!started_) {
+        started_ = true;
+        last_ = now;
+        return;
+    }
+
+    const double dt = std::chrono::duration<double>(now - last_).count();
+    last_ = now;
+
+    if (n_ == 0 || dt < min_)
+        min_ = dt;
+    if (n_ == 0 || dt > max_)
+        max_ = dt;
+
+    n_++;
+    const double delta = dt - mean_;
+    mean_ += delta / n_;
+    m2_ += delta * (dt - mean_);
+}
+
+std::string JitterMeter::report() const
+{
+    if (n_ == 0)
+        return "No iterations completed.";
+
+    const double sd = n_ > 1 ? std::sqrt(m2_ / (n_ - 1)) : 0;
+    const double worst = std::max(max_ - mean_, mean_ - min_);
+
+    char out[256];
+    std::snprintf(out, sizeof(out),
+                  "%llu iterations, period %.3f ms, jitter %.3f ms (SD), "
+                  "worst %.3f ms from mean (min %.3f ms, max %.3f ms).",
+                  static_cast<unsigned long long>(n_), 1e3 * mean_, 1e3 * sd,
+                  1e3 * worst, 1e3 * min_, 1e3 * max_);
+
+    return out;
+}
+
+}      /* namespace oat */
@@ -0,0 +1,119 @@
+//******************************************************************************
+//* File:   Scheduling.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SCHEDULING_H
+#define OAT_SCHEDULING_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+#include <boost/program_options.hpp>
+
+#include "../utility/TOMLSanitize.h"
+
+namespace oat {
+
+namespace po = boost::program_options;
+
+/**
+ * Where and how a component's threads run.
+ */
+struct Scheduling {
+    std::vector<int> cpus;         //!< Processing thread CPUs. Empty for any.
+    std::vector<int> control_cpus; //!< Control thread CPUs. Empty for any.
+    int rt_priority {0};           //!< SCHED_FIFO priority. 0 for normal.
+    bool lock_memory {false};      //!< Lock all process memory into RAM
+    bool jitter {false};           //!< Report loop jitter on exit
+
+    /**
+     * @brief Read the options described by config::schedulingOptions().
+     * @param vm Program option map.
+     * @param config_table Component's TOML configuration table.
+     */
+    void configure(const po::variables_map &vm,
+                   const config::OptionTable &config_table);
+
+    /**
+     * @brief Lock memory if requested, then pin the calling thread and set
+     * its priority. Throws if any request cannot be honored.
+     */
+    void applyToProcessingThread() const;
+
+    /**
+     * @brief Pin a runtime control thread to the control CPUs, if any.
+     * @param thread Native handle of the control thread.
+     */
+    void pinControlThread(pthread_t thread) const;
+};
+
+/**
+ * Running statistics of the time between iterations of a processing loop.
+ */
+class JitterMeter {
+
+    using Clock = std::chrono::steady_clock;
+
+public:
+
+    /**
+     * @brief Mark the end of an iteration.
+     */
+    void tick();
+
+    /**
+     * @brief Human readable summary of the iteration periods seen so far.
+     */
+    std::string report() const;
+
+private:
+
+    Clock::time_point last_;
+    bool started_ {false};
+
+    // Welford's running mean and variance, in seconds
+    uint64_t n_ {0};
+    double mean_ {0};
+    double m2_ {0};
+    double min_ {0};
+    double max_ {0};
+};
+
+/**
+ * Mixin holding a component's scheduling options. Configurable components
+ * fill it during configure() and Component applies it to its threads.
+ */
+class Schedulable {
+
+public:
+
+    virtual ~Schedulable() { };
+
+    const Scheduling &scheduling() const { return scheduling_; }
+
+protected:
+
+    Scheduling scheduling_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_SCHEDULING_H */
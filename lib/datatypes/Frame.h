@@ -102,6 +102,27 @@ public:
         // Nothing
     }
 
+    // A copy of a frame that owns its sample owns a copy of the sample, so
+    // that frames can be queued by value. Copies of shared frames still
+    // view the sample in shared memory.
+    Frame(const Frame &f)
+    : cv::Mat(f)
+    , sample_(f.sample_)
+    , sample_ptr_(f.owns_sample() ? &sample_ : f.sample_ptr_)
+    , color_(f.color_)
+    {
+        // Nothing
+    }
+
+    Frame &operator=(const Frame &f)
+    {
+        cv::Mat::operator=(f);
+        sample_ = f.sample_;
+        sample_ptr_ = f.owns_sample() ? &sample_ : f.sample_ptr_;
+        color_ = f.color_;
+        return *this;
+    }
+
     Frame clone() const
     {
         Frame f(cv::Mat::clone());
@@ -126,15 +147,19 @@ public:
     uint64_t sample_count(void) const { return sample_ptr_->count(); }
     void incrementSampleCount() { sample_ptr_->incrementCount(); }
     void incrementSampleCount(USec us) { sample_ptr_->incrementCount(us); }
+    void set_capture_ns(const uint64_t ns) { sample_ptr_->set_capture_ns(ns); }
 
     // Provide copy of sample_
     oat::Sample sample() const { return *sample_ptr_; };
+    void set_sample(const oat::Sample &val) { *sample_ptr_ = val; }
 
     // Color accessors
     PixelColor color(void) const { return color_; }
     void set_color(const PixelColor val) { color_ = val; }
 
 private:
+    bool owns_sample() const { return sample_ptr_ == &sample_; }
+
     // Internal Sample
     oat::Sample sample_;
 
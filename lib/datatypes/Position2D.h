@@ -27,6 +27,7 @@
 #include <rapidjson/prettywriter.h>
 
 #include "Sample.h"
+#include "Trace.h"
 
 namespace oat {
 
@@ -42,9 +43,11 @@ class Position2D;
  * @param p Position to serialize.
  * @param w Writer to serialize with.
  * @param verbose Allow verbose serialization.
+ * @param trace Latency trace of the position's sample, if it was traced.
  */
 template <typename Writer>
-void serializePosition(const Position2D &p, Writer &w, bool verbose = false);
+void serializePosition(const Position2D &p, Writer &w, bool verbose = false,
+                       const Trace *trace = nullptr);
 
 /** 
  * @brief Pack a position object into a byte array.
@@ -66,13 +69,17 @@ class Position2D {
 
     template <typename Writer>
     friend void
-    serializePosition(const Position2D &, Writer &, bool verbose);
+    serializePosition(const Position2D &, Writer &, bool verbose,
+                      const Trace *trace);
     friend std::vector<char> packPosition(const Position2D &);
 
     using USec = Sample::Microseconds;
 
 public:
 
+    // Unlabeled, e.g. an entry in a PositionBatch
+    Position2D() = default;
+
     explicit Position2D(const std::string &label)
     {
         strncpy(label_, label.c_str(), sizeof(label_));
@@ -127,6 +134,7 @@ public:
     cv::Matx33d homography() const { return homography_; }
 
     // Set sample rate
+    const Sample &sample() const { return sample_; }
     void set_sample(const Sample &val) { sample_ = val; }
     void set_rate_hz(const double rate_hz) { sample_.set_rate_hz(rate_hz); }
     double sample_period_sec() const { return sample_.period_sec().count(); }
@@ -134,6 +142,7 @@ public:
     uint64_t sample_usec(void) const { return sample_.microseconds().count(); }
     void incrementSampleCount() { sample_.incrementCount(); }
     void incrementSampleCount(USec us) { sample_.incrementCount(us); }
+    void set_capture_ns(const uint64_t ns) { sample_.set_capture_ns(ns); }
 
     void setCoordSystem(const DistanceUnit value, const cv::Matx33d homography)
     {
@@ -162,12 +171,14 @@ private:
  * @param verbose If true, specifies that fields be serialized even though
  * they contain indeterminate data? This is useful for ease of sample
  * alignment during post processing of saved files.
+ * @param trace Latency trace of the position's sample, or nullptr.
  */
 // TODO: Should this just return a rapidjson::Document which is redily
 // transformed into other formats such as msgpack, etc, instead of doing the
 // writing right here?
 template <typename Writer>
-void serializePosition(const Position2D &p, Writer &writer, bool verbose)
+void serializePosition(const Position2D &p, Writer &writer, bool verbose,
+                       const Trace *trace)
 {
     writer.SetMaxDecimalPlaces(5);
 
@@ -180,6 +191,46 @@ void serializePosition(const Position2D &p, Writer &writer, bool verbose)
     writer.String("usec");
     writer.Uint64(p.sample_usec());
 
+    // Latency breakdown, present if the sample was traced
+    const size_t n_hops = trace != nullptr ? trace->num_hops : 0;
+    if (n_hops > 0) {
+
+        // Samples from a SINK that does not know its capture time are
+        // measured from when the first component received them
+        const auto cap = p.sample().capture_ns() != 0
+                       ? p.sample().capture_ns() : trace->hops[0].enter_ns;
+        uint64_t prev = cap;
+
+        writer.String("trace");
+        writer.StartObject();
+
+        writer.String("cap_ns");
+        writer.Uint64(cap);
+
+        writer.String("total_us");
+        writer.Double(
+            (static_cast<double>(trace->hops[n_hops - 1].exit_ns) - cap) / 1e3);
+
+        // Time waiting for each component and time spent inside it
+        writer.String("hops");
+        writer.StartArray();
+        for (size_t i = 0; i < n_hops; i++) {
+            const auto &h = trace->hops[i];
+            writer.StartObject();
+            writer.String("who");
+            writer.String(h.who);
+            writer.String("wait_us");
+            writer.Double((static_cast<double>(h.enter_ns) - prev) / 1e3);
+            writer.String("proc_us");
+            writer.Double((static_cast<double>(h.exit_ns) - h.enter_ns) / 1e3);
+            writer.EndObject();
+            prev = h.exit_ns;
+        }
+        writer.EndArray(n_hops);
+
+        writer.EndObject();
+    }
+
     // Coordinate system
     writer.String("unit");
     writer.Int(static_cast<int>(p.unit_of_length_));
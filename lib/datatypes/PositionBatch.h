@@ -0,0 +1,105 @@
+//******************************************************************************
+//* File:   PositionBatch.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_POSITIONBATCH_H
+#define	OAT_POSITIONBATCH_H
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "Position2D.h"
+
+namespace oat {
+
+/**
+ * A group of positions that crosses a node in a single write, so that the
+ * SINK and SOURCE handshake once per batch instead of once per position.
+ * Batches hold either several objects observed in the same sample or
+ * consecutive samples of a single object (e.g. during replay).
+ *
+ * Storage is fixed so that batches can live in shared memory.
+ */
+class PositionBatch {
+
+public:
+
+    static constexpr size_t CAPACITY {64};
+
+    using iterator = Position2D *;
+    using const_iterator = const Position2D *;
+
+    explicit PositionBatch(const std::string &label)
+    {
+        strncpy(label_, label.c_str(), sizeof(label_));
+        label_[sizeof(label_) - 1] = '\0';
+    }
+
+    PositionBatch(const PositionBatch &) = default;
+
+    // Copy all but label, which is specific to the component. Only occupied
+    // entries are copied.
+    PositionBatch &operator=(const PositionBatch &b)
+    {
+        // Check for self assignment
+        if (this == &b)
+            return *this;
+
+        size_ = b.size_;
+        for (size_t i = 0; i < size_; i++)
+            positions_[i] = b.positions_[i];
+
+        return *this;
+    }
+
+    // Accessors
+    char *label() { return label_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == CAPACITY; }
+
+    Position2D &operator[](const size_t i) { return positions_[i]; }
+    const Position2D &operator[](const size_t i) const { return positions_[i]; }
+
+    iterator begin() { return positions_; }
+    iterator end() { return positions_ + size_; }
+    const_iterator begin() const { return positions_; }
+    const_iterator end() const { return positions_ + size_; }
+
+    void clear() { size_ = 0; }
+
+    void push_back(const Position2D &p)
+    {
+        if (full())
+            throw std::runtime_error("Position batch capacity ("
+                                     + std::to_string(CAPACITY)
+                                     + ") exceeded.");
+
+        positions_[size_++] = p;
+    }
+
+private:
+
+    char label_[100] {0}; //!< Batch label
+    size_t size_ {0};
+    Position2D positions_[CAPACITY];
+};
+
+}      /* namespace oat */
+#endif /* OAT_POSITIONBATCH_H */
@@ -23,10 +23,13 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <ratio>
 
 #include <opencv2/core/mat.hpp>
 
+#include "../utility/Clock.h"
+
 namespace oat {
 
 /**
@@ -40,6 +43,23 @@ public:
     using Microseconds = std::chrono::microseconds; 
     using IEEE1394Tick = std::chrono::duration<float, std::ratio<1,8000>>;
 
+    /**
+     * @brief Pipeline's shared clock in nanoseconds. Comparable across
+     * processes on the same machine.
+     */
+    static uint64_t now_ns() { return SharedClock::instance().now_ns(); }
+
+    /**
+     * @brief Time since the pipeline started on its shared clock. Used by
+     * pure SINKs that measure, rather than count, sample times so that the
+     * sample times of all streams are comparable.
+     */
+    static Microseconds since_start()
+    {
+        return std::chrono::duration_cast<Microseconds>(
+            std::chrono::nanoseconds(SharedClock::instance().since_start_ns()));
+    }
+
     explicit Sample()
     {
         // Nothing
@@ -93,6 +113,16 @@ public:
         return ++count_;
     }
 
+    /**
+     * @brief Set the host time at which the sample was captured. Pure SINKs
+     * set it along with the count, from the device's own timestamp if it
+     * has one.
+     *
+     * @param value Capture time on the pipeline's shared clock in
+     * nanoseconds, see now_ns().
+     */
+    void set_capture_ns(const uint64_t value) { capture_ns_ = value; }
+
     /** 
      * @brief Set the sample rate.
      * 
@@ -112,6 +142,7 @@ public:
     Seconds period_sec() const { return period_sec_; }
     Microseconds period_microseconds() const { return period_microseconds_; }
     double rate_hz() const { return rate_hz_; }
+    uint64_t capture_ns() const { return capture_ns_; } //!< 0 if unknown
 
 private:
 
@@ -120,6 +151,7 @@ private:
     Seconds period_sec_ {0.0};
     Microseconds period_microseconds_ {0};
     double rate_hz_ {0.0};
+    uint64_t capture_ns_ {0};
 };
 
 }      /* namespace oat */
@@ -0,0 +1,93 @@
+//******************************************************************************
+//* File:   Trace.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_TRACE_H
+#define	OAT_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace oat {
+
+/**
+ * Latency trace of one sample: the time it spent in each component that
+ * handled it, on the pipeline's shared clock. The capture time that the hops
+ * are measured from is part of the sample (Sample::capture_ns()). Hops are
+ * not. When tracing is enabled, each node keeps one trace per ring entry in a
+ * side block next to the shared object.
+ */
+struct Trace {
+
+    struct Hop {
+        static constexpr size_t WHO_LEN {24};
+        char who[WHO_LEN];  //!< Component name, truncated
+        uint64_t enter_ns;  //!< Sample became available to the component
+        uint64_t exit_ns;   //!< Component published its result
+    };
+
+    static constexpr size_t MAX_HOPS {8};
+
+    /**
+     * @brief True if samples should be traced, as requested by setting the
+     * OAT_TRACE environment variable. Checked when nodes are bound and
+     * connected.
+     */
+    static bool enabled()
+    {
+        const char *env = std::getenv("OAT_TRACE");
+        return env != nullptr && std::strcmp(env, "") != 0
+               && std::strcmp(env, "0") != 0;
+    }
+
+    /**
+     * @brief Remove all hops, e.g. for a newly captured sample.
+     */
+    void clear() { num_hops = 0; }
+
+    /**
+     * @brief Record a component's handling of the sample. Hops past MAX_HOPS
+     * are dropped.
+     *
+     * @param who Component name.
+     * @param enter_ns Time the sample became available to the component.
+     * @param exit_ns Time the component published its result.
+     */
+    void appendHop(const std::string &who,
+                   const uint64_t enter_ns,
+                   const uint64_t exit_ns)
+    {
+        if (num_hops == MAX_HOPS)
+            return;
+
+        auto &h = hops[num_hops++];
+        strncpy(h.who, who.c_str(), sizeof(h.who));
+        h.who[sizeof(h.who) - 1] = '\0';
+        h.enter_ns = enter_ns;
+        h.exit_ns = exit_ns;
+    }
+
+    uint32_t num_hops {0};
+    Hop hops[MAX_HOPS] {};
+};
+
+}      /* namespace oat */
+#endif /* OAT_TRACE_H */
@@ -0,0 +1,387 @@
+//******************************************************************************
+//* File:   Channel.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_CHANNEL_H
+#define	OAT_CHANNEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include "../datatypes/Sample.h"
+#include "../datatypes/Trace.h"
+#include "../base/Globals.h"
+
+#include "Node.h"
+#include "Semaphore.h"
+#include "SharedFrameHeader.h"
+
+namespace oat {
+
+/**
+ * Frame held by an in-process channel entry. The data block is large enough
+ * for any frame up to the bytes reserved by the SINK.
+ */
+struct ChannelFrame {
+
+    explicit ChannelFrame(const size_t bytes)
+    : data(new char[bytes])
+    , bytes(bytes)
+    {
+        // Nothing
+    }
+
+    std::unique_ptr<char[]> data;
+    size_t bytes;
+    oat::Sample sample;
+    FrameParams params;
+};
+
+// What a channel carries for each node type
+template <typename T>
+struct ChannelPayload { using type = T; };
+
+template <>
+struct ChannelPayload<SharedFrameHeader> { using type = ChannelFrame; };
+
+class ChannelBase {
+public:
+    virtual ~ChannelBase() { }
+    virtual const std::type_info & type() const = 0;
+};
+
+/**
+ * Stream between a SINK and SOURCEs that are threads of the same process.
+ * Used in place of a shared memory node when both ends of a stream are
+ * stages of oat run.
+ *
+ * The SINK writes each sample into a pooled entry and publishes a
+ * shared_ptr to it. Each SYNCHRONOUS reader has a single-producer,
+ * single-consumer lock-free queue of entries that it reads in place, so
+ * frames are never copied between stages. An entry is reused once no queue
+ * or reader holds it. LOSSY readers take the latest published entry, which
+ * they hold until their next read, so their reads cannot be torn.
+ *
+ * Backpressure matches a node of the same depth: the SINK waits until every
+ * SYNCHRONOUS reader has fewer than depth unread entries.
+ */
+template <typename P>
+class Channel : public ChannelBase {
+public:
+
+    struct Slot {
+
+        template <typename... Targs>
+        explicit Slot(Targs... args)
+        : value(args...)
+        {
+            // Nothing
+        }
+
+        P value;
+        uint64_t number {0};           //!< Write number, starting at 1
+        std::unique_ptr<Trace> trace;  //!< Only allocated when tracing
+    };
+
+    using Entry = std::shared_ptr<Slot>;
+    using Factory = std::function<Entry()>;
+
+    struct Reader {
+
+        explicit Reader(const bool synchronous)
+        : synchronous(synchronous)
+        , queue(Node::MAX_DEPTH)
+        {
+            // Nothing
+        }
+
+        const bool synchronous;
+        boost::lockfree::spsc_queue<Entry> queue; //!< SYNCHRONOUS readers only
+        std::atomic<bool> detached {false};
+    };
+
+    Channel()
+    {
+        registerForShutdown(&written_);
+        registerForShutdown(&read_);
+    }
+
+    ~Channel()
+    {
+        unregisterForShutdown(&written_);
+        unregisterForShutdown(&read_);
+    }
+
+    const std::type_info & type() const override { return typeid(P); }
+
+    NodeState state() const { return state_; }
+    uint64_t write_number() const { return write_number_; }
+
+    /**
+     * Notified when an entry is published, the SINK opens the channel or the
+     * SINK leaves.
+     */
+    WaitQueue & written() { return written_; }
+
+    // SINK interface
+
+    void bind(const std::string &address, const size_t depth)
+    {
+        NodeState expected = NodeState::UNDEFINED;
+        if (!state_.compare_exchange_strong(expected, NodeState::SINK_BOUND))
+            throw std::runtime_error("Requested SINK address, '" + address
+                                     + "', is not available.");
+
+        depth_ = depth;
+    }
+
+    /**
+     * Make the channel readable. The prototype is what SOURCEs see before
+     * the first write; entries are created by make as they are needed.
+     */
+    void open(Entry prototype, Factory make)
+    {
+        prototype_ = std::move(prototype);
+        make_ = std::move(make);
+        open_ = true;
+        written_.notify();
+    }
+
+    /**
+     * Block until every SYNCHRONOUS reader can take another entry and at
+     * least min_readers are attached, or quit is set.
+     * @return An entry that no reader holds.
+     */
+    Entry acquire(const size_t min_readers)
+    {
+        refreshReaders();
+        if (min_readers > 0 || !readers_snapshot_.empty()) {
+            read_.wait([this, min_readers] {
+                refreshReaders();
+                return quit || (synchronous_ >= min_readers && hasRoom());
+            });
+        }
+
+        for (const auto &e : pool_) {
+            if (e.use_count() == 1) {
+                // The last reader's release happens before our writes
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return e;
+            }
+        }
+
+        pool_.push_back(make_());
+        return pool_.back();
+    }
+
+    void publish(const Entry &e)
+    {
+        e->number = write_number_ + 1;
+
+        refreshReaders();
+        for (const auto &r : readers_snapshot_) {
+            if (r->synchronous && !r->detached)
+                r->queue.push(e);
+        }
+
+        std::atomic_store(&latest_, e);
+        write_number_.store(e->number, std::memory_order_release);
+        written_.notify();
+    }
+
+    void unbind()
+    {
+        state_ = NodeState::END;
+        written_.notify();
+        read_.notify();
+    }
+
+    // SOURCE interface
+
+    std::shared_ptr<Reader> attach(const bool synchronous)
+    {
+        auto r = std::make_shared<Reader>(synchronous);
+        {
+            std::lock_guard<std::mutex> lock(readers_mutex_);
+            readers_.push_back(r);
+            readers_version_++;
+        }
+
+        if (synchronous)
+            synchronous_++;
+
+        read_.notify();
+        return r;
+    }
+
+    void detach(const std::shared_ptr<Reader> &r)
+    {
+        r->detached = true;
+        {
+            std::lock_guard<std::mutex> lock(readers_mutex_);
+            readers_.erase(std::find(readers_.begin(), readers_.end(), r));
+            readers_version_++;
+        }
+
+        if (r->synchronous)
+            synchronous_--;
+
+        read_.notify();
+    }
+
+    /**
+     * Block until the SINK has opened the channel.
+     * @return False if the SINK left or quit was set first.
+     */
+    bool waitOpen()
+    {
+        written_.wait([this] {
+            return open_ || state_ == NodeState::END || quit;
+        });
+
+        return open_;
+    }
+
+    const Entry & prototype() const { return prototype_; }
+
+    Entry latest() const { return std::atomic_load(&latest_); }
+
+    /**
+     * Tell the SINK that a reader has consumed an entry.
+     */
+    void notifyRead() { read_.notify(); }
+
+private:
+
+    // Pick up readers that attached or detached since the last call. Only
+    // called by the SINK, which is the only user of the snapshot.
+    void refreshReaders()
+    {
+        if (readers_version_ == snapshot_version_)
+            return;
+
+        std::lock_guard<std::mutex> lock(readers_mutex_);
+        readers_snapshot_ = readers_;
+        snapshot_version_ = readers_version_;
+    }
+
+    bool hasRoom() const
+    {
+        for (const auto &r : readers_snapshot_) {
+            const size_t unread = Node::MAX_DEPTH - r->queue.write_available();
+            if (r->synchronous && !r->detached && unread >= depth_)
+                return false;
+        }
+
+        return true;
+    }
+
+    std::atomic<NodeState> state_ {NodeState::UNDEFINED};
+    std::atomic<bool> open_ {false};
+    std::atomic<uint64_t> write_number_ {0};
+    size_t depth_ {1};
+
+    Entry prototype_;
+    Factory make_;
+    Entry latest_;
+
+    // Written only by the SINK
+    std::vector<Entry> pool_;
+    std::vector<std::shared_ptr<Reader>> readers_snapshot_;
+    uint64_t snapshot_version_ {0};
+
+    std::mutex readers_mutex_;
+    std::vector<std::shared_ptr<Reader>> readers_;
+    std::atomic<uint64_t> readers_version_ {0};
+    std::atomic<size_t> synchronous_ {0};
+
+    WaitQueue written_, read_;
+};
+
+/**
+ * Streams of this process that use a Channel instead of a shared memory
+ * node. oat run enables the streams whose SINK and SOURCEs are all stages of
+ * the pipeline. Nothing is enabled otherwise, so stand-alone components
+ * always use shared memory.
+ */
+class Channels {
+public:
+
+    static Channels & instance()
+    {
+        static Channels channels;
+        return channels;
+    }
+
+    void enable(const std::string &address)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enabled_.insert(address);
+    }
+
+    bool enabled(const std::string &address) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return enabled_.count(address) > 0;
+    }
+
+    /**
+     * Find the channel at address, or create it if neither end has arrived
+     * yet. The channel lives as long as its SINK or a SOURCE holds it.
+     */
+    template <typename P>
+    std::shared_ptr<Channel<P>> find(const std::string &address)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto c = channels_[address].lock();
+        if (c == nullptr) {
+            auto created = std::make_shared<Channel<P>>();
+            channels_[address] = created;
+            return created;
+        }
+
+        if (c->type() != typeid(P))
+            throw std::runtime_error("Type mismatch: Source<T> can only "
+                                     "connect to Node<T>.");
+
+        return std::static_pointer_cast<Channel<P>>(c);
+    }
+
+private:
+
+    Channels() { }
+
+    mutable std::mutex mutex_;
+    std::set<std::string> enabled_;
+    std::map<std::string, std::weak_ptr<ChannelBase>> channels_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_CHANNEL_H */
@@ -0,0 +1,203 @@
+//******************************************************************************
+//* File:   FramePages.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_FRAMEPAGES_H
+#define	OAT_FRAMEPAGES_H
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+namespace oat {
+
+/**
+ * Memory backing the pixel data of a frame node.
+ */
+enum class FramePages : int {
+    DEFAULT = 0, //!< Shared memory, faulted in page by page on first use
+    LOCKED,      //!< Shared memory, faulted in and locked when mapped
+    HUGETLB      //!< hugetlbfs file, faulted in and locked when mapped
+};
+
+/**
+ * Frame page backing requested via the OAT_FRAME_PAGES environment
+ * variable, which may be "default", "locked" or "huge".
+ */
+inline FramePages configuredFramePages()
+{
+    const char *env = std::getenv("OAT_FRAME_PAGES");
+    if (env == nullptr || *env == '\0' || std::strcmp(env, "default") == 0)
+        return FramePages::DEFAULT;
+    if (std::strcmp(env, "locked") == 0)
+        return FramePages::LOCKED;
+    if (std::strcmp(env, "huge") == 0)
+        return FramePages::HUGETLB;
+
+    throw std::runtime_error("OAT_FRAME_PAGES must be one of "
+                             "'default', 'locked' or 'huge'.");
+}
+
+namespace pages {
+
+/**
+ * Touch one byte in every page of a mapping so that later accesses do not
+ * fault. Writing allocates the pages; reading only maps them.
+ */
+inline void prefault(char *data, const size_t bytes, const bool write)
+{
+    const size_t step = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < bytes; i += step) {
+        if (write)
+            data[i] = 0;
+        else
+            static_cast<void>(*static_cast<volatile char *>(data + i));
+    }
+}
+
+/**
+ * Lock a mapping into RAM. Fails if it would exceed RLIMIT_MEMLOCK.
+ */
+inline bool lock(char *data, const size_t bytes)
+{
+    return mlock(data, bytes) == 0;
+}
+
+/**
+ * Mount point of the first hugetlbfs file system, or an empty string if
+ * there is none.
+ */
+inline std::string hugetlbfsMount()
+{
+    std::ifstream mounts("/proc/mounts");
+    std::string device, dir, type, options;
+    while (mounts >> device >> dir >> type && std::getline(mounts, options)) {
+        if (type == "hugetlbfs")
+            return dir;
+    }
+
+    return "";
+}
+
+/**
+ * A file on hugetlbfs mapped into this process. The file is named so that
+ * SOURCEs in other processes can map it.
+ */
+class HugeRegion {
+public:
+    HugeRegion() = default;
+    ~HugeRegion() { unmap(); }
+
+    HugeRegion &operator=(const HugeRegion &) = delete;
+    HugeRegion(const HugeRegion &) = delete;
+
+    /**
+     * Create and map a file of at least bytes bytes, faulting in all of
+     * its pages. Returns false, leaving no file behind, if there are not
+     * enough free huge pages.
+     */
+    bool create(const std::string &path, const size_t bytes)
+    {
+        // Any existing file is left over from a SINK that did not exit
+        // cleanly. The node guarantees that we are the only SINK using it.
+        unlink(path.c_str());
+
+        int fd = ::open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+            return false;
+
+        if (!map(fd, bytes, true)) {
+            close(fd);
+            unlink(path.c_str());
+            return false;
+        }
+
+        close(fd);
+        return true;
+    }
+
+    /**
+     * Map an existing file created by a SINK.
+     */
+    void open(const std::string &path, const size_t bytes)
+    {
+        int fd = ::open(path.c_str(), O_RDWR);
+        if (fd < 0 || !map(fd, bytes, false)) {
+            const int err = errno;
+            if (fd >= 0)
+                close(fd);
+            throw std::runtime_error("Could not map frame data at '" + path
+                                     + "': " + std::strerror(err));
+        }
+
+        close(fd);
+    }
+
+    char * data() const { return data_; }
+
+    static void remove(const std::string &path) { unlink(path.c_str()); }
+
+private:
+
+    bool map(int fd, const size_t bytes, const bool resize)
+    {
+        // Mappings must be a whole number of huge pages
+        struct statfs fs;
+        if (fstatfs(fd, &fs) != 0)
+            return false;
+        const size_t page = fs.f_bsize;
+        const size_t length = (bytes + page - 1) / page * page;
+
+        if (resize && ftruncate(fd, length) != 0)
+            return false;
+
+        // Fails up front, rather than on first touch, if the huge pages
+        // cannot be reserved
+        void *addr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, 0);
+        if (addr == MAP_FAILED)
+            return false;
+
+        data_ = static_cast<char *>(addr);
+        length_ = length;
+        return true;
+    }
+
+    void unmap()
+    {
+        if (data_ != nullptr)
+            munmap(data_, length_);
+        data_ = nullptr;
+    }
+
+    char * data_ {nullptr};
+    size_t length_ {0};
+};
+
+} // namespace pages
+} // namespace oat
+
+#endif	/* OAT_FRAMEPAGES_H */
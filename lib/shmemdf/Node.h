@@ -20,14 +20,20 @@
 #ifndef OAT_NODE_H
 #define	OAT_NODE_H
 
-#include <iostream>
 #include <array>
 #include <atomic>
-#include <bitset>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
 #include <string>
-#include <boost/interprocess/sync/interprocess_semaphore.hpp>
+#include <typeinfo>
+
+#include <unistd.h>
 
 #include "ForwardsDecl.h"
+#include "Process.h"
+#include "Semaphore.h"
+#include "Telemetry.h"
 
 namespace oat {
 
@@ -38,149 +44,477 @@ enum class NodeState {
     ERROR = 2
 };
 
+/**
+ * Synchronization block shared by a SINK and its SOURCEs.
+ *
+ * The number of SOURCE slots is fixed when the node is created. Per-slot
+ * state lives directly after the Node object, so a Node must be placed in
+ * storage of at least bytes(num_slots) bytes. Use findOrCreate() to get one
+ * in shared memory.
+ *
+ * Slots are claimed and released without locks using an atomic bitmap. The
+ * SINK folds SOURCEs that have joined or left since its last write into the
+ * read barrier when it posts, so each SOURCE read costs a constant number of
+ * atomic operations regardless of how many SOURCEs share the node.
+ *
+ * Each claimed slot records the process that owns it and a heartbeat that the
+ * owner refreshes on every read. A SINK that has been kept waiting can
+ * reclaim the slots of owners that died without releasing them.
+ */
 class Node {
 public:
 
-    using semaphore = bip::interprocess_semaphore;
+    using semaphore = oat::Semaphore;
+
+    // SOURCE slots
+    static constexpr size_t DEFAULT_SLOTS {64};
+    static constexpr size_t MAX_SLOTS {4096};
+
+    // SINK ring depth. The SINK may run up to depth() writes ahead of its
+    // slowest SOURCE. Each write goes to ring entry write_number() % depth().
+    static constexpr size_t MAX_DEPTH {16};
+
+    // How long a SINK waits on its SOURCEs before looking for dead ones, and
+    // how long a SOURCE must be silent before its process is checked
+    static constexpr uint64_t WATCHDOG_NS {250000000};
 
-    Node()
+    explicit Node(const size_t num_slots)
+    : num_slots_(num_slots)
+    , num_words_((num_slots + 63) / 64)
     {
-        source_slots_.reset();
-        source_read_required_.reset();
-    }
+        if (num_slots == 0 || num_slots > MAX_SLOTS)
+            throw std::runtime_error("Node slot count must be between 1 and "
+                                     + std::to_string(MAX_SLOTS) + ".");
 
-    // Nodes are movable
-    Node(Node&&) = default;
-    Node & operator=(Node&&) = default;
+        for (size_t i = 0; i < num_slots_; i++)
+            new (slots() + i) Slot();
 
-    // Nodes are not copyable
+        for (size_t w = 0; w < num_words_ * (MAX_DEPTH + 2); w++)
+            new (words() + w) std::atomic<uint64_t>(0);
+
+        for (auto &e : entry_seq_)
+            e = 0;
+        for (auto &r : reads_required_)
+            r = 0;
+    }
+
+    // Nodes are not copyable or movable since they own trailing storage
     Node(const Node &) = delete;
     Node & operator=(const Node &) = delete;
 
+    /**
+     * Number of bytes of storage required by a Node with num_slots slots.
+     */
+    static size_t bytes(const size_t num_slots)
+    {
+        return sizeof(Node) + num_slots * sizeof(Slot)
+               + (num_slots + 63) / 64 * (MAX_DEPTH + 2)
+                     * sizeof(std::atomic<uint64_t>);
+    }
+
+    /**
+     * Number of SOURCE slots to give nodes created by this process. Set by the
+     * OAT_NODE_SLOTS environment variable, DEFAULT_SLOTS otherwise. This only
+     * has an effect on the component that creates a node.
+     */
+    static size_t configuredSlots()
+    {
+        const char *env = std::getenv("OAT_NODE_SLOTS");
+        if (env == nullptr || *env == '\0')
+            return DEFAULT_SLOTS;
+
+        char *end;
+        const unsigned long n = std::strtoul(env, &end, 10);
+        if (*end != '\0' || n == 0 || n > MAX_SLOTS)
+            throw std::runtime_error("OAT_NODE_SLOTS must be between 1 and "
+                                     + std::to_string(MAX_SLOTS) + ".");
+
+        return n;
+    }
+
+    /**
+     * Find the node in a shared memory segment, creating it if it does not
+     * exist. The segment must have been created with at least
+     * shmemBytes(num_slots) bytes.
+     */
+    static Node * findOrCreate(shmem_t &shmem, const size_t num_slots)
+    {
+        const char *name = typeid(Node).name();
+        Node *node = nullptr;
+
+        // The segment's mutex keeps other processes from finding the storage
+        // before the Node has been constructed in it
+        auto find_or_create = [&shmem, &node, name, num_slots] {
+            auto found = shmem.find<char>(name);
+            if (found.first != nullptr) {
+                node = reinterpret_cast<Node *>(found.first);
+            } else {
+                char *storage = shmem.construct<char>(name)[bytes(num_slots)]();
+                node = new (storage) Node(num_slots);
+            }
+        };
+        shmem.atomic_func(find_or_create);
+
+        return node;
+    }
+
+    /**
+     * Find the node in a segment that was opened read-only, e.g. by a
+     * monitoring tool. Returns nullptr if there is no node in the segment.
+     */
+    static const Node * findReadOnly(bip::managed_shared_memory &shmem)
+    {
+        // Read-only segments cannot take the segment mutex
+        auto found = shmem.find_no_lock<char>(typeid(Node).name());
+        return reinterpret_cast<const Node *>(found.first);
+    }
+
+    /**
+     * Shared memory segment size required to hold a node with num_slots slots.
+     */
+    static size_t shmemBytes(const size_t num_slots)
+    {
+        // Extra 1024 bytes are used to hold managed shared mem helper objects
+        // (name-object index, internal synchronization objects, internal
+        // variables...)
+        return 1024 + bytes(num_slots);
+    }
+
+    size_t num_slots(void) const { return num_slots_; }
+
     // SINK state
     void set_sink_state(NodeState value) { sink_state_ = value; }
     NodeState sink_state(void) const { return sink_state_; }
 
-    // SINK writes (~sample number)
-    // TODO: write_number_ being atomic is redundant because only one sink can
-    //       be bound to a node, right?
+    // SINK writes (~sample number). Atomic because SOURCEs read it while the
+    // SINK is writing.
     uint64_t write_number() const { return write_number_; }
 
-    void notifySinkWriteComplete()
+    size_t depth(void) const { return depth_; }
+    void set_depth(const size_t value)
     {
-        mutex_.wait();
+        if (value == 0 || value > MAX_DEPTH)
+            throw std::runtime_error("Node depth must be between 1 and "
+                                     + std::to_string(MAX_DEPTH) + ".");
 
-        // Require one read from all connected sources
-        source_read_required_ = source_slots_;
+        // Each additional entry provides one more write that does not have
+        // to wait on SOURCE reads
+        for (size_t i = depth_; i < value; i++)
+            write_barrier.post();
 
-        // Tell each source connected to the node that it may read
-        for (size_t i = 0; i < source_slots_.size(); i++)
-            if (source_slots_[i])
-                read_barrier(i).post();
+        depth_ = value;
+    }
 
-        ++write_number_;
+    size_t write_entry(void) const { return write_number_ % depth_; }
+    size_t read_entry(size_t index) const { return slots()[index].read_number % depth_; }
+    uint64_t read_number(size_t index) const { return slots()[index].read_number; }
+
+    // Ring entry sequence numbers. Odd while the SINK is writing to the
+    // entry, even otherwise. Used by lossy SOURCEs to detect torn reads.
+    uint64_t entry_seq(size_t entry) const { return entry_seq_[entry]; }
 
-        mutex_.post();
+    void notifySinkWriteStart()
+    {
+        ++entry_seq_[write_entry()];
     }
 
-    // SOURCE read counting
-    bool notifySourceReadComplete(size_t index)
+    void notifySinkWriteComplete()
     {
-        mutex_.wait();
+        const size_t entry = write_entry();
+        ++entry_seq_[entry];
+
+        // Admit SOURCEs that have claimed a slot since the last write. A
+        // changed generation means the slot was released and claimed again.
+        uint32_t required = 0;
+        for (size_t w = 0; w < num_words_; w++) {
+
+            const uint64_t claimed = claimed_words()[w];
+            const uint64_t active = active_words()[w];
+
+            forEachBit(claimed, w, [this, active](size_t i, uint64_t bit) {
+                Slot &s = slots()[i];
+                const uint32_t gen = s.gen;
+                if (!(active & bit) || s.active_gen != gen) {
+
+                    // Drop posts left over from the slot's previous owner.
+                    // Only writes that occur after this point are owed to
+                    // the new source.
+                    while (s.read_barrier.try_wait()) { }
+                    s.read_number = write_number_.load();
+                    s.active_gen = gen;
+                }
+            });
+
+            // Publish admission last. See admitted().
+            active_words()[w] = claimed;
+            required += __builtin_popcountll(claimed);
+        }
 
-        source_read_required_[index] = false;
-        bool reads_finished = source_read_required_.none();
+        // Require one read of this entry from all active sources
+        reads_required_[entry] = required;
+        for (size_t w = 0; w < num_words_; w++)
+            required_words(entry)[w] = active_words()[w].load();
+
+        // A source that released its slot after we read the bitmap might
+        // have already forfeited its reads. Forfeit on its behalf. Whichever
+        // of us clears the bit does the accounting.
+        for (size_t w = 0; w < num_words_; w++) {
+            forEachBit(active_words()[w], w, [this, entry](size_t i, uint64_t bit) {
+                const Slot &s = slots()[i];
+                if (!(claimed_words()[i / 64] & bit) || s.gen != s.active_gen)
+                    if (forfeit(entry, i))
+                        write_barrier.post();
+            });
+        }
+
+        ++write_number_;
+
+        // Tell each source connected to the node that it may read
+        for (size_t w = 0; w < num_words_; w++) {
+            forEachBit(active_words()[w], w, [this](size_t i, uint64_t) {
+                slots()[i].read_barrier.post();
+            });
+        }
 
-        mutex_.post();
+        // Tell lossy sources there is a new write
+        write_queue.notify();
+    }
+
+    // SOURCE read counting. Returns true if this was the last read that the
+    // entry required.
+    bool notifySourceReadComplete(size_t index)
+    {
+        bool reads_finished = forfeit(read_entry(index), index);
+        ++slots()[index].read_number;
 
         return reads_finished;
     }
 
-    // SOURCE slots
-    static constexpr size_t NUM_SLOTS {10};
+    bool slot_bound(size_t index) const
+    {
+        return index < num_slots_
+               && (claimed_words()[index / 64] & (1ull << (index % 64)));
+    }
+
+    /**
+     * True once the SINK has started counting reads from the source at index.
+     * Until then, the source may see posts that were meant for the previous
+     * owner of its slot and must ignore them.
+     */
+    bool admitted(size_t index) const
+    {
+        const Slot &s = slots()[index];
+        return (active_words()[index / 64] & (1ull << (index % 64)))
+               && s.active_gen == s.gen;
+    }
 
     int acquireSlot(size_t &index)
     {
-        mutex_.wait();
+        for (size_t w = 0; w < num_words_; w++) {
 
-        if (source_slots_.all()) {
-            mutex_.post();
-            return -1;
-        }
+            auto &word = claimed_words()[w];
+            uint64_t claimed = word;
 
-        index = 0;
-        while (source_slots_[index])
-            ++index;
+            while (~claimed != 0) {
 
-        source_slots_[index] = true;
-        source_ref_count_ = source_slots_.count();
+                const size_t b = __builtin_ctzll(~claimed);
+                if (w * 64 + b >= num_slots_)
+                    break;
 
-        mutex_.post();
+                if (word.compare_exchange_weak(claimed, claimed | (1ull << b))) {
+                    index = w * 64 + b;
+                    ++source_ref_count_;
 
-        return 0;
+                    // Publish the owner last. Slots without an owner are
+                    // never reclaimed.
+                    Slot &s = slots()[index];
+                    s.heartbeat_ns = telemetry::now();
+                    s.owner_start = process::startTime(getpid());
+                    s.owner = getpid();
+
+                    // An offline SINK may be waiting for its readers
+                    write_barrier.broadcast();
+
+                    return 0;
+                }
+            }
+        }
+
+        return -1;
     }
 
     int releaseSlot(size_t index)
     {
-        if (index >= source_slots_.size())
+        if (index >= num_slots_)
+            return -1;
+
+        const uint64_t bit = 1ull << (index % 64);
+        auto &word = claimed_words()[index / 64];
+        if (!(word & bit))
             return -1;
 
-        mutex_.wait();
-        source_slots_[index] = false;
-        source_ref_count_ = source_slots_.count();
-        mutex_.post();
+        slots()[index].owner = 0;
+
+        // Mark the slot as having a new owner generation so that a SINK that
+        // is admitting sources right now will forfeit on our behalf
+        ++slots()[index].gen;
+
+        // Forfeit any reads this source still owes so that the sink is not
+        // left waiting on a source that will never read
+        for (size_t i = 0; i < depth_; i++)
+            if (forfeit(i, index))
+                write_barrier.post();
+
+        word &= ~bit;
+        --source_ref_count_;
+
+        // The SINK may be waiting on this source or need to notice that there
+        // are no sources left
+        write_barrier.broadcast();
 
         return 0;
     }
 
     size_t source_ref_count(void) const { return source_ref_count_; }
 
+    /**
+     * Record that the SOURCE at index is alive.
+     */
+    void beat(size_t index) { slots()[index].heartbeat_ns = telemetry::now(); }
+
+    /**
+     * Release the slots of SOURCEs that have not beaten for stale_ns and whose
+     * process no longer exists, e.g. because it was killed. Any reads they
+     * owed are forfeited.
+     *
+     * @return Number of slots released
+     */
+    size_t reclaimDeadSources(const uint64_t stale_ns)
+    {
+        const uint64_t now = telemetry::now();
+        size_t reclaimed = 0;
+
+        for (size_t w = 0; w < num_words_; w++) {
+            forEachBit(claimed_words()[w], w, [&](size_t i, uint64_t) {
+                const Slot &s = slots()[i];
+                const int32_t pid = s.owner;
+                const uint64_t beat = s.heartbeat_ns;
+                if (pid != 0 && beat < now && now - beat > stale_ns
+                        && !process::alive(pid, s.owner_start)
+                        && releaseSlot(i) == 0)
+                    reclaimed++;
+            });
+        }
+
+        return reclaimed;
+    }
+
+    // Lossy SOURCEs do not take a slot. They are not part of the read
+    // barrier and so never hold back the SINK.
+    void acquireLossy() { ++lossy_ref_count_; }
+    void releaseLossy() { --lossy_ref_count_; }
+    size_t lossy_ref_count(void) const { return lossy_ref_count_; }
+
     // Synchronization constructs
     // write _always_ occurs before read. By starting at 1, the writer is not
     // blocked by an initial wait. Readers to do not post to the write_barrier
     // until a write occurs.
     semaphore write_barrier {1};
 
-    // This method is required because an std::array of semaphores requires
-    // each semaphore to be copy-constructed to initialized the array.
-    // Because of their nature, semaphores are NOT copy constructable, so
-    // this approach does not work.
+    // Notified after every SINK write. Lossy SOURCEs block on this.
+    WaitQueue write_queue;
+
     semaphore &read_barrier(size_t index)
     {
-        if (!source_slots_[index])
+        if (index >= num_slots_)
+            throw std::runtime_error("Source index out of range.");
+
+        if (!slot_bound(index))
             throw std::runtime_error("Requested index refers to a SOURCE "
                                      "that is not bound to this node.");
 
-        switch (index) {
-            case 0: return rb0_; break;
-            case 1: return rb1_; break;
-            case 2: return rb2_; break;
-            case 3: return rb3_; break;
-            case 4: return rb4_; break;
-            case 6: return rb6_; break;
-            case 7: return rb7_; break;
-            case 8: return rb8_; break;
-            case 9: return rb9_; break;
-            default:
-                throw std::runtime_error("Source index out of range.");
-                break;
-        }
+        return slots()[index].read_barrier;
+    }
+
+    // Statistics for monitoring tools such as oat-top
+    NodeTelemetry<MAX_DEPTH> & telemetry() { return telemetry_; }
+    const NodeTelemetry<MAX_DEPTH> & telemetry() const { return telemetry_; }
+    SlotTelemetry & slot_telemetry(size_t index) { return slots()[index].telemetry; }
+    const SlotTelemetry & slot_telemetry(size_t index) const { return slots()[index].telemetry; }
+
+    // Wake all waiters so that they re-check SINK state and oat::quit
+    void broadcast()
+    {
+        write_barrier.broadcast();
+        write_queue.notify();
+        for (size_t i = 0; i < num_slots_; i++)
+            slots()[i].read_barrier.broadcast();
     }
 
 private:
 
-    std::atomic<NodeState> sink_state_ {oat::NodeState::UNDEFINED}; //!< SINK state
-    //std::atomic<size_t> source_read_count_ {0}; //!< Number SOURCE reads that have occured since last sink reset
-    std::bitset<NUM_SLOTS> source_slots_;
-    std::bitset<NUM_SLOTS> source_read_required_;
+    struct Slot {
+        semaphore read_barrier;
+        std::atomic<uint64_t> read_number {0}; //!< SOURCE read cursor
+        std::atomic<uint32_t> gen {0}; //!< Bumped each time the slot is released
+        std::atomic<uint32_t> active_gen {0}; //!< Generation admitted by the SINK
+        std::atomic<int32_t> owner {0}; //!< Owning process, 0 while unowned
+        std::atomic<uint64_t> owner_start {0}; //!< Owner's start time, to detect PID reuse
+        std::atomic<uint64_t> heartbeat_ns {0}; //!< Owner's last sign of life
+        SlotTelemetry telemetry;
+    };
+
+    // Trailing storage: [Slot x num_slots][claimed][active][required x MAX_DEPTH]
+    Slot * slots() const
+    {
+        return reinterpret_cast<Slot *>(
+            const_cast<char *>(reinterpret_cast<const char *>(this + 1)));
+    }
 
-    size_t source_ref_count_ {0}; //!< Number of SOURCES sharing this node
-    uint64_t write_number_ {0}; //!< Number of writes to shmem that have been facilited by this node
+    std::atomic<uint64_t> * words() const
+    {
+        return reinterpret_cast<std::atomic<uint64_t> *>(slots() + num_slots_);
+    }
 
-    // Unfortunately, must manually maintain the number of rbx_'s to match NUM_SLOTS
-    semaphore mutex_ {1}; //!< mutex governing exclusive acces to the read_barrier_
-    semaphore rb0_ {0}, rb1_ {0}, rb2_ {0}, rb3_ {0}, rb4_ {0},
-              rb5_ {0}, rb6_ {0}, rb7_ {0}, rb8_ {0}, rb9_ {0};
+    std::atomic<uint64_t> * claimed_words() const { return words(); }
+    std::atomic<uint64_t> * active_words() const { return words() + num_words_; }
+    std::atomic<uint64_t> * required_words(size_t entry) const
+    {
+        return words() + (2 + entry) * num_words_;
+    }
+
+    template <typename F>
+    static void forEachBit(uint64_t bits, const size_t word, F f)
+    {
+        while (bits) {
+            const size_t b = __builtin_ctzll(bits);
+            const uint64_t bit = 1ull << b;
+            f(word * 64 + b, bit);
+            bits &= ~bit;
+        }
+    }
+
+    // Clear the read of entry owed by the source at index. Returns true if
+    // this was the last read the entry required.
+    bool forfeit(const size_t entry, const size_t index)
+    {
+        const uint64_t bit = 1ull << (index % 64);
+        if (!(required_words(entry)[index / 64].fetch_and(~bit) & bit))
+            return false;
+
+        return --reads_required_[entry] == 0;
+    }
+
+    std::atomic<NodeState> sink_state_ {oat::NodeState::UNDEFINED}; //!< SINK state
+    const size_t num_slots_; //!< Number of SOURCE slots
+    const size_t num_words_; //!< Number of 64-bit words in each slot bitmap
+    std::atomic<size_t> source_ref_count_ {0}; //!< Number of SOURCES sharing this node
+    std::atomic<size_t> lossy_ref_count_ {0}; //!< Number of lossy SOURCES sharing this node
+    size_t depth_ {1}; //!< Number of ring entries the SINK writes to
+    std::atomic<uint64_t> write_number_ {0}; //!< Number of writes to shmem that have been facilited by this node
+    std::array<std::atomic<uint64_t>, MAX_DEPTH> entry_seq_; //!< Per-entry seqlock counters
+    std::array<std::atomic<uint32_t>, MAX_DEPTH> reads_required_; //!< Outstanding SOURCE reads per entry
+    NodeTelemetry<MAX_DEPTH> telemetry_;
 };
 
 }       /* namespace oat */
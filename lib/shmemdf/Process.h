@@ -0,0 +1,98 @@
+//******************************************************************************
+//* File:   Process.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_PROCESS_H
+#define	OAT_PROCESS_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <signal.h>
+
+namespace oat {
+namespace process {
+
+/**
+ * @brief State and start time, in clock ticks since boot, of a process.
+ * @return False if the process does not exist.
+ */
+inline bool stat(const int32_t pid, char &state, uint64_t &start)
+{
+    std::ifstream f("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat;
+    if (!std::getline(f, stat))
+        return false;
+
+    // The command name may contain spaces. State is the first field
+    // after it and start time is the 20th.
+    const size_t name_end = stat.rfind(')');
+    if (name_end == std::string::npos)
+        return false;
+
+    std::istringstream fields(stat.substr(name_end + 1));
+    std::string field;
+    fields >> state;
+    for (int i = 1; i < 20; i++)
+        fields >> field;
+
+    start = std::strtoull(field.c_str(), nullptr, 10);
+    return static_cast<bool>(fields);
+}
+
+/**
+ * @brief Start time of a process, or 0 if it is unknown. Together with the
+ * PID, this identifies a process even if its PID is later reused.
+ */
+inline uint64_t startTime(const int32_t pid)
+{
+    char state;
+    uint64_t start;
+    return stat(pid, state, start) ? start : 0;
+}
+
+/**
+ * @brief Whether a process is running.
+ * @param pid Process ID.
+ * @param start Start time from startTime(), or 0 to accept any process with
+ * this PID.
+ */
+inline bool alive(const int32_t pid, const uint64_t start)
+{
+    if (kill(pid, 0) != 0 && errno == ESRCH)
+        return false;
+
+    // Without /proc, trust kill()
+    char state;
+    uint64_t now_start;
+    if (!stat(pid, state, now_start))
+        return true;
+
+    // Killed but not yet reaped, or a different process that was given
+    // the same PID
+    return state != 'Z' && state != 'X'
+           && (start == 0 || now_start == start);
+}
+
+}      /* namespace process */
+}      /* namespace oat */
+#endif /* OAT_PROCESS_H */
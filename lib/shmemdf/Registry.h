@@ -0,0 +1,300 @@
+//******************************************************************************
+//* File:   Registry.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_REGISTRY_H
+#define	OAT_REGISTRY_H
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <time.h>
+#include <unistd.h>
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+
+#include "Process.h"
+#include "../utility/IOFormat.h"
+
+namespace oat {
+
+/**
+ * Host-wide table of the nodes in shared memory. SINKs record a node's type
+ * and geometry when they bind, and SOURCEs record themselves when they
+ * touch. Entries are removed when the last component leaves the node, so
+ * tools can list the graph without knowing stream names. Nodes whose
+ * components all died without leaving are stale and can be removed with
+ * `oat clean --stale`.
+ *
+ * Every update holds the registry segment's mutex. Updates only occur when
+ * components attach to or leave nodes, never while samples are being
+ * passed.
+ */
+class Registry {
+
+public:
+
+    static constexpr size_t MAX_NODES {256};
+    static constexpr size_t MAX_MEMBERS {16};
+    static constexpr size_t NAME_LENGTH {64};
+
+    // A process holding one or more SOURCEs on a node
+    struct Member {
+        int32_t pid {0};
+        uint64_t start {0};
+        uint32_t sources {0};
+    };
+
+    struct Entry {
+        char name[NAME_LENGTH] {};  //!< Stream address. Empty if unused.
+        char type[NAME_LENGTH] {};  //!< Mangled name of the shared type
+        uint64_t bytes {0};         //!< Bytes per sample
+        uint64_t depth {0};         //!< Ring entries
+        uint64_t rows {0};          //!< Frame rows, 0 if not a frame stream
+        uint64_t cols {0};          //!< Frame columns, 0 if not a frame stream
+        int32_t sink_pid {0};       //!< Bound SINK, 0 if none
+        uint64_t sink_start {0};    //!< SINK's process start time
+        uint64_t created_ns {0};    //!< Wall clock time the entry was made
+        uint32_t readers {0};       //!< SOURCEs attached
+        uint32_t untracked {0};     //!< SOURCEs beyond MAX_MEMBERS processes
+        Member members[MAX_MEMBERS];
+
+        /**
+         * True if no process that bound or touched the node is still
+         * running.
+         */
+        bool stale() const
+        {
+            if (untracked > 0)
+                return false;
+            if (sink_pid != 0 && process::alive(sink_pid, sink_start))
+                return false;
+            for (const auto &m : members) {
+                if (m.pid != 0 && process::alive(m.pid, m.start))
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    /**
+     * @brief The process' view of the registry, mapped on first use.
+     */
+    static Registry &instance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    Registry(const Registry &) = delete;
+    Registry &operator=(const Registry &) = delete;
+
+    /**
+     * @brief Name of the shared memory segment holding the registry.
+     */
+    static const char *name() { return "oat_registry"; }
+
+    void bindSink(const std::string &address,
+                  const char *type,
+                  const uint64_t bytes,
+                  const uint64_t depth)
+    {
+        update(address, [type, bytes, depth](Entry &e) {
+            std::strncpy(e.type, type, NAME_LENGTH - 1);
+            e.bytes = bytes;
+            e.depth = depth;
+            e.sink_pid = getpid();
+            e.sink_start = process::startTime(e.sink_pid);
+        });
+    }
+
+    void setFrameSize(const std::string &address,
+                      const uint64_t rows,
+                      const uint64_t cols)
+    {
+        update(address, [rows, cols](Entry &e) {
+            e.rows = rows;
+            e.cols = cols;
+        });
+    }
+
+    void unbindSink(const std::string &address)
+    {
+        update(address, [](Entry &e) {
+            e.sink_pid = 0;
+            e.sink_start = 0;
+        });
+    }
+
+    void attachSource(const std::string &address)
+    {
+        const int32_t pid = getpid();
+        const uint64_t start = process::startTime(pid);
+
+        update(address, [pid, start](Entry &e) {
+            e.readers++;
+            Member *free = nullptr;
+            for (auto &m : e.members) {
+                if (m.pid == pid && m.start == start) {
+                    m.sources++;
+                    return;
+                }
+                if (m.pid == 0 && free == nullptr)
+                    free = &m;
+            }
+
+            if (free == nullptr) {
+                e.untracked++;
+                return;
+            }
+
+            free->pid = pid;
+            free->start = start;
+            free->sources = 1;
+        });
+    }
+
+    void detachSource(const std::string &address)
+    {
+        const int32_t pid = getpid();
+        const uint64_t start = process::startTime(pid);
+
+        update(address, [pid, start](Entry &e) {
+            if (e.readers > 0)
+                e.readers--;
+            for (auto &m : e.members) {
+                if (m.pid == pid && m.start == start) {
+                    if (--m.sources == 0)
+                        m = Member();
+                    return;
+                }
+            }
+            if (e.untracked > 0)
+                e.untracked--;
+        });
+    }
+
+    /**
+     * @brief Forget a node, e.g. after its segments have been removed.
+     */
+    void remove(const std::string &address)
+    {
+        auto erase = [this, &address] {
+            Entry *e = find(address);
+            if (e != nullptr)
+                *e = Entry();
+        };
+        segment_.atomic_func(erase);
+    }
+
+    /**
+     * @brief Copy of every entry in use.
+     */
+    std::vector<Entry> list()
+    {
+        std::vector<Entry> out;
+        auto copy = [this, &out] {
+            for (size_t i = 0; i < MAX_NODES; i++) {
+                if (table_[i].name[0] != '\0')
+                    out.push_back(table_[i]);
+            }
+        };
+        segment_.atomic_func(copy);
+
+        return out;
+    }
+
+private:
+
+    Registry()
+    : segment_(boost::interprocess::open_or_create, name(),
+               sizeof(Entry) * MAX_NODES + 4096)
+    {
+        auto attach = [this] {
+            table_ = segment_.find_or_construct<Entry>("nodes")[MAX_NODES]();
+        };
+        segment_.atomic_func(attach);
+    }
+
+    Entry * find(const std::string &address)
+    {
+        for (size_t i = 0; i < MAX_NODES; i++) {
+            if (address.compare(table_[i].name) == 0)
+                return &table_[i];
+        }
+        return nullptr;
+    }
+
+    // Apply change to the node's entry, making one if needed. Entries that
+    // nothing refers to anymore are removed.
+    template <typename Change>
+    void update(const std::string &address, Change change)
+    {
+        if (address.size() >= NAME_LENGTH)
+            return;
+
+        bool full = false;
+        auto apply = [this, &address, &change, &full] {
+
+            Entry *e = find(address);
+
+            // Use a free entry, or failing that, one whose node is stale
+            for (size_t i = 0; e == nullptr && i < MAX_NODES; i++) {
+                if (table_[i].name[0] == '\0')
+                    e = &table_[i];
+            }
+            for (size_t i = 0; e == nullptr && i < MAX_NODES; i++) {
+                if (table_[i].stale())
+                    e = &table_[i];
+            }
+            if (e == nullptr) {
+                full = true;
+                return;
+            }
+
+            if (address.compare(e->name) != 0) {
+                *e = Entry();
+                std::strncpy(e->name, address.c_str(), NAME_LENGTH - 1);
+                timespec ts;
+                clock_gettime(CLOCK_REALTIME, &ts);
+                e->created_ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000
+                                + ts.tv_nsec;
+            }
+
+            change(*e);
+
+            if (e->sink_pid == 0 && e->readers == 0)
+                *e = Entry();
+        };
+        segment_.atomic_func(apply);
+
+        if (full)
+            std::cerr << oat::Warn("The node registry is full, so '" + address
+                                   + "' will not be listed. Use oat clean to "
+                                   "remove unused nodes.\n");
+    }
+
+    boost::interprocess::managed_shared_memory segment_;
+    Entry *table_ {nullptr};
+};
+
+}      /* namespace oat */
+#endif /* OAT_REGISTRY_H */
@@ -0,0 +1,375 @@
+//******************************************************************************
+//* File:   Semaphore.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SEMAPHORE_H
+#define	OAT_SEMAPHORE_H
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <stdexcept>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef SYS_futex_waitv
+#define SYS_futex_waitv 449
+#endif
+
+namespace oat {
+
+namespace detail {
+
+// Layout of struct futex_waitv, which older kernel headers lack
+struct FutexWaitv {
+    uint64_t val;
+    uint64_t uaddr;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+// FUTEX2_SIZE_U32 and FUTEX_WAITV_MAX
+static constexpr uint32_t FUTEX2_U32 {0x02};
+static constexpr size_t FUTEX_WAITV_LIMIT {128};
+
+} // namespace detail
+
+/**
+ * Process-shared futex word that threads can block on until a condition of
+ * their choosing becomes true.
+ *
+ * Waiters sleep on a sequence word that is bumped by notify(). Anything that
+ * changes a condition that a waiter might be blocked on must be followed by a
+ * call to notify(). There is no periodic timeout unless one is requested with
+ * wait_for(). wait_any() blocks on several queues at once.
+ *
+ * This object is designed to live in shared memory and must not contain
+ * pointers.
+ */
+class WaitQueue {
+public:
+
+    WaitQueue()
+    {
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                "std::atomic<uint32_t> must be usable as a futex word.");
+    }
+
+    // WaitQueues are not copyable
+    WaitQueue(const WaitQueue &) = delete;
+    WaitQueue & operator=(const WaitQueue &) = delete;
+
+    /**
+     * Block until a condition is true.
+     *
+     * @param done Predicate that is evaluated before blocking and each time
+     * the calling thread is woken.
+     */
+    template <typename Pred>
+    void wait(Pred done)
+    {
+        while (true) {
+
+            // Sample the sequence before checking so that a notify() that
+            // occurs in between causes futex() to return immediately rather
+            // than being missed
+            const uint32_t seq = seq_;
+
+            if (done())
+                return;
+
+            ++waiters_;
+            syscall(SYS_futex, futexWord(), FUTEX_WAIT, seq, nullptr, nullptr, 0);
+            --waiters_;
+        }
+    }
+
+    /**
+     * Block until a condition is true or no notify() has woken the calling
+     * thread for timeout_ns.
+     *
+     * @param done Predicate that is evaluated before blocking and each time
+     * the calling thread is woken.
+     * @param timeout_ns Longest time to block between wake ups.
+     * @return True if the condition is true, false if the wait timed out.
+     */
+    template <typename Pred>
+    bool wait_for(Pred done, const uint64_t timeout_ns)
+    {
+        timespec timeout;
+        timeout.tv_sec = timeout_ns / 1000000000;
+        timeout.tv_nsec = timeout_ns % 1000000000;
+
+        while (true) {
+
+            const uint32_t seq = seq_;
+
+            if (done())
+                return true;
+
+            ++waiters_;
+            const long rc = syscall(SYS_futex, futexWord(), FUTEX_WAIT, seq,
+                                    &timeout, nullptr, 0);
+            const bool timed_out = rc != 0 && errno == ETIMEDOUT;
+            --waiters_;
+
+            if (timed_out)
+                return done();
+        }
+    }
+
+    /**
+     * Block until a condition is true, waking whenever any of several queues
+     * is notified. Uses futex_waitv(2), so a single sleep covers all queues.
+     * Kernels older than 5.16 fall back to waking every millisecond.
+     *
+     * @param queues Queues whose notify() may change the condition.
+     * @param n Number of queues.
+     * @param done Predicate that is evaluated before blocking and each time
+     * the calling thread is woken.
+     */
+    template <typename Pred>
+    static void wait_any(WaitQueue * const *queues, const size_t n, Pred done)
+    {
+        if (n == 0)
+            throw std::runtime_error("wait_any() requires at least one queue.");
+
+        detail::FutexWaitv waiters[detail::FUTEX_WAITV_LIMIT];
+        const size_t nw = n < detail::FUTEX_WAITV_LIMIT ? n : detail::FUTEX_WAITV_LIMIT;
+
+        while (true) {
+
+            // Sample every sequence before checking. See wait().
+            for (size_t i = 0; i < nw; i++) {
+                waiters[i].val = queues[i]->seq_;
+                waiters[i].uaddr = reinterpret_cast<uintptr_t>(queues[i]->futexWord());
+                waiters[i].flags = detail::FUTEX2_U32;
+                waiters[i].reserved = 0;
+            }
+
+            if (done())
+                return;
+
+            for (size_t i = 0; i < nw; i++)
+                ++queues[i]->waiters_;
+
+            long rc = -1;
+            errno = ENOSYS;
+            if (n == nw)
+                rc = syscall(SYS_futex_waitv, waiters, nw, 0, nullptr, CLOCK_MONOTONIC);
+
+            if (rc < 0 && (errno == ENOSYS || errno == EINVAL)) {
+                const timespec poll {0, 1000000};
+                syscall(SYS_futex, queues[0]->futexWord(), FUTEX_WAIT,
+                        waiters[0].val, &poll, nullptr, 0);
+            }
+
+            for (size_t i = 0; i < nw; i++)
+                --queues[i]->waiters_;
+        }
+    }
+
+    /**
+     * Wake up to n waiters so that they re-evaluate their condition. This
+     * function is async-signal-safe.
+     */
+    void notify(const int n = INT_MAX)
+    {
+        ++seq_;
+        if (waiters_ > 0)
+            syscall(SYS_futex, futexWord(), FUTEX_WAKE, n, nullptr, nullptr, 0);
+    }
+
+private:
+
+    int * futexWord() { return reinterpret_cast<int *>(&seq_); }
+
+    std::atomic<uint32_t> seq_ {0};
+    std::atomic<uint32_t> waiters_ {0};
+};
+
+/**
+ * Process-shared counting semaphore built on a WaitQueue.
+ *
+ * Unlike bip::interprocess_semaphore, a blocked wait() does not need to
+ * time out periodically to notice that it should give up. Instead, waiters
+ * re-evaluate a caller-supplied abort condition each time they are woken.
+ * Anything that changes the abort condition (e.g. the SINK setting
+ * NodeState::END, or SIGINT setting oat::quit) must be followed by a call to
+ * broadcast().
+ */
+class Semaphore {
+public:
+
+    explicit Semaphore(const uint32_t count = 0)
+    : count_ {count}
+    {
+        // Nothing
+    }
+
+    // Semaphores are not copyable
+    Semaphore(const Semaphore &) = delete;
+    Semaphore & operator=(const Semaphore &) = delete;
+
+    uint32_t count(void) const { return count_; }
+
+    void post()
+    {
+        ++count_;
+        queue_.notify(1);
+    }
+
+    bool try_wait()
+    {
+        uint32_t c = count_;
+        while (c > 0) {
+            if (count_.compare_exchange_weak(c, c - 1))
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * Decrement the semaphore, blocking until that is possible.
+     *
+     * @param abort Predicate that is evaluated whenever the semaphore cannot be
+     * decremented. If it returns true, the wait is abandoned.
+     * @return True if the semaphore was decremented, false if the wait was
+     * abandoned.
+     */
+    template <typename Pred>
+    bool wait(Pred abort)
+    {
+        bool decremented = false;
+        queue_.wait([this, &decremented, &abort] {
+            decremented = try_wait();
+            return decremented || abort();
+        });
+
+        return decremented;
+    }
+
+    /**
+     * As wait(), but give up if the semaphore cannot be decremented and no
+     * post() or broadcast() occurs for timeout_ns.
+     *
+     * @return 1 if the semaphore was decremented, 0 if the wait was
+     * abandoned, -1 if it timed out.
+     */
+    template <typename Pred>
+    int wait_for(Pred abort, const uint64_t timeout_ns)
+    {
+        bool decremented = false;
+        const bool done = queue_.wait_for([this, &decremented, &abort] {
+            decremented = try_wait();
+            return decremented || abort();
+        }, timeout_ns);
+
+        if (!done)
+            return -1;
+
+        return decremented ? 1 : 0;
+    }
+
+    /**
+     * Wake all waiters so that they re-evaluate their abort condition. This
+     * function is async-signal-safe.
+     */
+    void broadcast() { queue_.notify(); }
+
+    WaitQueue & queue() { return queue_; }
+
+private:
+
+    std::atomic<uint32_t> count_;
+    WaitQueue queue_;
+};
+
+namespace detail {
+
+// Queues that a thread of this process might be blocked on. Zero
+// initialized at load time so that it is safe to touch from a signal handler.
+// Large enough for one process to hold a SOURCE in every slot of a node.
+static constexpr size_t MAX_SHUTDOWN_WAITERS {1024};
+
+inline std::atomic<WaitQueue *> * shutdownWaiters()
+{
+    static std::atomic<WaitQueue *> waiters[MAX_SHUTDOWN_WAITERS];
+    return waiters;
+}
+
+} // namespace detail
+
+/**
+ * Register a queue that this process may block on so that it is woken by
+ * wakeForShutdown().
+ */
+inline void registerForShutdown(WaitQueue *queue)
+{
+    auto waiters = detail::shutdownWaiters();
+    for (size_t i = 0; i < detail::MAX_SHUTDOWN_WAITERS; i++) {
+        WaitQueue *expected = nullptr;
+        if (waiters[i].compare_exchange_strong(expected, queue))
+            return;
+    }
+
+    throw std::runtime_error("Too many shared memory nodes in one process.");
+}
+
+inline void registerForShutdown(Semaphore *sem)
+{
+    registerForShutdown(&sem->queue());
+}
+
+inline void unregisterForShutdown(WaitQueue *queue)
+{
+    auto waiters = detail::shutdownWaiters();
+    for (size_t i = 0; i < detail::MAX_SHUTDOWN_WAITERS; i++) {
+        WaitQueue *expected = queue;
+        if (waiters[i].compare_exchange_strong(expected, nullptr))
+            return;
+    }
+}
+
+inline void unregisterForShutdown(Semaphore *sem)
+{
+    unregisterForShutdown(&sem->queue());
+}
+
+/**
+ * Wake every registered queue so that blocked SINKs and SOURCEs notice
+ * oat::quit. Set oat::quit before calling. This function is
+ * async-signal-safe.
+ */
+inline void wakeForShutdown()
+{
+    auto waiters = detail::shutdownWaiters();
+    for (size_t i = 0; i < detail::MAX_SHUTDOWN_WAITERS; i++) {
+        WaitQueue *queue = waiters[i];
+        if (queue != nullptr)
+            queue->notify();
+    }
+}
+
+}       /* namespace oat */
+#endif	/* OAT_SEMAPHORE_H */
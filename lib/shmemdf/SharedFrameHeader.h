@@ -21,10 +21,14 @@
 #define	OAT_SHAREDFRAMEHEADER_H
 
 #include <atomic>
+#include <cstring>
+#include <string>
 #include <boost/interprocess/managed_shared_memory.hpp>
 
 #include "../datatypes/Color.h"
 
+#include "FramePages.h"
+
 namespace oat {
 namespace bip = boost::interprocess;
 
@@ -34,6 +38,7 @@ struct FrameParams {
     int type  {0};
     oat::PixelColor color {oat::PIX_BGR};
     size_t bytes {0};
+    uint64_t generation {0}; //!< Incremented each time the SINK reshapes frames
 };
 
 /** Header to facilitate zero-copy oat::Frame exchange through shared
@@ -45,6 +50,10 @@ struct FrameParams {
   * two blocks of shared memory, one for matrix data and other for sample count
   * and rate information. Non-pointer members allow construction of Frames at
   * source and sink end contain this data and sample information.
+  *
+  * Each ring entry also records the geometry of the frame it holds, so that
+  * the SINK can change frame size or type without tearing down the node. The
+  * data block reserves capacity() bytes per entry to make room for this.
   */
 
 class SharedFrameHeader {
@@ -55,7 +64,11 @@ public :
 
     handle_t sample() const { return sample_; }
     handle_t data() const { return data_; }
+    handle_t geometry() const { return geometry_; }
+    size_t capacity() const { return capacity_; }
     FrameParams params() const { return params_; }
+    FramePages pages() const { return pages_; }
+    const char * pages_path() const { return pages_path_; }
 
     /**
      * Set header data fields.
@@ -81,6 +94,42 @@ public :
         params_.color = color;
     }
 
+    /**
+     * Set the per-entry frame geometry block.
+     *
+     * @param geometry Interprocess handle to one FrameParams per ring entry
+     * @param capacity Bytes of matrix data reserved for each ring entry
+     */
+    void setGeometry(const handle_t geometry, const size_t capacity)
+    {
+        geometry_ = geometry;
+        capacity_ = capacity;
+    }
+
+    /**
+     * Publish the geometry of the most recent frame for SOURCEs that have
+     * yet to connect.
+     *
+     * @param params Geometry of the most recent frame
+     */
+    void reshape(const FrameParams &params) { params_ = params; }
+
+    /**
+     * Record how the matrix data is backed. If it lives in a hugetlbfs file,
+     * the data handle is unused and SOURCEs must map the file at path.
+     *
+     * @param pages Backing of the matrix data
+     * @param path hugetlbfs file holding the matrix data
+     */
+    void setPages(const FramePages pages, const std::string &path = "")
+    {
+        if (path.size() >= sizeof(pages_path_))
+            throw std::runtime_error("Frame data path '" + path + "' is too long.");
+
+        pages_ = pages;
+        std::strncpy(pages_path_, path.c_str(), sizeof(pages_path_));
+    }
+
 private :
 
     // TODO: Should these be atomic? They should already be protected by
@@ -94,6 +143,12 @@ private :
     // Interprocess matrix data and sample handles
     handle_t data_;
     handle_t sample_;
+    handle_t geometry_;
+    size_t capacity_ {0};
+
+    // Matrix data backing
+    FramePages pages_ {FramePages::DEFAULT};
+    char pages_path_[256] {};
 };
 
 }       /* namespace oat */
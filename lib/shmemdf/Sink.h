@@ -20,19 +20,26 @@
 #ifndef OAT_SINK_H
 #define	OAT_SINK_H
 
+#include <algorithm>
 #include <boost/interprocess/managed_shared_memory.hpp>
-#include <boost/thread/thread_time.hpp>
 #include <iostream>
 #include <memory>
 #include <string>
 
+#include <unistd.h>
+
 #include "../datatypes/Color.h"
 #include "../datatypes/Frame.h"
 #include "../datatypes/Sample.h"
+#include "../datatypes/Trace.h"
 #include "../base/Globals.h"
+#include "../utility/IOFormat.h"
 
+#include "Channel.h"
 #include "ForwardsDecl.h"
+#include "FramePages.h"
 #include "Node.h"
+#include "Registry.h"
 #include "SharedFrameHeader.h"
 
 namespace oat {
@@ -50,8 +57,32 @@ public:
     void wait();
     void post();
 
+    /**
+     * Continue upstream's latency trace in the sample being written, adding a
+     * hop through who that began at enter_ns and ends now. Must be called
+     * between wait() and post(). Samples whose trace is not continued from
+     * upstream are posted without hops. Has no effect unless tracing is
+     * enabled.
+     */
+    void trace(const Trace &upstream,
+               const std::string &who,
+               const uint64_t enter_ns);
+
 protected:
 
+    // Create the node's trace block if tracing is enabled. Must be called
+    // before SOURCEs are allowed to connect.
+    void bindTrace();
+
+    // Use an in-process channel instead of a node if oat run has enabled one
+    // for this address. Returns false if the node must be used.
+    bool bindChannel(const std::string &address, const size_t depth);
+
+    // New channel entry, carrying a trace if tracing
+    template <typename... Targs>
+    typename Channel<typename ChannelPayload<T>::type>::Entry
+    makeEntry(Targs... args) const;
+
     std::string address_;
     shmem_t node_shmem_, obj_shmem_;
     Node * node_ {nullptr};
@@ -59,8 +90,27 @@ protected:
     std::string node_address_, obj_address_;
     bool bound_ {false};
 
+    // SOURCEs to wait for before writing offline, 0 if not offline
+    size_t offline_readers_ {0};
+
+    // In-process channel and the entry being written, used instead of the
+    // node when both ends of the stream are stages of oat run
+    using Payload = typename ChannelPayload<T>::type;
+    std::shared_ptr<Channel<Payload>> channel_;
+    typename Channel<Payload>::Entry writing_;
+
 private:
+
+    // Trace of the sample being written, or nullptr if not tracing
+    Trace * writeTrace();
+
     bool did_wait_need_post_ {false};
+
+    // One trace per ring entry, only allocated when tracing
+    shmem_t trace_shmem_;
+    Trace * traces_ {nullptr};
+    std::string trace_address_;
+    bool did_trace_ {false};
 };
 
 template <typename T>
@@ -72,13 +122,24 @@ inline SinkBase<T>::SinkBase()
 template <typename T>
 inline SinkBase<T>::~SinkBase()
 {
+    if (bound_ && channel_ != nullptr) {
+        channel_->unbind();
+        return;
+    }
+
     // Detach this server from shared mat header
     if (bound_) {
 
+        unregisterForShutdown(&node_->write_barrier);
+        Registry::instance().unbindSink(address_);
+
+        // Tell sources that are waiting on this sink that it has left
         node_->set_sink_state(NodeState::END);
+        node_->broadcast();
 
         // If the client ref count is 0, memory can be deallocated
         if (node_->source_ref_count() == 0 &&
+            node_->lossy_ref_count() == 0 &&
             bip::shared_memory_object::remove(node_address_.c_str()) &&
             bip::shared_memory_object::remove(obj_address_.c_str())) {
 
@@ -101,17 +162,57 @@ inline void SinkBase<T>::wait()
         throw std::runtime_error("wait() called when post() was required.");
 #endif
 
-    boost::system_time timeout = boost::get_system_time() + msec_t(10);
+    if (channel_ != nullptr) {
+
+        // Same offline and backpressure rules as the node below
+        size_t n = 0;
+        if (offline_readers_ > 0)
+            n = channel_->write_number() == 0 ? offline_readers_ : 1;
 
-    // Only wait if there is a SOURCE attached to the node
-    // Wait with timed wait with period check to prevent deadlocks
-    while (node_->source_ref_count() > 0 &&
-          !node_->write_barrier.timed_wait(timeout) &&
-          !quit) {
-        // Loops checking if wait has been released
-        timeout = boost::get_system_time() + msec_t(10);
+        const uint64_t t0 = telemetry::now();
+        writing_ = channel_->acquire(n);
+        if (ProcessStats *stats = telemetry::thread_stats())
+            stats->sink_wait.record(telemetry::now() - t0);
+
+        did_wait_need_post_ = true;
+        return;
     }
 
+    // Offline, nothing may be written before there is someone to read it. The
+    // first write waits for every declared reader.
+    if (offline_readers_ > 0) {
+        const size_t n = node_->write_number() == 0 ? offline_readers_ : 1;
+        node_->write_barrier.queue().wait([this, n] {
+            return node_->source_ref_count() >= n || quit;
+        });
+    }
+
+    // Only wait if there is a SOURCE attached to the node. The wait is
+    // abandoned if all SOURCEs detach or we are told to quit. While we are
+    // kept waiting, periodically release slots held by SOURCEs that died
+    // without detaching so that they cannot block us forever.
+    if (node_->source_ref_count() > 0) {
+        const uint64_t t0 = telemetry::now();
+        while (node_->write_barrier.wait_for([this] {
+                   return node_->source_ref_count() == 0 || quit;
+               }, Node::WATCHDOG_NS) < 0) {
+
+            const size_t n = node_->reclaimDeadSources(Node::WATCHDOG_NS);
+            if (n > 0)
+                std::cerr << oat::Warn("Released " + std::to_string(n)
+                                       + " SOURCE slot(s) of '" + address_
+                                       + "' whose process exited without "
+                                       "detaching.\n");
+        }
+        const uint64_t waited = telemetry::now() - t0;
+        telemetry::add(node_->telemetry().sink_wait_ns, waited);
+        if (ProcessStats *stats = telemetry::thread_stats())
+            stats->sink_wait.record(waited);
+    }
+
+    // Lossy SOURCEs must not trust this entry until post()
+    node_->notifySinkWriteStart();
+
     did_wait_need_post_ = true;
 }
 
@@ -126,7 +227,20 @@ inline void SinkBase<T>::post()
         throw std::runtime_error("post() called when wait() was required.");
 #endif
 
+    // A sample that does not continue an upstream trace was captured here
+    Trace *t = writeTrace();
+    if (t != nullptr && !did_trace_)
+        t->clear();
+    did_trace_ = false;
+
+    if (channel_ != nullptr) {
+        channel_->publish(writing_);
+        did_wait_need_post_ = false;
+        return;
+    }
+
     // Increment the number times this node has facilitated a shmem write
+    node_->telemetry().recordWrite(node_->write_entry());
     node_->notifySinkWriteComplete();
 
     did_wait_need_post_ = false;
@@ -137,6 +251,76 @@ inline void SinkBase<T>::post()
 #endif
 }
 
+template <typename T>
+inline void SinkBase<T>::trace(const Trace &upstream,
+                               const std::string &who,
+                               const uint64_t enter_ns)
+{
+    Trace *t = writeTrace();
+    if (t == nullptr)
+        return;
+
+    // An untraced upstream has no hops, so the trace starts here
+    *t = upstream;
+    t->appendHop(who, enter_ns, telemetry::now());
+
+    did_trace_ = true;
+}
+
+template <typename T>
+inline void SinkBase<T>::bindTrace()
+{
+    // Traces left by a previous SINK at this address must not be mistaken
+    // for ours
+    trace_address_ = address_ + "_trace";
+    bip::shared_memory_object::remove(trace_address_.c_str());
+
+    if (!Trace::enabled())
+        return;
+
+    trace_shmem_ = bip::managed_shared_memory(
+            bip::create_only,
+            trace_address_.c_str(),
+            1024 + Node::MAX_DEPTH * sizeof(Trace));
+    traces_ = trace_shmem_.construct<Trace>(
+            typeid(Trace).name())[Node::MAX_DEPTH]();
+}
+
+template <typename T>
+inline Trace * SinkBase<T>::writeTrace()
+{
+    if (channel_ != nullptr)
+        return writing_ != nullptr ? writing_->trace.get() : nullptr;
+
+    return traces_ != nullptr ? &traces_[node_->write_entry()] : nullptr;
+}
+
+template <typename T>
+inline bool SinkBase<T>::bindChannel(const std::string &address,
+                                     const size_t depth)
+{
+    if (!Channels::instance().enabled(address))
+        return false;
+
+    channel_ = Channels::instance().find<Payload>(address);
+    channel_->bind(address, depth);
+    offline_readers_ = offlineReaders(address);
+
+    return true;
+}
+
+template <typename T>
+template <typename... Targs>
+inline typename Channel<typename ChannelPayload<T>::type>::Entry
+SinkBase<T>::makeEntry(Targs... args) const
+{
+    auto e = std::make_shared<typename Channel<Payload>::Slot>(args...);
+    if (Trace::enabled())
+        e->trace.reset(new Trace());
+
+    return e;
+}
+
 /* SPECIALIZATIONS */
 
 // 0. Generic without need for zero-copy storage
@@ -152,12 +336,16 @@ class Sink : public SinkBase<T> {
     using SinkBase<T>::node_;
     using SinkBase<T>::sh_object_;
     using SinkBase<T>::bound_;
+    using SinkBase<T>::offline_readers_;
+    using SinkBase<T>::channel_;
+    using SinkBase<T>::writing_;
 
 public:
 
     template<typename ...Targs>
     void bind(const std::string &address, Targs... args);
     T * retrieve();
+    void post();
 
 };
 
@@ -169,22 +357,36 @@ inline void Sink<T>::bind(const std::string &address, Targs... args)
         throw std::runtime_error("A sink can only bind a "
                                  "single time to a single node.");
 
+    // Map the shared clock before the first sample is stamped
+    SharedClock::instance();
+
     // Addresses for this block of shared memory
     address_ = address;
     node_address_ = address + "_node";
     obj_address_ = address + "_obj";
 
-    // Define shared memory
-    // Extra 1024 bytes are used to hold managed shared mem helper objects
-    // (name-object index, internal synchronization objects, internal
-    // variables...)
+    // Samples are written to a private staging object and copied into a
+    // channel entry on each post()
+    if (this->bindChannel(address, 1)) {
+        auto prototype = this->makeEntry(args...);
+        sh_object_ = &prototype->value;
+        channel_->open(prototype, [this] {
+            return this->makeEntry(*sh_object_);
+        });
+        bound_ = true;
+        return;
+    }
+
+    // Define shared memory. The number of SOURCE slots is fixed by whichever
+    // component creates the node.
+    const size_t num_slots = Node::configuredSlots();
     node_shmem_ = bip::managed_shared_memory(
             bip::open_or_create,
             node_address_.c_str(),
-            1024 + sizeof(Node));
+            Node::shmemBytes(num_slots));
 
     // Bind to a node which facilitates synchronized access to shmem
-    node_ = node_shmem_.template find_or_construct<Node>(typeid(Node).name())();
+    node_ = Node::findOrCreate(node_shmem_, num_slots);
 
     // Make sure there is not another SINK using this shmem
     if (node_->sink_state() != NodeState::UNDEFINED) {
@@ -201,7 +403,13 @@ inline void Sink<T>::bind(const std::string &address, Targs... args)
 
         // Find an existing shared object or construct one
         sh_object_ = obj_shmem_.template find_or_construct<T>(typeid(T).name())(args...);
+        this->bindTrace();
         node_->set_sink_state(NodeState::SINK_BOUND);
+        node_->telemetry().sink_pid = getpid();
+        offline_readers_ = offlineReaders(address);
+        registerForShutdown(&node_->write_barrier);
+        Registry::instance().bindSink(address, typeid(T).name(), sizeof(T),
+                                      node_->depth());
         bound_ = true;
     }
 }
@@ -218,36 +426,123 @@ inline T *Sink<T>::retrieve()
     return sh_object_;
 }
 
+template <typename T>
+inline void Sink<T>::post()
+{
+    if (channel_ != nullptr && writing_ != nullptr)
+        writing_->value = *sh_object_;
+
+    SinkBase<T>::post();
+}
+
 // 1. SharedFrameHeader
 
 template <>
 class Sink<Frame> : public SinkBase<SharedFrameHeader> {
 
 public:
-    void bind(const std::string &address, const size_t bytes);
-    oat::Frame retrieve(const size_t rows, size_t cols, const int type, const
-            oat::PixelColor color);
+    ~Sink();
+
+    void bind(const std::string &address,
+              const size_t bytes,
+              const size_t depth = 1);
+    oat::Frame * retrieve(const size_t rows,
+                          const size_t cols,
+                          const int type,
+                          const oat::PixelColor color);
+    void wait();
+
+    /**
+     * Change the geometry of the frame being written. Must be called between
+     * wait() and post(). The returned pointer is the same as that returned by
+     * retrieve(), and SOURCEs see the new geometry starting with this write.
+     * The frame must fit within the bytes reserved per frame in bind().
+     *
+     * @return Pointer to the reshaped shared frame
+     */
+    oat::Frame * reshape(const size_t rows,
+                         const size_t cols,
+                         const int type,
+                         const oat::PixelColor color);
+
+    /**
+     * Memory actually backing frame data, which may differ from the
+     * requested OAT_FRAME_PAGES if huge pages were not available.
+     */
+    FramePages pages() const { return pages_; }
+
+private:
+    void selectEntry(const size_t entry);
+    void allocateData(const size_t bytes);
+    void pointAt(const size_t entry);
+    void checkFits(const size_t bytes) const;
+
+    // In-process channel equivalents of retrieve() and pointAt()
+    oat::Frame * openChannel(const size_t rows,
+                             const size_t cols,
+                             const int type,
+                             const oat::PixelColor color);
+    void pointAt(ChannelFrame &f);
+
+    // Frame header pointing to the ring entry that is currently being written
+    oat::Frame frame_;
+    size_t entry_ {0};
+
+    // Start of the ring's data, sample and geometry blocks
+    char * data_ {nullptr};
+    oat::Sample * samples_ {nullptr};
+    FrameParams * geometry_ {nullptr};
+
+    // Bytes requested in bind() and bytes reserved for each ring entry
+    size_t capacity_ {0};
+    size_t entry_bytes_ {0};
+
+    // Frame data backing
+    FramePages pages_ {FramePages::DEFAULT};
+    pages::HugeRegion huge_;
+    std::string huge_path_;
 };
 
-inline void Sink<Frame>::bind(const std::string &address, const size_t bytes)
+inline Sink<Frame>::~Sink()
+{
+    // Mapped SOURCEs keep the pages until they unmap them
+    if (!huge_path_.empty())
+        pages::HugeRegion::remove(huge_path_);
+}
+
+inline void Sink<Frame>::bind(const std::string &address,
+                              const size_t bytes,
+                              const size_t depth)
 {
     if (bound_)
         throw std::runtime_error("A sink can only bind a "
                                  "single time to a single node.");
 
+    // Map the shared clock before the first sample is stamped
+    SharedClock::instance();
+
     // Addresses for this block of shared memory
     address_ = address;
     node_address_ = address + "_node";
     obj_address_ = address + "_obj";
 
-    // Define shared memory
+    // The channel is opened once the frame geometry is known in retrieve()
+    if (bindChannel(address, depth)) {
+        capacity_ = bytes;
+        bound_ = true;
+        return;
+    }
+
+    // Define shared memory. The number of SOURCE slots is fixed by whichever
+    // component creates the node.
+    const size_t num_slots = Node::configuredSlots();
     node_shmem_ = bip::managed_shared_memory(
             bip::open_or_create,
             node_address_.c_str(),
-            1024  + sizeof(Node));
+            Node::shmemBytes(num_slots));
 
     // Facilitates synchronized access to shmem
-    node_ = node_shmem_.find_or_construct<Node>(typeid(Node).name())();
+    node_ = Node::findOrCreate(node_shmem_, num_slots);
 
     // Make sure there is not another SINK using this shmem
     if (node_->sink_state() != NodeState::UNDEFINED) {
@@ -257,44 +552,253 @@ inline void Sink<Frame>::bind(const std::string &address, const size_t bytes)
                 "Requested SINK address, '" + address + "', is not available."));
     } else {
 
+        // Ring entries that the SINK will cycle through. Must be set before
+        // the first write.
+        node_->set_depth(depth);
+
         // Object shared memory
         obj_shmem_ = bip::managed_shared_memory(
             bip::create_only,
             obj_address_.c_str(),
-            1024 + sizeof(SharedFrameHeader) + bytes + sizeof(uint64_t));
+            1024 + sizeof(SharedFrameHeader)
+                 + depth * (bytes + sizeof(oat::Sample) + sizeof(FrameParams)));
 
         // Find an existing shared object or construct one
         sh_object_ = obj_shmem_.find_or_construct<SharedFrameHeader>(typeid(SharedFrameHeader).name())();
 
+        capacity_ = bytes;
+        bindTrace();
+
         node_->set_sink_state(NodeState::SINK_BOUND);
+        node_->telemetry().sink_pid = getpid();
+        offline_readers_ = offlineReaders(address);
+        registerForShutdown(&node_->write_barrier);
+        Registry::instance().bindSink(address, typeid(Frame).name(), bytes,
+                                      depth);
         bound_ = true;
     }
 }
 
-inline oat::Frame Sink<Frame>::retrieve(const size_t rows,
-                                        const size_t cols,
-                                        const int type,
-                                        const oat::PixelColor color)
+inline oat::Frame * Sink<Frame>::retrieve(const size_t rows,
+                                          const size_t cols,
+                                          const int type,
+                                          const oat::PixelColor color)
 {
     // Make sure that the SINK is bound to a shared memory segment
     //assert(bound_);
     if (!bound_)
         throw (std::runtime_error("SINK must be bound before shared frame is retrieved."));
 
-    // Allocate memory for sample number
-    void * sample = obj_shmem_.allocate(sizeof(oat::Sample));
-    handle_t sample_handle = obj_shmem_.get_handle_from_address(sample);
-
-    // Allocate memory for the shared object's data
-    cv::Mat temp(rows, cols, type);
-    void * data = obj_shmem_.allocate(temp.total() * temp.elemSize());
-    handle_t data_handle = obj_shmem_.get_handle_from_address(data);
+    if (channel_ != nullptr)
+        return openChannel(rows, cols, type, color);
+
+    const size_t depth = node_->depth();
+
+    // Allocate memory for one sample per ring entry
+    samples_ = obj_shmem_.construct<oat::Sample>(bip::anonymous_instance)[depth]();
+    handle_t sample_handle = obj_shmem_.get_handle_from_address(samples_);
+
+    // Allocate memory for the shared object's data, one frame per ring
+    // entry. Entries are large enough for any frame up to the size requested
+    // in bind() so that the SINK can reshape frames later.
+    FrameParams p;
+    p.rows = rows;
+    p.cols = cols;
+    p.type = type;
+    p.color = color;
+    p.bytes = rows * cols * CV_ELEM_SIZE(type);
+    entry_bytes_ = capacity_;
+    checkFits(p.bytes);
+    allocateData(depth * entry_bytes_);
+    handle_t data_handle = pages_ == FramePages::HUGETLB
+                         ? 0 : obj_shmem_.get_handle_from_address(data_);
+
+    // Every entry starts out with the same geometry
+    geometry_ = obj_shmem_.construct<FrameParams>(bip::anonymous_instance)[depth](p);
+    handle_t geometry_handle = obj_shmem_.get_handle_from_address(geometry_);
 
     // Reset the SharedFrameHeader's parameters now that we know what they should be
     sh_object_->setParameters(data_handle, sample_handle, rows, cols, type, color);
+    sh_object_->reshape(p);
+    sh_object_->setGeometry(geometry_handle, entry_bytes_);
+    sh_object_->setPages(pages_, huge_path_);
+    Registry::instance().setFrameSize(address_, rows, cols);
+
+    // Point at the entry that will receive the next write
+    entry_ = node_->write_entry();
+    pointAt(entry_);
+
+    // Return pointer to header of memory allocated for shared object. The
+    // header is re-pointed to the correct ring entry on each call to wait().
+    return &frame_;
+}
+
+inline oat::Frame * Sink<Frame>::reshape(const size_t rows,
+                                         const size_t cols,
+                                         const int type,
+                                         const oat::PixelColor color)
+{
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if (geometry_ == nullptr && writing_ == nullptr)
+        throw std::runtime_error("SINK must retrieve a frame before reshaping it.");
+#endif
+
+    FrameParams p;
+    p.rows = rows;
+    p.cols = cols;
+    p.type = type;
+    p.color = color;
+    p.bytes = rows * cols * CV_ELEM_SIZE(type);
+
+    checkFits(p.bytes);
+
+    // Each channel entry carries its own geometry
+    if (channel_ != nullptr) {
+        p.generation = writing_->value.params.generation + 1;
+        writing_->value.params = p;
+        pointAt(writing_->value);
+        return &frame_;
+    }
+
+    p.generation = geometry_[entry_].generation + 1;
+
+    // SOURCEs read the geometry of each entry as they reach it, so entries
+    // written before this one keep the old geometry
+    geometry_[entry_] = p;
+    sh_object_->reshape(p);
+    pointAt(entry_);
+
+    return &frame_;
+}
+
+inline void Sink<Frame>::checkFits(const size_t bytes) const
+{
+    if (bytes > entry_bytes_)
+        throw std::runtime_error("A " + std::to_string(bytes)
+                                 + " byte frame does not fit the "
+                                 + std::to_string(entry_bytes_)
+                                 + " bytes reserved per frame at '" + address_
+                                 + "'. Bind with a larger frame size.");
+}
 
-    // Return pointer to memory allocated for shared object
-    return oat::Frame(rows, cols, type, color, data, sample);
+inline void Sink<Frame>::allocateData(const size_t bytes)
+{
+    pages_ = configuredFramePages();
+
+    if (pages_ == FramePages::HUGETLB) {
+
+        const std::string mount = pages::hugetlbfsMount();
+        const std::string path = mount + "/" + address_ + "_frames";
+        if (!mount.empty() && huge_.create(path, bytes)) {
+            huge_path_ = path;
+            data_ = huge_.data();
+        } else {
+            std::cerr << oat::Warn("Huge pages are not available for '" + address_
+                                   + "'. Falling back to locked shared memory.\n");
+            pages_ = FramePages::LOCKED;
+        }
+    }
+
+    if (pages_ != FramePages::HUGETLB)
+        data_ = static_cast<char *>(obj_shmem_.allocate(bytes));
+
+    // Pay for page faults here instead of during the first writes and reads
+    if (pages_ == FramePages::LOCKED)
+        pages::prefault(data_, bytes, true);
+
+    if (pages_ != FramePages::DEFAULT && !pages::lock(data_, bytes))
+        std::cerr << oat::Warn("Could not lock frames for '" + address_
+                               + "' into RAM. Raise the memlock limit.\n");
+}
+
+inline oat::Frame * Sink<Frame>::openChannel(const size_t rows,
+                                             const size_t cols,
+                                             const int type,
+                                             const oat::PixelColor color)
+{
+    FrameParams p;
+    p.rows = rows;
+    p.cols = cols;
+    p.type = type;
+    p.color = color;
+    p.bytes = rows * cols * CV_ELEM_SIZE(type);
+    entry_bytes_ = capacity_;
+    checkFits(p.bytes);
+
+    // Entries are process memory, so huge pages are not used. Locking only
+    // needs to happen once per entry since entries are reused.
+    pages_ = configuredFramePages() == FramePages::DEFAULT
+           ? FramePages::DEFAULT : FramePages::LOCKED;
+
+    auto make = [this] {
+        auto e = makeEntry(entry_bytes_);
+        if (pages_ == FramePages::LOCKED) {
+            pages::prefault(e->value.data.get(), entry_bytes_, true);
+            if (!pages::lock(e->value.data.get(), entry_bytes_))
+                std::cerr << oat::Warn("Could not lock frames for '" + address_
+                                       + "' into RAM. Raise the memlock limit.\n");
+        }
+        return e;
+    };
+
+    // The prototype is written until the first wait() and lets SOURCEs see
+    // the geometry as soon as they connect
+    writing_ = make();
+    writing_->value.params = p;
+    channel_->open(writing_, make);
+    pointAt(writing_->value);
+
+    return &frame_;
+}
+
+inline void Sink<Frame>::pointAt(ChannelFrame &f)
+{
+    const FrameParams &p = f.params;
+    frame_ = oat::Frame(p.rows, p.cols, p.type, p.color,
+                        f.data.get(), &f.sample);
+}
+
+inline void Sink<Frame>::wait()
+{
+    if (channel_ != nullptr) {
+
+        // Carry the sample and geometry forward, as for ring entries
+        auto previous = writing_;
+        SinkBase<SharedFrameHeader>::wait();
+        if (previous != nullptr && writing_ != previous) {
+            writing_->value.sample = previous->value.sample;
+            writing_->value.params = previous->value.params;
+            pointAt(writing_->value);
+        }
+        return;
+    }
+
+    SinkBase<SharedFrameHeader>::wait();
+
+    if (data_ != nullptr)
+        selectEntry(node_->write_entry());
+}
+
+inline void Sink<Frame>::selectEntry(const size_t entry)
+{
+    if (entry == entry_)
+        return;
+
+    // Carry the sample and geometry forward so that counts and rates
+    // continue across entries
+    samples_[entry] = samples_[entry_];
+    geometry_[entry] = geometry_[entry_];
+
+    pointAt(entry);
+    entry_ = entry;
+}
+
+inline void Sink<Frame>::pointAt(const size_t entry)
+{
+    const FrameParams &p = geometry_[entry];
+    frame_ = oat::Frame(p.rows, p.cols, p.type, p.color,
+                        data_ + entry * entry_bytes_, samples_ + entry);
 }
 
 } // namespace oat
@@ -20,8 +20,10 @@
 #ifndef OAT_SOURCE_H
 #define	OAT_SOURCE_H
 
+#include "Channel.h"
 #include "ForwardsDecl.h"
 #include "Node.h"
+#include "Registry.h"
 #include "SharedFrameHeader.h"
 
 #include <exception>
@@ -31,11 +33,14 @@
 #include <string>
 #include <thread>
 
+#include <unistd.h>
+
 #include <boost/interprocess/managed_shared_memory.hpp>
-#include <boost/thread/thread_time.hpp>
 
 #include "../datatypes/Frame.h"
+#include "../datatypes/Trace.h"
 #include "../base/Globals.h"
+#include "../utility/IOFormat.h"
 
 namespace oat {
 
@@ -49,6 +54,19 @@ enum class SourceState : std::int16_t
     CONNECTED       = 2,
 };
 
+/**
+ * How a SOURCE participates in its node's synchronization, i.e. its
+ * backpressure policy. Only SYNCHRONOUS sources can hold back the SINK. The
+ * others skip writes when they fall behind, and count them in dropped() and
+ * in the node's telemetry; gaps also show up in Sample::count().
+ */
+enum class SourceMode : std::int16_t
+{
+    SYNCHRONOUS     = 0, //!< Block: reads every write. The SINK waits on this SOURCE's post().
+    LOSSY           = 1, //!< Drop oldest: reads the latest write, which may have been made while busy.
+    DROP_NEWEST     = 2, //!< Drop newest: writes made while busy are dropped. Reads the next write after post().
+};
+
 template <typename T>
 class SourceBase {
 public:
@@ -56,29 +74,111 @@ public:
     virtual ~SourceBase();
 
     // Node connection
-    void touch(const std::string &address);
+    void touch(const std::string &address,
+               const SourceMode mode = SourceMode::SYNCHRONOUS);
     virtual SourceState connect(void);
 
     // Sychronization
     NodeState wait();
     void post();
 
+    /**
+     * Non-blocking wait(). If wait() would return without blocking, it
+     * completes it and sets state to the value wait() would have returned.
+     * Used by SourceSet to wait on several nodes at once.
+     * @param state Node state, set if the wait completed.
+     * @param since_ns Time at which the caller started waiting.
+     * @return True if the wait completed and post() is now required.
+     */
+    bool try_wait(NodeState &state, const uint64_t since_ns);
+
+    /**
+     * Queue notified whenever the result of try_wait() may have changed.
+     */
+    WaitQueue & wait_queue()
+    {
+        if (channel_ != nullptr)
+            return channel_->written();
+
+        return lossy() ? node_->write_queue
+                       : node_->read_barrier(slot_index_).queue();
+    }
+
     uint64_t write_number() const
     {
+        if (channel_ != nullptr)
+            return channel_->write_number();
+
         return (node_ == nullptr ? 0 : node_->write_number());
     }
 
+    /**
+     * Number of writes this SOURCE has skipped between reads. Always 0 for
+     * SYNCHRONOUS sources.
+     */
+    uint64_t dropped() const { return dropped_; }
+
+    /**
+     * Copy the latency trace of the sample being read. Must be called between
+     * wait() and post(). LOSSY sources get the trace of the latest write,
+     * which may be newer than the sample they copied.
+     * @param trace Set to the sample's trace.
+     * @return False, leaving trace untouched, unless both this component and
+     * the SINK are tracing.
+     */
+    bool trace(Trace &trace) const;
+
 protected:
 
+    bool lossy() const { return mode_ != SourceMode::SYNCHRONOUS; }
+
+    bool waitForSink();
+
+    // Map the node's trace block, if this component is tracing and the SINK
+    // created one
+    void connectTrace();
+
+    // Whether wait() may return. Consumes the SINK's post to a SYNCHRONOUS
+    // slot.
+    bool readable();
+
+    // Bookkeeping once wait() may return
+    NodeState completeWait(const uint64_t since_ns);
+
+    template <typename Copy>
+    void readLatest(Copy copy) const;
+
+    // Channel equivalents of readable() and completeWait()
+    bool channelReadable() const;
+    NodeState completeChannelWait(const uint64_t since_ns);
+
     shmem_t node_shmem_, obj_shmem_;
     T * sh_object_ {nullptr};
     Node * node_ {nullptr};
     std::string address_, node_address_, obj_address_;
     size_t slot_index_ {0};
+    SourceMode mode_ {SourceMode::SYNCHRONOUS};
+    uint64_t latest_ {0}; //!< Write number seen by the last LOSSY wait()
+    uint64_t lossy_read_ {0}; //!< The next LOSSY wait() returns after this write number
+    uint64_t last_read_ {0}; //!< Write number read before the last LOSSY post()
+    uint64_t dropped_ {0}; //!< Writes skipped between LOSSY reads
     std::atomic<SourceState> state_ {SourceState::VIRGIN};
     bool touched_ {false};
     bool connected_ {false};
     bool did_wait_need_post_ {false};
+
+    // One trace per ring entry, only mapped when tracing
+    shmem_t trace_shmem_;
+    const Trace * traces_ {nullptr};
+
+    // In-process channel and the entry being read, used instead of the node
+    // when both ends of the stream are stages of oat run. The entry is held
+    // until the next wait() so that it cannot be reused while it is read.
+    using Payload = typename ChannelPayload<T>::type;
+    std::shared_ptr<Channel<Payload>> channel_;
+    std::shared_ptr<typename Channel<Payload>::Reader> reader_;
+    typename Channel<Payload>::Entry reading_;
+    bool tracing_ {false};
 };
 
 template <typename T>
@@ -90,14 +190,29 @@ inline SourceBase<T>::SourceBase()
 template <typename T>
 inline SourceBase<T>::~SourceBase()
 {
+    if (reader_ != nullptr) {
+        channel_->detach(reader_);
+        return;
+    }
+
     // If we have touched the node, or there was a node type mismatch, we must
     // release our slot
-    if (state_ >= SourceState::TOUCHED || state_ == SourceState::ERR_TYPEMIS)
-        node_->releaseSlot(slot_index_);
+    if (state_ >= SourceState::TOUCHED || state_ == SourceState::ERR_TYPEMIS) {
+        if (lossy()) {
+            unregisterForShutdown(&node_->write_queue);
+            node_->releaseLossy();
+        } else {
+            unregisterForShutdown(&node_->read_barrier(slot_index_));
+            node_->releaseSlot(slot_index_);
+        }
+
+        Registry::instance().detachSource(address_);
+    }
 
     // If the client reference count is 0 and there is no server
     // attached to the node, deallocate the shmem
     if ( (node_ != nullptr && node_-> source_ref_count() == 0) &&
+        node_->lossy_ref_count() == 0 &&
         node_->sink_state() != NodeState::SINK_BOUND) {
 
         bool shmem_freed = false;
@@ -112,36 +227,77 @@ inline SourceBase<T>::~SourceBase()
 }
 
 template <typename T>
-inline void SourceBase<T>::touch(const std::string &address)
+inline void SourceBase<T>::touch(const std::string &address,
+                                 const SourceMode mode)
 {
     // Make sure we did not connect already
     if (state_ != SourceState::VIRGIN)
         throw std::runtime_error("A source can only connect a "
                                  "single time to a single node.");
 
+    // Map the shared clock before the first sample is stamped
+    SharedClock::instance();
+
     // Addresses for this block of shared memory
     address_ = address;
     node_address_ = address + "_node";
     obj_address_ = address + "_obj";
 
-    // Define shared memory
-    // Extra 1024 bytes are used to hold managed shared mem helper objects
-    // (name-object index, internal synchronization objects, internal
-    // variables...)
+    mode_ = mode;
+
+    // Offline, every sample must reach every reader
+    if (lossy() && offline()) {
+        std::cerr << oat::Warn("OAT_OFFLINE is set, so the lossy SOURCE for '"
+                               + address_ + "' will read every sample.\n");
+        mode_ = SourceMode::SYNCHRONOUS;
+    }
+
+    if (Channels::instance().enabled(address)) {
+        channel_ = Channels::instance().find<Payload>(address);
+        reader_ = channel_->attach(!lossy());
+        state_ = SourceState::TOUCHED;
+        return;
+    }
+
+    // Define shared memory. The number of SOURCE slots is fixed by whichever
+    // component creates the node.
+    const size_t num_slots = Node::configuredSlots();
     node_shmem_ = bip::managed_shared_memory(
             bip::open_or_create,
             node_address_.c_str(),
-            1024 + sizeof(Node));
+            Node::shmemBytes(num_slots));
 
     // Facilitates synchronized access to shmem
-    node_ = node_shmem_.find_or_construct<Node>(typeid(Node).name())();
+    node_ = Node::findOrCreate(node_shmem_, num_slots);
 
-    // Let the node know this source is attached and retrieve *this's index
-    if (node_->acquireSlot(slot_index_) < 0) {
-        state_ = SourceState::ERR_NODEFULL;
-        return;
+    if (lossy()) {
+
+        // Lossy sources do not take part in the node's read barrier
+        node_->acquireLossy();
+
+        // Make sure SIGINT can wake us if we block on this node
+        registerForShutdown(&node_->write_queue);
+
+    } else {
+
+        // Let the node know this source is attached and retrieve *this's index
+        if (node_->acquireSlot(slot_index_) < 0) {
+            state_ = SourceState::ERR_NODEFULL;
+            return;
+        }
+
+        // Make sure SIGINT can wake us if we block on this node
+        registerForShutdown(&node_->read_barrier(slot_index_));
+
+        auto &stats = node_->slot_telemetry(slot_index_);
+        stats.pid = getpid();
+        stats.reads = 0;
+        stats.read_latency_ns = 0;
+        stats.wait_ns = 0;
     }
 
+    Registry::instance().attachSource(address_);
+
     // We have touched the node and must sychronize with its sink
     state_ = SourceState::TOUCHED;
 }
@@ -155,17 +311,15 @@ inline SourceState SourceBase<T>::connect()
                                  "touch()ed a node.");
 
     // Wait for the SINK to bind and construct the shared object
-    if (node_->sink_state() != NodeState::SINK_BOUND) {
-
-        if (wait() != NodeState::SINK_BOUND)
-            return SourceState::ERR_CONNECT; // No throw because this can occur
-                                             // at quit
-
-        // Self post since all loops start with wait() and we just
-        // finished our wait(). This will make the first call to
-        // wait() a 'freebie'
-        node_->read_barrier(slot_index_).post();
-        did_wait_need_post_ = false;
+    if (!waitForSink())
+        return SourceState::ERR_CONNECT; // No throw because this can occur
+                                         // at quit
+
+    // Entries are found on each wait() rather than mapped here
+    if (channel_ != nullptr) {
+        connectTrace();
+        state_ = SourceState::CONNECTED;
+        return SourceState::CONNECTED;
     }
 
     // Find an existing shared object constructed by the SINK
@@ -180,10 +334,55 @@ inline SourceState SourceBase<T>::connect()
         throw std::runtime_error("Type mismatch: Source<T> can only connect to Node<T>.");
     }
 
+    connectTrace();
+
     state_ = SourceState::CONNECTED;
     return SourceState::CONNECTED;
 }
 
+template <typename T>
+inline void SourceBase<T>::connectTrace()
+{
+    if (!Trace::enabled())
+        return;
+
+    // Channel entries carry their trace when the SINK is tracing
+    if (channel_ != nullptr) {
+        tracing_ = true;
+        return;
+    }
+
+    try {
+        trace_shmem_ = bip::managed_shared_memory(
+                bip::open_only, (address_ + "_trace").c_str());
+        traces_ = trace_shmem_.find<Trace>(typeid(Trace).name()).first;
+    } catch (const bip::interprocess_exception &) {
+        // The SINK is not tracing
+    }
+}
+
+template <typename T>
+inline bool SourceBase<T>::trace(Trace &trace) const
+{
+    if (channel_ != nullptr) {
+        if (!tracing_ || reading_ == nullptr || reading_->trace == nullptr)
+            return false;
+
+        trace = *reading_->trace;
+        return true;
+    }
+
+    if (traces_ == nullptr)
+        return false;
+
+    if (lossy())
+        readLatest([this, &trace](size_t entry) { trace = traces_[entry]; });
+    else
+        trace = traces_[node_->read_entry(slot_index_)];
+
+    return true;
+}
+
 template <typename T>
 inline NodeState SourceBase<T>::wait()
 {
@@ -195,20 +394,84 @@ inline NodeState SourceBase<T>::wait()
         throw std::runtime_error("wait() called when post() was required.");
 #endif
 
-    boost::system_time timeout = boost::get_system_time() + msec_t(10);
+    const uint64_t t0 = telemetry::now();
+
+    // Wait for the SINK to write. If the sink has left the room or we are
+    // told to quit, we should leave too.
+    wait_queue().wait([this] { return readable(); });
+
+    return completeWait(t0);
+}
+
+template <typename T>
+inline bool SourceBase<T>::try_wait(NodeState &state, const uint64_t since_ns)
+{
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if(state_ < SourceState::TOUCHED)
+        throw std::runtime_error("Source must have touched node before calling try_wait()");
+    if (did_wait_need_post_)
+        throw std::runtime_error("try_wait() called when post() was required.");
+#endif
+
+    if (!readable())
+        return false;
+
+    state = completeWait(since_ns);
+    return true;
+}
+
+template <typename T>
+inline bool SourceBase<T>::readable()
+{
+    if (channel_ != nullptr)
+        return channelReadable();
+
+    if (lossy()) {
+
+        // Wait for a write that we have not seen yet
+        return node_->write_number() > lossy_read_ || quit
+               || node_->sink_state() == NodeState::END;
+    }
+
+    // Posts that arrive before the SINK has admitted us were meant for our
+    // slot's previous owner
+    while (node_->read_barrier(slot_index_).try_wait()) {
+        if (node_->admitted(slot_index_))
+            return true;
+    }
+
+    return quit || node_->sink_state() == NodeState::END;
+}
+
+template <typename T>
+inline NodeState SourceBase<T>::completeWait(const uint64_t since_ns)
+{
+    if (channel_ != nullptr)
+        return completeChannelWait(since_ns);
+
+    ProcessStats *stats = telemetry::thread_stats();
 
-    // Only wait if there is a SOURCE attached to the node
-    // Wait with timed wait with period check to prevent deadlocks
-    while (!node_->read_barrier(slot_index_).timed_wait(timeout) && !quit) {
+    if (lossy()) {
 
-        // Loops checking if wait has been released
-        timeout = boost::get_system_time() + msec_t(10);
+        latest_ = node_->write_number();
 
-        // If the sink has left the room, we should too
-        if (node_->sink_state() == NodeState::END)
-            break;
+        // Writes that landed between our reads were never seen
+        if (last_read_ > 0 && latest_ > last_read_ + 1) {
+            const uint64_t gap = latest_ - last_read_ - 1;
+            dropped_ += gap;
+            node_->telemetry().skipped.fetch_add(gap, std::memory_order_relaxed);
+            if (stats != nullptr)
+                telemetry::add(stats->drops, gap);
+        }
     }
 
+    const uint64_t waited = telemetry::now() - since_ns;
+    if (mode_ == SourceMode::SYNCHRONOUS)
+        telemetry::add(node_->slot_telemetry(slot_index_).wait_ns, waited);
+    if (stats != nullptr)
+        stats->source_wait.record(waited);
+
     did_wait_need_post_ = true;
 
     return node_->sink_state();
@@ -225,12 +488,143 @@ inline void SourceBase<T>::post()
         throw std::runtime_error("post() called when wait() was required.");
 #endif
 
-    if (node_->notifySourceReadComplete(slot_index_))
-        node_->write_barrier.post();
+    if (lossy()) {
+
+        // Dropping newest means ignoring whatever arrived while we were busy
+        last_read_ = latest_;
+        lossy_read_ = mode_ == SourceMode::DROP_NEWEST ? write_number()
+                                                       : latest_;
+    } else if (channel_ != nullptr) {
+
+        // Our entry stays in reading_ until the next wait()
+        if (reading_ != nullptr)
+            reader_->queue.pop();
+        channel_->notifyRead();
+
+    } else {
+
+        auto &stats = node_->slot_telemetry(slot_index_);
+        const uint64_t written =
+            node_->telemetry().entry_write_ns[node_->read_entry(slot_index_)];
+        if (written > 0)
+            telemetry::add(stats.read_latency_ns, telemetry::now() - written);
+        telemetry::add(stats.reads, 1);
+        node_->beat(slot_index_);
+
+        if (node_->notifySourceReadComplete(slot_index_))
+            node_->write_barrier.post();
+    }
 
     did_wait_need_post_ = false;
 }
 
+template <typename T>
+inline bool SourceBase<T>::channelReadable() const
+{
+    if (quit || channel_->state() == NodeState::END)
+        return true;
+
+    if (lossy())
+        return channel_->write_number() > lossy_read_;
+
+    return reader_->queue.read_available() > 0;
+}
+
+template <typename T>
+inline NodeState SourceBase<T>::completeChannelWait(const uint64_t since_ns)
+{
+    ProcessStats *stats = telemetry::thread_stats();
+
+    // Entries that were written before the SINK left are still delivered
+    reading_.reset();
+    if (lossy()) {
+
+        if (channel_->write_number() > lossy_read_) {
+            reading_ = channel_->latest();
+            latest_ = reading_->number;
+
+            // Writes that landed between our reads were never seen
+            if (last_read_ > 0 && latest_ > last_read_ + 1) {
+                const uint64_t gap = latest_ - last_read_ - 1;
+                dropped_ += gap;
+                if (stats != nullptr)
+                    telemetry::add(stats->drops, gap);
+            }
+        }
+
+    } else if (reader_->queue.read_available() > 0) {
+        reading_ = reader_->queue.front();
+    }
+
+    if (stats != nullptr)
+        stats->source_wait.record(telemetry::now() - since_ns);
+
+    did_wait_need_post_ = true;
+
+    return reading_ != nullptr ? NodeState::SINK_BOUND : NodeState::END;
+}
+
+template <typename T>
+inline bool SourceBase<T>::waitForSink()
+{
+    if (channel_ != nullptr)
+        return channel_->waitOpen();
+
+    // SYNCHRONOUS sources need the SINK to be bound. LOSSY sources need at
+    // least one complete write since there is no barrier protecting the
+    // shared object before then.
+    if (lossy() && node_->write_number() > 0)
+        return true;
+    else if (mode_ == SourceMode::SYNCHRONOUS
+             && node_->sink_state() == NodeState::SINK_BOUND)
+        return true;
+
+    if (wait() != NodeState::SINK_BOUND)
+        return false;
+
+    // Self post since all loops start with wait() and we just finished our
+    // wait(). This will make the first call to wait() a 'freebie'. LOSSY
+    // sources get this for free because they have not posted yet.
+    if (mode_ == SourceMode::SYNCHRONOUS)
+        node_->read_barrier(slot_index_).post();
+    did_wait_need_post_ = false;
+
+    return true;
+}
+
+template <typename T>
+template <typename Copy>
+inline void SourceBase<T>::readLatest(Copy copy) const
+{
+    while (node_->write_number() > 0) {
+
+        const size_t entry = (node_->write_number() - 1) % node_->depth();
+        const uint64_t seq = node_->entry_seq(entry);
+
+        // The SINK has lapped us and is writing to this entry. Wait for it
+        // to finish.
+        if (seq & 1) {
+            node_->write_queue.wait([this, entry, seq] {
+                return node_->entry_seq(entry) != seq || quit
+                       || node_->sink_state() == NodeState::END;
+            });
+
+            if (node_->entry_seq(entry) == seq)
+                return;
+
+            continue;
+        }
+
+        copy(entry);
+
+        // If the entry changed while we were copying it, the read is torn and
+        // must be retried
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (node_->entry_seq(entry) == seq)
+            return;
+    }
+}
+
 /* SPECIALIZATIONS */
 
 // 0. General Case
@@ -241,8 +635,14 @@ class Source : public SourceBase<T> {
     using SourceBase<T>::sh_object_;
     using SourceBase<T>::connected_;
     using SourceBase<T>::state_;
+    using SourceBase<T>::mode_;
+    using SourceBase<T>::lossy;
+    using SourceBase<T>::reading_;
+    using SourceBase<T>::channel_;
 
 public:
+    // NOTE: retrieve() provides unsynchronized access for LOSSY sources. Use
+    // clone() instead.
     T *retrieve() const;
     T clone() const;
 };
@@ -256,6 +656,12 @@ inline T *Source<T>::retrieve() const
         throw (std::runtime_error("Source must be connected before shared object is retrieved."));
 #endif
 
+    // Until the first read, the SINK's prototype stands in for the shared
+    // object
+    if (channel_ != nullptr)
+        return reading_ != nullptr ? &reading_->value
+                                   : &channel_->prototype()->value;
+
     return sh_object_;
 }
 
@@ -268,13 +674,30 @@ inline T Source<T>::clone() const
         throw (std::runtime_error("Source must be connected before shared object is cloned."));
 #endif
 
+    // Channel entries are held while they are read, so they cannot be torn
+    if (reading_ != nullptr)
+        return reading_->value;
+
+    if (lossy()) {
+
+        // The first copy might be torn. It is replaced under the seqlock.
+        T latest = *sh_object_;
+        this->readLatest([this, &latest](size_t) { latest = *sh_object_; });
+        return latest;
+    }
+
     return *sh_object_;
 }
 
 // 1. SharedFrameHeader
 
+class FrameLease;
+
 template <>
 class Source<Frame> : public SourceBase<SharedFrameHeader> {
+
+    friend FrameLease;
+
 public:
 
     using FrameParams = oat::FrameParams;
@@ -284,17 +707,134 @@ public:
     // copy it out of there.
     SourceState connect() override;
     SourceState connect(const oat::PixelColor col);
+    NodeState wait();
+    bool try_wait(NodeState &state, const uint64_t since_ns);
 
+    // NOTE: retrieve() provides unsynchronized access for LOSSY sources. Use
+    // clone() or copyTo() instead.
     const oat::Frame * retrieve() const { return &frame_; }
-    oat::Frame clone() const { return frame_.clone(); }
-    void copyTo(oat::Frame &frame) const { frame_.copyTo(frame); };
+    oat::Frame clone() const;
+    void copyTo(oat::Frame &frame) const;
+
+    /**
+     * Geometry of the current frame. The SINK can reshape its frames, which
+     * increments the generation. retrieve() and leases always point at a
+     * frame with the current geometry, but components that size their own
+     * buffers should compare generations after each wait().
+     */
     FrameParams parameters() const { return parameters_; }
 
+    /**
+     * Bytes reserved for each frame by the SINK. Reshaped frames are never
+     * larger than this.
+     */
+    size_t capacity() const { return entry_bytes_; }
+
+    /**
+     * Wait for the SINK and lease the frame it wrote. The lease is a
+     * read-only view that points directly into shared memory, or into the
+     * channel entry, and calls post() when it is destroyed. This replaces the wait(), copyTo(),
+     * post() sequence when the frame only needs to be read.
+     */
+    FrameLease lease();
+
 private :
 
-    // Shared frame
+    size_t currentEntry() const;
+    oat::Frame entryFrame(const size_t entry) const;
+    void selectEntry(const size_t entry);
+
+    // Point at the channel entry being read, or at the SINK's prototype
+    // before the first read
+    void selectChannelEntry();
+
+    // Frame viewed by a lease
+    const oat::Frame * leased() const;
+
+    // Shared frame, pointing to the ring entry that is currently being read
     oat::Frame frame_;
     FrameParams parameters_;
+    size_t entry_ {0};
+
+    // Start of the ring's data, sample and geometry blocks
+    char * data_ {nullptr};
+    oat::Sample * samples_ {nullptr};
+    const FrameParams * geometry_ {nullptr};
+    size_t entry_bytes_ {0};
+
+    // Frame data when the SINK placed it on hugetlbfs
+    pages::HugeRegion huge_;
+
+    // LOSSY sources do not hold back the SINK, so their leases are backed by
+    // a private copy of the latest frame
+    oat::Frame lossy_frame_;
+};
+
+/**
+ * Read-only view of the frame that a Source<Frame> most recently waited on.
+ * The SOURCE is posted when the lease is destroyed or released, after which
+ * the view must not be used. Only one lease per SOURCE can be held at a
+ * time.
+ */
+class FrameLease {
+public:
+
+    FrameLease(FrameLease &&other)
+    : source_(other.source_)
+    , state_(other.state_)
+    {
+        other.source_ = nullptr;
+    }
+
+    // Leases are not copyable
+    FrameLease(const FrameLease &) = delete;
+    FrameLease & operator=(const FrameLease &) = delete;
+
+    ~FrameLease() { release(); }
+
+    /**
+     * Node state returned by the SOURCE's wait(). If this is NodeState::END,
+     * the view is not valid and the SOURCE is not posted.
+     */
+    NodeState state() const { return state_; }
+
+    const oat::Frame & operator*() const { return *frame(); }
+    const oat::Frame * operator->() const { return frame(); }
+
+    /**
+     * Post the SOURCE before the lease goes out of scope.
+     */
+    void release()
+    {
+        if (source_ != nullptr && state_ != NodeState::END)
+            source_->post();
+
+        source_ = nullptr;
+    }
+
+private:
+
+    friend Source<Frame>;
+
+    FrameLease(Source<Frame> *source, const NodeState state)
+    : source_(source)
+    , state_(state)
+    {
+        // Nothing
+    }
+
+    const oat::Frame * frame() const
+    {
+#ifndef NDEBUG
+        // Don't use Asserts because it does not clean shmem
+        if (source_ == nullptr)
+            throw std::runtime_error("Frame lease used after it was released.");
+#endif
+        return source_->leased();
+    }
+
+    Source<Frame> *source_;
+    NodeState state_;
 };
 
 inline SourceState Source<Frame>::connect(const oat::PixelColor color)
@@ -321,17 +861,16 @@ inline SourceState Source<Frame>::connect()
 
     // Wait for the SINK to bind the node and provide matrix
     // header info.
-    if (node_->sink_state() != NodeState::SINK_BOUND) {
-
-        if (wait() != NodeState::SINK_BOUND)
-            return SourceState::ERR_CONNECT; // No throw because this can occur
-                                             // at quit
-
-        // Self post since all loops start with wait() and we just
-        // finished our wait(). This will make the first call to
-        // wait() a 'freebie'
-        node_->read_barrier(slot_index_).post();
-        did_wait_need_post_ = false;
+    if (!waitForSink())
+        return SourceState::ERR_CONNECT; // No throw because this can occur
+                                         // at quit
+
+    if (channel_ != nullptr) {
+        entry_bytes_ = channel_->prototype()->value.bytes;
+        selectChannelEntry();
+        connectTrace();
+        state_ = SourceState::CONNECTED;
+        return SourceState::CONNECTED;
     }
 
     // Find an existing shared object constructed by the SINK
@@ -347,25 +886,151 @@ inline SourceState Source<Frame>::connect()
         throw std::runtime_error("Type mismatch: Source<T> can only connect to Node<T>.");
     }
 
-    // Generate frame header using info in shmem segment
-    auto p = sh_object_->params();
-    frame_ = oat::Frame(p.rows,
-                        p.cols,
-                        p.type,
-                        p.color,
-                        obj_shmem_.get_address_from_handle(sh_object_->data()),
-                        obj_shmem_.get_address_from_handle(sh_object_->sample()));
-
-    // Save parameters to construct cv::Mats with
-    parameters_.cols = p.cols;
-    parameters_.rows = p.rows;
-    parameters_.type = p.type;
-    parameters_.color = p.color;
-    parameters_.bytes = frame_.total() * frame_.elemSize();
+    // Map the ring's frame data. Page tables are per-process, so locked and
+    // huge pages are faulted in again here rather than on the first read.
+    entry_bytes_ = sh_object_->capacity();
+    const size_t data_bytes = node_->depth() * entry_bytes_;
+    if (sh_object_->pages() == FramePages::HUGETLB) {
+        huge_.open(sh_object_->pages_path(), data_bytes);
+        data_ = huge_.data();
+    } else {
+        data_ = static_cast<char *>(
+            obj_shmem_.get_address_from_handle(sh_object_->data()));
+    }
+
+    if (sh_object_->pages() == FramePages::LOCKED)
+        pages::prefault(data_, data_bytes, false);
+
+    // Best effort; the SINK has already warned if locking is not permitted
+    if (sh_object_->pages() != FramePages::DEFAULT)
+        pages::lock(data_, data_bytes);
+
+    // Generate frame header using the geometry of the current entry
+    samples_ = static_cast<oat::Sample *>(
+        obj_shmem_.get_address_from_handle(sh_object_->sample()));
+    geometry_ = static_cast<const FrameParams *>(
+        obj_shmem_.get_address_from_handle(sh_object_->geometry()));
+    entry_ = currentEntry();
+    parameters_ = geometry_[entry_];
+    frame_ = entryFrame(entry_);
+
+    connectTrace();
 
     state_ = SourceState::CONNECTED;
     return SourceState::CONNECTED;
 }
 
+inline NodeState Source<Frame>::wait()
+{
+    auto rc = SourceBase<SharedFrameHeader>::wait();
+
+    // Follow this source's read cursor around the SINK's ring
+    if (state_ == SourceState::CONNECTED) {
+        if (channel_ != nullptr)
+            selectChannelEntry();
+        else
+            selectEntry(currentEntry());
+    }
+
+    return rc;
+}
+
+inline bool Source<Frame>::try_wait(NodeState &state, const uint64_t since_ns)
+{
+    if (!SourceBase<SharedFrameHeader>::try_wait(state, since_ns))
+        return false;
+
+    if (state_ == SourceState::CONNECTED) {
+        if (channel_ != nullptr)
+            selectChannelEntry();
+        else
+            selectEntry(currentEntry());
+    }
+
+    return true;
+}
+
+inline oat::Frame Source<Frame>::clone() const
+{
+    if (!lossy() || channel_ != nullptr)
+        return frame_.clone();
+
+    oat::Frame frame(cv::Mat(parameters_.rows, parameters_.cols, parameters_.type));
+    copyTo(frame);
+    return frame;
+}
+
+inline void Source<Frame>::copyTo(oat::Frame &frame) const
+{
+    if (!lossy() || channel_ != nullptr) {
+        frame_.copyTo(frame);
+        return;
+    }
+
+    readLatest([this, &frame](size_t entry) { entryFrame(entry).copyTo(frame); });
+}
+
+inline FrameLease Source<Frame>::lease()
+{
+    auto rc = wait();
+
+    if (rc != NodeState::END && lossy() && channel_ == nullptr)
+        copyTo(lossy_frame_);
+
+    return FrameLease(this, rc);
+}
+
+inline const oat::Frame * Source<Frame>::leased() const
+{
+    // Channel entries are held until the next wait(), so LOSSY leases can
+    // point straight at them
+    return lossy() && channel_ == nullptr ? &lossy_frame_ : &frame_;
+}
+
+inline void Source<Frame>::selectChannelEntry()
+{
+    auto &f = reading_ != nullptr ? reading_->value
+                                  : channel_->prototype()->value;
+
+    parameters_ = f.params;
+    frame_ = oat::Frame(f.params.rows, f.params.cols, f.params.type,
+                        f.params.color, f.data.get(), &f.sample);
+}
+
+inline size_t Source<Frame>::currentEntry() const
+{
+    // LOSSY sources look at the most recent write
+    if (lossy())
+        return latest_ > 0 ? (latest_ - 1) % node_->depth() : 0;
+
+    return node_->read_entry(slot_index_);
+}
+
+inline oat::Frame Source<Frame>::entryFrame(const size_t entry) const
+{
+    // LOSSY reads can race a reshape. The read is retried, but the geometry
+    // it saw must not take it past the end of the entry.
+    const FrameParams p = geometry_[entry];
+    const bool fits = p.rows * p.cols * CV_ELEM_SIZE(p.type) <= entry_bytes_;
+
+    return oat::Frame(fits ? p.rows : 0,
+                      fits ? p.cols : 0,
+                      p.type,
+                      p.color,
+                      data_ + entry * entry_bytes_,
+                      samples_ + entry);
+}
+
+inline void Source<Frame>::selectEntry(const size_t entry)
+{
+    // The SINK may have reshaped the frame since we last read this entry
+    if (entry == entry_ && geometry_[entry].generation == parameters_.generation)
+        return;
+
+    parameters_ = geometry_[entry];
+    frame_ = entryFrame(entry);
+    entry_ = entry;
+}
+
 }      /* namespace oat */
 #endif /* OAT_SOURCE_H */
@@ -0,0 +1,152 @@
+//******************************************************************************
+//* File:   SourceSet.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SOURCESET_H
+#define	OAT_SOURCESET_H
+
+#include "Source.h"
+
+#include <memory>
+#include <vector>
+
+namespace oat {
+
+/**
+ * Waits on the nodes of several SOURCEs at once, so that a component with
+ * many inputs can handle each one as soon as it is written instead of in a
+ * fixed order.
+ *
+ * Reads happen in rounds. Within a round, each SOURCE is returned by wait()
+ * exactly once, after which the caller must read it and post() it. The
+ * round ends when every SOURCE has been returned and the next call to wait()
+ * starts a new one:
+ *
+ *     do {
+ *         if (set.wait() == NodeState::END)
+ *             return 1;
+ *         for (auto i : set.ready()) {
+ *             // Read source i
+ *             sources[i].post();
+ *         }
+ *     } while (set.pending() > 0);
+ *
+ * The SOURCEs must outlive the set and must be connected before the first
+ * wait().
+ */
+class SourceSet {
+
+    // Type erased SOURCE
+    struct Concept {
+        virtual ~Concept() { }
+        virtual bool try_wait(NodeState &state, const uint64_t since_ns) = 0;
+        virtual WaitQueue & wait_queue() = 0;
+    };
+
+    template <typename S>
+    struct Model : Concept {
+        explicit Model(S &s) : source(s) { }
+        bool try_wait(NodeState &state, const uint64_t since_ns) override
+        {
+            return source.try_wait(state, since_ns);
+        }
+        WaitQueue & wait_queue() override { return source.wait_queue(); }
+        S &source;
+    };
+
+public:
+
+    /**
+     * @brief Add a SOURCE to the set.
+     * @return Index of the SOURCE in ready().
+     */
+    template <typename S>
+    size_t add(S &source)
+    {
+        members_.emplace_back(new Model<S>(source));
+        return members_.size() - 1;
+    }
+
+    size_t size() const { return members_.size(); }
+
+    /**
+     * @brief Number of SOURCEs that have not been returned by wait() in the
+     * current round.
+     */
+    size_t pending() const { return pending_.size(); }
+
+    /**
+     * @brief Block until at least one SOURCE that has not been returned in
+     * this round can be read. As with Source::wait(), all pending SOURCEs
+     * return once oat::quit is set.
+     * @return NodeState::END if the SINK of a SOURCE in ready() has left.
+     */
+    NodeState wait()
+    {
+        if (pending_.empty()) {
+            for (size_t i = 0; i < members_.size(); i++)
+                pending_.push_back(i);
+        }
+
+        ready_.clear();
+        NodeState result = NodeState::SINK_BOUND;
+        const uint64_t t0 = telemetry::now();
+
+        queues_.clear();
+        for (const auto i : pending_)
+            queues_.push_back(&members_[i]->wait_queue());
+
+        // Sleeps until any pending SOURCE's queue is notified
+        WaitQueue::wait_any(queues_.data(), queues_.size(),
+                            [this, &result, t0] {
+            size_t kept = 0;
+            for (size_t k = 0; k < pending_.size(); k++) {
+                const size_t i = pending_[k];
+                NodeState state;
+                if (members_[i]->try_wait(state, t0)) {
+                    ready_.push_back(i);
+                    if (state == NodeState::END)
+                        result = NodeState::END;
+                } else {
+                    pending_[kept++] = i;
+                }
+            }
+            pending_.resize(kept);
+
+            return !ready_.empty();
+        });
+
+        return result;
+    }
+
+    /**
+     * @brief SOURCEs returned by the last wait(), in the order in which they
+     * were found to be readable. Each must be post()ed before the next round.
+     */
+    const std::vector<size_t> & ready() const { return ready_; }
+
+private:
+
+    std::vector<std::unique_ptr<Concept>> members_;
+    std::vector<size_t> pending_;
+    std::vector<size_t> ready_;
+    std::vector<WaitQueue *> queues_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_SOURCESET_H */
@@ -0,0 +1,238 @@
+//******************************************************************************
+//* File:   Telemetry.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_TELEMETRY_H
+#define	OAT_TELEMETRY_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "../utility/Clock.h"
+
+namespace oat {
+namespace telemetry {
+
+/**
+ * Nanoseconds on the pipeline's shared clock. Comparable across processes.
+ */
+inline uint64_t now()
+{
+    return SharedClock::instance().now_ns();
+}
+
+/**
+ * Add to a counter that has a single writer. Avoids a locked
+ * read-modify-write; readers see either the old or new value.
+ */
+inline void add(std::atomic<uint64_t> &counter, const uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+}
+
+} // namespace telemetry
+
+/**
+ * Log-linear histogram of durations in nanoseconds, in the style of
+ * HdrHistogram. Each power of two is split into 16 linear buckets, so any
+ * recorded value is resolved to within about 6%. Durations beyond ~18 minutes
+ * are clamped. Written by a single thread and readable from any other without
+ * a lock; readers may see a sample counted in one field before another.
+ */
+class LatencyHistogram {
+
+    static constexpr unsigned SUB_BITS {4};
+    static constexpr unsigned MAX_BITS {40};
+    static constexpr uint64_t SUB_COUNT {1u << SUB_BITS};
+
+public:
+
+    static constexpr size_t NUM_BUCKETS {(MAX_BITS - SUB_BITS + 1) * SUB_COUNT};
+
+    LatencyHistogram()
+    {
+        for (auto &c : counts_)
+            c = 0;
+    }
+
+    void record(uint64_t ns)
+    {
+        ns = std::min<uint64_t>(ns, (uint64_t{1} << MAX_BITS) - 1);
+
+        telemetry::add(counts_[bucket(ns)], 1);
+        telemetry::add(sum_ns_, ns);
+        if (ns > max_ns_.load(std::memory_order_relaxed))
+            max_ns_.store(ns, std::memory_order_relaxed);
+        telemetry::add(count_, 1);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max_ns() const { return max_ns_.load(std::memory_order_relaxed); }
+    uint64_t bucket_count(const size_t i) const
+    {
+        return counts_[i].load(std::memory_order_relaxed);
+    }
+
+    double mean_ns() const
+    {
+        const uint64_t n = count();
+        return n > 0 ? static_cast<double>(sum_ns_.load(std::memory_order_relaxed)) / n : 0;
+    }
+
+    /**
+     * @brief Smallest bucket bound that at least a fraction q of recorded
+     * values do not exceed.
+     * @param q Quantile in [0, 1].
+     */
+    uint64_t quantile_ns(const double q) const
+    {
+        uint64_t total = 0;
+        for (const auto &c : counts_)
+            total += c.load(std::memory_order_relaxed);
+        if (total == 0)
+            return 0;
+
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * total + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(upper_ns(i), max_ns());
+        }
+
+        return max_ns();
+    }
+
+    // Range of values counted by bucket i
+    static uint64_t lower_ns(const size_t i)
+    {
+        if (i < 2 * SUB_COUNT)
+            return i;
+        const unsigned shift = i / SUB_COUNT - 1;
+        return (i % SUB_COUNT + SUB_COUNT) << shift;
+    }
+
+    static uint64_t upper_ns(const size_t i)
+    {
+        if (i < 2 * SUB_COUNT)
+            return i;
+        const unsigned shift = i / SUB_COUNT - 1;
+        return ((i % SUB_COUNT + SUB_COUNT + 1) << shift) - 1;
+    }
+
+private:
+
+    static size_t bucket(const uint64_t ns)
+    {
+        if (ns < 2 * SUB_COUNT)
+            return ns;
+
+        // Keep the top SUB_BITS + 1 bits of the value
+        const unsigned msb = 63 - __builtin_clzll(ns);
+        const unsigned shift = msb - SUB_BITS;
+        return (shift + 1) * SUB_COUNT + ((ns >> shift) - SUB_COUNT);
+    }
+
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> counts_;
+    std::atomic<uint64_t> count_ {0};
+    std::atomic<uint64_t> sum_ns_ {0};
+    std::atomic<uint64_t> max_ns_ {0};
+};
+
+/**
+ * Timing of a component's processing thread. Filled by that thread only:
+ * Component times each process() call, and the SINKs and SOURCEs it uses
+ * time their wait()s into whichever ProcessStats is registered for the
+ * calling thread.
+ */
+struct ProcessStats {
+    LatencyHistogram process;      //!< process() duration, including waits
+    LatencyHistogram source_wait;  //!< Time blocked in SOURCE wait()s
+    LatencyHistogram sink_wait;    //!< Time blocked in SINK wait()s
+    std::atomic<uint64_t> drops {0}; //!< Samples skipped by LOSSY SOURCEs
+};
+
+namespace telemetry {
+
+/**
+ * Statistics of the calling thread, or nullptr if it does not keep any.
+ */
+inline ProcessStats *&thread_stats()
+{
+    static thread_local ProcessStats *stats = nullptr;
+    return stats;
+}
+
+} // namespace telemetry
+
+/**
+ * Node-wide statistics. Written only by the SINK. All durations are in
+ * nanoseconds and all counters are cumulative so that a monitor can compute
+ * rates over any interval it likes.
+ */
+template <size_t Depth>
+struct NodeTelemetry {
+
+    NodeTelemetry()
+    {
+        for (auto &t : entry_write_ns)
+            t = 0;
+    }
+
+    std::atomic<int32_t> sink_pid {0}; //!< SINK process
+    std::atomic<uint64_t> last_write_ns {0}; //!< Time of the most recent post()
+    std::atomic<uint64_t> write_period_ns {0}; //!< Smoothed time between post()s
+    std::atomic<uint64_t> sink_wait_ns {0}; //!< Time the SINK spent blocked in wait()
+    std::array<std::atomic<uint64_t>, Depth> entry_write_ns; //!< post() time of each ring entry
+
+    // Written by LOSSY SOURCEs, which have no slot of their own
+    std::atomic<uint64_t> skipped {0}; //!< Writes skipped by LOSSY SOURCEs, summed over them
+
+    void recordWrite(const size_t entry)
+    {
+        const uint64_t t = telemetry::now();
+        const uint64_t last = last_write_ns.load(std::memory_order_relaxed);
+
+        // Exponential moving average with a time constant of ~8 writes
+        if (last > 0) {
+            const uint64_t period = write_period_ns.load(std::memory_order_relaxed);
+            const uint64_t dt = t - last;
+            write_period_ns.store(period == 0 ? dt : period - period / 8 + dt / 8,
+                                  std::memory_order_relaxed);
+        }
+
+        entry_write_ns[entry].store(t, std::memory_order_relaxed);
+        last_write_ns.store(t, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Per-SOURCE statistics. Written only by the SOURCE holding the slot.
+ */
+struct SlotTelemetry {
+    std::atomic<int32_t> pid {0}; //!< SOURCE process
+    std::atomic<uint64_t> reads {0}; //!< Completed reads
+    std::atomic<uint64_t> read_latency_ns {0}; //!< Time from SINK post() to SOURCE post(), summed over reads
+    std::atomic<uint64_t> wait_ns {0}; //!< Time the SOURCE spent blocked in wait()
+};
+
+}       /* namespace oat */
+#endif	/* OAT_TELEMETRY_H */
@@ -0,0 +1,266 @@
+//******************************************************************************
+//* File:   Clock.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_CLOCK_H
+#define	OAT_CLOCK_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <time.h>
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+
+#if defined(__x86_64__)
+ #include <x86intrin.h>
+ #define OAT_CLOCK_HAS_TSC
+#endif
+
+#include "IOFormat.h"
+
+namespace oat {
+
+/**
+ * Time base shared by every component on the host. The first component to
+ * use the clock creates a small shared memory segment holding the clock's
+ * calibration and the time the pipeline started; all others map it. Reading
+ * the clock is then a TSC read and a multiply on CPUs with an invariant TSC,
+ * and a CLOCK_MONOTONIC_RAW read otherwise. Either way, every timestamp in
+ * the graph is on the same time base. The clock is recalibrated and the
+ * pipeline start is reset when a component attaches to a clock that no other
+ * component is using.
+ */
+class SharedClock {
+
+public:
+
+    enum class Source : int {
+        MONOTONIC_RAW = 0, //!< clock_gettime(CLOCK_MONOTONIC_RAW)
+        TSC                //!< Invariant TSC, calibrated to CLOCK_MONOTONIC_RAW
+    };
+
+    /**
+     * @brief The process' view of the shared clock, mapped on first use.
+     */
+    static SharedClock &instance()
+    {
+        static SharedClock clock;
+        return clock;
+    }
+
+    SharedClock(const SharedClock &) = delete;
+    SharedClock &operator=(const SharedClock &) = delete;
+
+    ~SharedClock()
+    {
+        auto detach = [this] { shared_->users--; };
+        segment_.atomic_func(detach);
+    }
+
+    /**
+     * @brief Name of the shared memory segment holding the clock.
+     */
+    static const char *name() { return "oat_clock"; }
+
+    /**
+     * @brief Nanoseconds on the shared time base.
+     */
+    uint64_t now_ns() const
+    {
+#ifdef OAT_CLOCK_HAS_TSC
+        if (source_ == Source::TSC) {
+            const unsigned __int128 dt = __rdtsc() - tsc0_;
+            return ns0_ + static_cast<uint64_t>((dt * mult_) >> SHIFT);
+        }
+#endif
+        return rawNow();
+    }
+
+    /**
+     * @brief Time the pipeline started on the shared time base.
+     */
+    uint64_t start_ns() const { return start_ns_; }
+
+    /**
+     * @brief Nanoseconds since the pipeline started.
+     */
+    uint64_t since_start_ns() const { return now_ns() - start_ns_; }
+
+    Source source() const { return source_; }
+
+    /**
+     * @brief Calibrated TSC frequency. Zero if the TSC is not used.
+     */
+    double tsc_hz() const { return tsc_hz_; }
+
+private:
+
+    static constexpr unsigned SHIFT {32};
+    static constexpr uint64_t CALIBRATION_NS {20000000};
+
+    // Lives in the shared segment
+    struct Calibration {
+        Source source {Source::MONOTONIC_RAW};
+        uint64_t tsc0 {0};
+        uint64_t ns0 {0};
+        uint64_t mult {0};
+        double tsc_hz {0};
+        uint64_t start_ns {0};
+        uint64_t users {0};
+    };
+
+    SharedClock()
+    : segment_(boost::interprocess::open_or_create, name(), 4096)
+    {
+        auto attach = [this] {
+
+            shared_ = segment_.find_or_construct<Calibration>("calibration")();
+
+            // First user of an idle clock starts a new pipeline. Nobody else
+            // is reading the clock, so it can also be recalibrated, which
+            // bounds its drift from the raw clock to one pipeline's lifetime.
+            if (shared_->users == 0) {
+                calibrate(*shared_);
+                load(*shared_);
+                shared_->start_ns = now_ns();
+            }
+
+            shared_->users++;
+            load(*shared_);
+            start_ns_ = shared_->start_ns;
+        };
+        segment_.atomic_func(attach);
+    }
+
+    // Copy the calibration, so that reading the clock does not touch shared
+    // memory
+    void load(const Calibration &c)
+    {
+        source_ = c.source;
+        tsc0_ = c.tsc0;
+        ns0_ = c.ns0;
+        mult_ = c.mult;
+        tsc_hz_ = c.tsc_hz;
+    }
+
+    static uint64_t rawNow()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    /**
+     * Clock source requested via the OAT_CLOCK environment variable, which
+     * may be "auto", "tsc" or "monotonic". Auto uses the TSC if it is
+     * invariant.
+     */
+    static Source requestedSource()
+    {
+        const char *env = std::getenv("OAT_CLOCK");
+        const bool tsc_ok = invariantTSC();
+
+        if (env == nullptr || *env == '\0' || std::strcmp(env, "auto") == 0)
+            return tsc_ok ? Source::TSC : Source::MONOTONIC_RAW;
+        if (std::strcmp(env, "monotonic") == 0)
+            return Source::MONOTONIC_RAW;
+        if (std::strcmp(env, "tsc") == 0) {
+            if (!tsc_ok)
+                std::cerr << oat::Warn("OAT_CLOCK=tsc was requested, but this "
+                                       "CPU does not have an invariant TSC. "
+                                       "Using CLOCK_MONOTONIC_RAW.\n");
+            return tsc_ok ? Source::TSC : Source::MONOTONIC_RAW;
+        }
+
+        throw std::runtime_error("OAT_CLOCK must be one of "
+                                 "'auto', 'tsc' or 'monotonic'.");
+    }
+
+    // A TSC that ticks at a constant rate through frequency and idle state
+    // changes, and that the kernel keeps in sync across cores
+    static bool invariantTSC()
+    {
+#ifdef OAT_CLOCK_HAS_TSC
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.compare(0, 5, "flags") == 0)
+                return line.find(" constant_tsc") != std::string::npos
+                       && line.find(" nonstop_tsc") != std::string::npos;
+        }
+#endif
+        return false;
+    }
+
+    static void calibrate(Calibration &c)
+    {
+        c.source = requestedSource();
+        c.tsc_hz = 0;
+
+#ifdef OAT_CLOCK_HAS_TSC
+        if (c.source != Source::TSC)
+            return;
+
+        // Pair a raw clock reading with the TSC, keeping the tightest of a
+        // few brackets
+        auto pair = [](uint64_t &tsc, uint64_t &ns) {
+            uint64_t best = UINT64_MAX;
+            for (int i = 0; i < 8; i++) {
+                const uint64_t t0 = __rdtsc();
+                const uint64_t n = rawNow();
+                const uint64_t t1 = __rdtsc();
+                if (t1 - t0 < best) {
+                    best = t1 - t0;
+                    tsc = t0 + (t1 - t0) / 2;
+                    ns = n;
+                }
+            }
+        };
+
+        uint64_t tsc1 = 0, ns1 = 0;
+        pair(c.tsc0, c.ns0);
+        while (rawNow() - c.ns0 < CALIBRATION_NS) { }
+        pair(tsc1, ns1);
+
+        c.mult = static_cast<uint64_t>(
+            (static_cast<unsigned __int128>(ns1 - c.ns0) << SHIFT)
+            / (tsc1 - c.tsc0));
+        c.tsc_hz = 1e9 * (tsc1 - c.tsc0) / (ns1 - c.ns0);
+#endif
+    }
+
+    boost::interprocess::managed_shared_memory segment_;
+    Calibration *shared_ {nullptr};
+
+    // Local copies, so that reading the clock does not touch shared memory
+    Source source_ {Source::MONOTONIC_RAW};
+    uint64_t tsc0_ {0};
+    uint64_t ns0_ {0};
+    uint64_t mult_ {0};
+    double tsc_hz_ {0};
+    uint64_t start_ns_ {0};
+};
+
+}      /* namespace oat */
+#endif /* OAT_CLOCK_H */
@@ -46,5 +46,38 @@ ComponentInfo * ComponentInfo::instance() {
     return inst;
 }
 
+po::options_description schedulingOptions(const bool controllable)
+{
+    po::options_description opts;
+    opts.add_options()
+        ("cpus", po::value<std::string>(),
+         "Array of CPU indices, e.g. '[2,3]', that the processing thread is "
+         "pinned to. Defaults to any CPU.")
+        ;
+
+    if (controllable) {
+        opts.add_options()
+            ("control-cpus", po::value<std::string>(),
+             "Array of CPU indices that the runtime control thread is pinned "
+             "to. Defaults to any CPU.")
+            ;
+    }
+
+    opts.add_options()
+        ("rt-priority", po::value<int>(),
+         "SCHED_FIFO real-time priority, 1 to 99, of the processing thread. "
+         "Requires CAP_SYS_NICE or a sufficient RLIMIT_RTPRIO. Defaults to "
+         "normal scheduling.")
+        ("mlock",
+         "Lock all current and future memory of the process into RAM so that "
+         "it is never paged out. Limited by RLIMIT_MEMLOCK.")
+        ("jitter",
+         "On exit, report the mean, standard deviation and worst case of the "
+         "time between iterations of the processing loop.")
+        ;
+
+    return opts;
+}
+
 } /* namespace config */
 } /* namespace oat */
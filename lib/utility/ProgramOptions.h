@@ -56,6 +56,14 @@ private:
     std::unique_ptr<po::options_description> desc;
 };
 
+/**
+ * @brief Program options common to all configurable components that control
+ * where and how the component's threads run.
+ * @param controllable Include options for the runtime control thread.
+ * @return Scheduling program options.
+ */
+po::options_description schedulingOptions(const bool controllable);
+
 }      /* namespace config */
 }      /* namespace oat */
 #endif /* OAT_PROGRAM_OPTIONS */
@@ -0,0 +1,212 @@
+//******************************************************************************
+//* File:   RawFrameFile.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "RawFrameFile.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace oat {
+
+static const char RAW_MAGIC[8] = {'O', 'A', 'T', 'R', 'A', 'W', '\0', '\0'};
+
+static size_t pageAlign(const size_t bytes)
+{
+    return (bytes + RAW_PAGE - 1) / RAW_PAGE * RAW_PAGE;
+}
+
+static std::runtime_error systemError(const std::string &what,
+                                      const std::string &path)
+{
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+// Write all of a buffer, retrying short writes
+static void writeAll(const int fd, const char *data, size_t n)
+{
+    while (n > 0) {
+        const ssize_t rc = ::write(fd, data, n);
+        if (rc < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("Could not write raw frames: ")
+                                     + std::strerror(errno));
+        }
+        data += rc;
+        n -= rc;
+    }
+}
+
+void RawFrameWriter::open(const std::string &path, const RawFrameHeader &header)
+{
+    close();
+
+    header_ = header;
+    std::memcpy(header_.magic, RAW_MAGIC, sizeof(RAW_MAGIC));
+    header_.version = RAW_VERSION;
+    header_.record_bytes = sizeof(RawFrameRecord);
+    header_.stride = pageAlign(sizeof(RawFrameRecord) + header_.frame_bytes);
+
+    // Whole records, so that every write is a multiple of the page size
+    const size_t records = BUFFER_BYTES / header_.stride;
+    capacity_ = (records > 0 ? records : 1) * header_.stride;
+    used_ = 0;
+
+    void *buffer = nullptr;
+    if (posix_memalign(&buffer, RAW_PAGE, capacity_) != 0)
+        throw std::runtime_error("Could not allocate raw frame write buffer.");
+    buffer_ = static_cast<char *>(buffer);
+
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+        throw systemError("Could not create", path);
+
+    // Header page
+    std::memset(buffer_, 0, RAW_PAGE);
+    std::memcpy(buffer_, &header_, sizeof(header_));
+    used_ = RAW_PAGE;
+}
+
+void RawFrameWriter::write(const RawFrameRecord &record, const void *pixels)
+{
+    if (used_ + header_.stride > capacity_)
+        flush();
+
+    char *r = buffer_ + used_;
+    std::memcpy(r, &record, sizeof(record));
+    std::memcpy(r + sizeof(record), pixels, header_.frame_bytes);
+
+    // Zero the padding so that files do not carry stale memory
+    const size_t end = sizeof(record) + header_.frame_bytes;
+    std::memset(r + end, 0, header_.stride - end);
+
+    used_ += header_.stride;
+}
+
+void RawFrameWriter::flush()
+{
+    writeAll(fd_, buffer_, used_);
+    used_ = 0;
+}
+
+void RawFrameWriter::close()
+{
+    if (fd_ >= 0) {
+        flush();
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    std::free(buffer_);
+    buffer_ = nullptr;
+}
+
+void RawFrameReader::open(const std::string &path)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw systemError("Could not open", path);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw systemError("Could not stat", path);
+    }
+
+    size_t size = st.st_size;
+    if (size < RAW_PAGE) {
+        ::close(fd);
+        throw std::runtime_error(path + " is not a raw frame file.");
+    }
+
+    void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        throw systemError("Could not map", path);
+
+    data_ = static_cast<const char *>(data);
+    size_ = size;
+    std::memcpy(&header_, data_, sizeof(header_));
+
+    if (std::memcmp(header_.magic, RAW_MAGIC, sizeof(RAW_MAGIC)) != 0) {
+        close();
+        throw std::runtime_error(path + " is not a raw frame file.");
+    }
+
+    if (header_.version != RAW_VERSION) {
+        close();
+        throw std::runtime_error(path + " has raw frame file version "
+                                 + std::to_string(header_.version)
+                                 + ", but version "
+                                 + std::to_string(RAW_VERSION)
+                                 + " is supported.");
+    }
+
+    if (header_.stride < header_.record_bytes + header_.frame_bytes) {
+        close();
+        throw std::runtime_error(path + " has a corrupt header.");
+    }
+
+    // A partially written last record is ignored
+    frames_ = (size_ - RAW_PAGE) / header_.stride;
+}
+
+void RawFrameReader::close()
+{
+    if (data_ != nullptr)
+        munmap(const_cast<char *>(data_), size_);
+
+    data_ = nullptr;
+    size_ = 0;
+    frames_ = 0;
+}
+
+uint64_t RawFrameReader::find(const uint64_t count) const
+{
+    uint64_t lo = 0, hi = frames_;
+    while (lo < hi) {
+        const uint64_t mid = lo + (hi - lo) / 2;
+        if (record(mid).count < count)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+void RawFrameReader::prefetch(const uint64_t i, const uint64_t n) const
+{
+    if (i >= frames_)
+        return;
+
+    const uint64_t m = i + n < frames_ ? n : frames_ - i;
+    madvise(const_cast<char *>(at(i)), m * header_.stride, MADV_WILLNEED);
+}
+
+}      /* namespace oat */
@@ -0,0 +1,180 @@
+//******************************************************************************
+//* File:   RawFrameFile.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_RAWFRAMEFILE_H
+#define	OAT_RAWFRAMEFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace oat {
+
+/**
+ * Layout of .oatraw files, which hold uncompressed frames.
+ *
+ * The file starts with a RawFrameHeader padded to RAW_PAGE bytes. It is
+ * followed by one record per frame. Each record is a RawFrameRecord holding
+ * the frame's sample, followed by the frame's pixels, padded to a multiple of
+ * RAW_PAGE bytes. All records have the same size, so that frame i starts at
+ * RAW_PAGE + i * stride and the number of frames follows from the file size,
+ * even if the recorder did not exit cleanly.
+ */
+constexpr size_t RAW_PAGE {4096};
+constexpr uint32_t RAW_VERSION {1};
+
+struct RawFrameHeader {
+    char magic[8];           //!< "OATRAW" followed by two NULs
+    uint32_t version;        //!< RAW_VERSION
+    uint32_t record_bytes;   //!< Offset of the pixels in a record
+    uint64_t stride;         //!< Bytes per record
+    uint64_t rows;
+    uint64_t cols;
+    int32_t type;            //!< OpenCV matrix type
+    int32_t color;           //!< oat::PixelColor
+    uint64_t frame_bytes;    //!< Pixel bytes per frame
+    double rate_hz;          //!< Sample rate of the recorded SOURCE
+};
+
+struct RawFrameRecord {
+    uint64_t count;          //!< Sample number
+    int64_t microseconds;    //!< Sample time
+    uint64_t capture_ns;     //!< Capture time on the shared clock, 0 if unknown
+    uint64_t reserved[5];
+};
+
+static_assert(sizeof(RawFrameHeader) <= RAW_PAGE, "Raw header too large.");
+static_assert(sizeof(RawFrameRecord) == 64, "Raw record must be a cache line.");
+
+/**
+ * Appends frames to a .oatraw file. Records are gathered in a page aligned
+ * buffer of at least a few megabytes and written in one system call when
+ * it is full, so the disk sees large, aligned writes.
+ */
+class RawFrameWriter {
+
+public:
+
+    RawFrameWriter() = default;
+    ~RawFrameWriter() { close(); }
+
+    RawFrameWriter(const RawFrameWriter &) = delete;
+    RawFrameWriter &operator=(const RawFrameWriter &) = delete;
+
+    /**
+     * @brief Create the file and write its header. Closes the previous file,
+     * if any.
+     * @param path Path to the file.
+     * @param header Frame geometry and rate. The magic, version, record size
+     * and stride are filled in.
+     */
+    void open(const std::string &path, const RawFrameHeader &header);
+
+    /**
+     * @brief Append a frame.
+     * @param record The frame's sample.
+     * @param pixels header().frame_bytes of contiguous pixel data.
+     */
+    void write(const RawFrameRecord &record, const void *pixels);
+
+    /**
+     * @brief Write buffered frames and close the file.
+     */
+    void close(void);
+
+    bool is_open(void) const { return fd_ >= 0; }
+    const RawFrameHeader &header(void) const { return header_; }
+
+private:
+
+    static constexpr size_t BUFFER_BYTES {8 << 20};
+
+    void flush(void);
+
+    int fd_ {-1};
+    RawFrameHeader header_ {};
+    char *buffer_ {nullptr};
+    size_t capacity_ {0};
+    size_t used_ {0};
+};
+
+/**
+ * Memory maps a .oatraw file for reading. Frames are accessed in place.
+ */
+class RawFrameReader {
+
+public:
+
+    RawFrameReader() = default;
+    ~RawFrameReader() { close(); }
+
+    RawFrameReader(const RawFrameReader &) = delete;
+    RawFrameReader &operator=(const RawFrameReader &) = delete;
+
+    /**
+     * @brief Map a file. Throws if it is not a .oatraw file.
+     * @param path Path to the file.
+     */
+    void open(const std::string &path);
+    void close(void);
+
+    const RawFrameHeader &header(void) const { return header_; }
+
+    /**
+     * @brief Number of complete frames in the file.
+     */
+    uint64_t frames(void) const { return frames_; }
+
+    const RawFrameRecord &record(const uint64_t i) const
+    {
+        return *reinterpret_cast<const RawFrameRecord *>(at(i));
+    }
+
+    const void *pixels(const uint64_t i) const
+    {
+        return at(i) + header_.record_bytes;
+    }
+
+    /**
+     * @brief Index of the first frame whose sample number is at least
+     * count. frames() if there is none. Sample numbers increase through the
+     * file, but may have gaps where the recorder dropped samples.
+     */
+    uint64_t find(const uint64_t count) const;
+
+    /**
+     * @brief Ask the kernel to start reading frames [i, i + n) from disk.
+     */
+    void prefetch(const uint64_t i, const uint64_t n) const;
+
+private:
+
+    const char *at(const uint64_t i) const
+    {
+        return data_ + RAW_PAGE + i * header_.stride;
+    }
+
+    RawFrameHeader header_ {};
+    const char *data_ {nullptr};
+    size_t size_ {0};
+    uint64_t frames_ {0};
+};
+
+}      /* namespace oat */
+#endif /* OAT_RAWFRAMEFILE_H */
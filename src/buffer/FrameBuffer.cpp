@@ -55,21 +55,23 @@ bool FrameBuffer::connectToNode()
 
 int FrameBuffer::process()
 {
-    // START CRITICAL SECTION //
-    ////////////////////////////
+    {
+        // START CRITICAL SECTION //
+        ////////////////////////////
 
-    // Wait for sink to write to node
-    if (source_.wait() == oat::NodeState::END)
-        return 1;
+        // Wait for sink to write to node and lease the shared frame
+        auto frame = source_.lease();
+        if (frame.state() == oat::NodeState::END)
+            return 1;
 
-    if (!buffer_.push(source_.clone()))
-        std::cerr << "Buffer overrun.\n";
+        if (!buffer_.push(frame->clone()))
+            std::cerr << "Buffer overrun.\n";
 
-    // Tell sink it can continue
-    source_.post();
+        // Lease tells sink it can continue when it goes out of scope
 
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
 
     // Notify comsumer thread that it can proceed
     cv_.notify_one();
@@ -103,7 +105,7 @@ void FrameBuffer::pop()
 
             // TODO: use specialized spsc allocator for popping somehow?
             buffer_.consume_one(
-                [this](oat::Frame frame){ frame.copyTo(shared_frame_); }
+                [this](oat::Frame frame){ frame.copyTo(*shared_frame_); }
             );
 
             // Tell sources there is new data
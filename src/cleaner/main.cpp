@@ -19,12 +19,18 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
 #include <iostream>
 #include <unordered_map>
 #include <csignal>
+#include <cxxabi.h>
 #include <boost/program_options.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
 
+#include "../../lib/shmemdf/FramePages.h"
+#include "../../lib/shmemdf/Registry.h"
 #include "../../lib/utility/IOFormat.h"
 
 namespace po = boost::program_options;
@@ -33,15 +39,86 @@ namespace bip = boost::interprocess;
 void printUsage(po::options_description options) {
     std::cout << "Usage: clean [INFO]\n"
               << "   or: clean NAMES [CONFIGURATION]\n"
-              << "Deallocate the named shared memory segments specified by NAMES.\n\n"
+              << "   or: clean --stale [CONFIGURATION]\n"
+              << "Deallocate the named shared memory segments specified by NAMES,\n"
+              << "or those of every node whose components have all exited.\n\n"
               << options << "\n";
 }
 
+// Remove a node's segments and its registry entry
+bool removeNode(const std::string &name)
+{
+    bool success {false};
+
+    if (bip::shared_memory_object::remove((name + "_node").c_str()))
+        success = true;
+
+    if (bip::shared_memory_object::remove((name + "_obj").c_str()))
+        success = true;
+
+    // Latency traces of a SINK that was tracing
+    if (bip::shared_memory_object::remove((name + "_trace").c_str()))
+        success = true;
+
+    // Frame data placed on hugetlbfs
+    const std::string mount = oat::pages::hugetlbfsMount();
+    if (!mount.empty()
+        && unlink((mount + "/" + name + "_frames").c_str()) == 0) {
+        success = true;
+    }
+
+    oat::Registry::instance().remove(name);
+
+    return success;
+}
+
+std::string demangle(const char *type)
+{
+    int status = -1;
+    char *name = abi::__cxa_demangle(type, nullptr, nullptr, &status);
+    std::string out = status == 0 ? name : type;
+    std::free(name);
+
+    return out;
+}
+
+void listNodes()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    const double now = ts.tv_sec + ts.tv_nsec / 1e9;
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-16s %-20s %-14s %8s %7s %10s %s\n",
+                  "NODE", "TYPE", "GEOMETRY", "SINK", "READERS", "AGE (s)",
+                  "STATE");
+    std::cout << line;
+
+    for (const auto &e : oat::Registry::instance().list()) {
+
+        char geometry[32];
+        if (e.rows > 0)
+            std::snprintf(geometry, sizeof(geometry), "%llux%llu",
+                          static_cast<unsigned long long>(e.cols),
+                          static_cast<unsigned long long>(e.rows));
+        else
+            std::snprintf(geometry, sizeof(geometry), "%llu B",
+                          static_cast<unsigned long long>(e.bytes));
+
+        std::snprintf(line, sizeof(line), "%-16s %-20s %-14s %8d %7u %10.0f %s\n",
+                      e.name, demangle(e.type).c_str(), geometry, e.sink_pid,
+                      e.readers, now - e.created_ns / 1e9,
+                      e.stale() ? "stale" : "live");
+        std::cout << line;
+    }
+}
+
 int main(int argc, char *argv[]) {
 
     std::vector<std::string> names;
     bool quiet = false;
     bool legacy = false;
+    bool stale = false;
 
     try {
 
@@ -49,12 +126,15 @@ int main(int argc, char *argv[]) {
         options.add_options()
             ("help", "Produce help message.")
             ("version,v", "Print version information.")
+            ("list", "List the nodes in shared memory and exit.")
             ;
 
         po::options_description config("CONFIGURATION");
         options.add_options()
             ("quiet,q", "Quiet mode. Prevent output text.")
             ("legacy,l", "Legacy mode. Append  \"_sh_mem\" to input NAMES before removing.")
+            ("stale,s", "Remove every node whose SINK and SOURCEs have all "
+             "exited without cleaning up.")
             ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -97,7 +177,15 @@ int main(int argc, char *argv[]) {
             return 0;
         }
 
-        if (!variable_map.count("names")) {
+        if (variable_map.count("list")) {
+            listNodes();
+            return 0;
+        }
+
+        if (variable_map.count("stale"))
+            stale = true;
+
+        if (!variable_map.count("names") && !stale) {
             printUsage(visible_options);
             std::cout << "Error: at least a single NAME must be specified. Exiting.\n";
             return -1;
@@ -109,7 +197,8 @@ int main(int argc, char *argv[]) {
         if (variable_map.count("legacy"))
             legacy = true;
 
-        names = variable_map["names"].as< std::vector<std::string> >();
+        if (variable_map.count("names"))
+            names = variable_map["names"].as< std::vector<std::string> >();
 
     } catch (std::exception& e) {
         std::cerr << oat::Error(e.what()) << "\n";
@@ -119,6 +208,16 @@ int main(int argc, char *argv[]) {
         return -1;
     }
 
+    if (stale) {
+        for (const auto &e : oat::Registry::instance().list()) {
+            if (e.stale())
+                names.push_back(e.name);
+        }
+
+        if (names.empty() && !quiet)
+            std::cout << "No stale nodes found.\n";
+    }
+
     for (auto &name : names) {
 
         // All servers (MatServer and SMServer) append "_sh_mem" to user-provided
@@ -137,15 +236,7 @@ int main(int argc, char *argv[]) {
 
         } else {
 
-            bool success {false};
-
-            if (bip::shared_memory_object::remove((name + "_node").c_str())) {
-                success = true;
-            }
-
-            if (bip::shared_memory_object::remove((name + "_obj").c_str())) {
-                success = true;
-            }
+            const bool success = removeNode(name);
 
             if (success && !quiet)
                 std::cout << "success.\n";
@@ -24,6 +24,9 @@
 #include <thread>
 #include <unistd.h>
 
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
 #include "Controller.h"
 
 #include "../../lib/base/ControllableComponent.h"
@@ -132,6 +135,97 @@ std::string Controller::list() const
     return ss.str();
 }
 
+std::string Controller::stats(const bool json)
+{
+    send("stats");
+
+    // Collect replies, skipping identity messages from the scan handshake
+    std::map<Identity, rapidjson::Document> replies;
+    int retries_left = 100;
+    while (replies.size() < subscriptions_.size()) {
+
+        zmq::pollitem_t p[] = {{router_, 0, ZMQ_POLLIN, 0}};
+        zmq::poll(&p[0], 1, 10);
+
+        if (p[0].revents & ZMQ_POLLIN) {
+
+            std::string id, data;
+            if (!recvReqEnvelope(&router_, id, data)
+                || !subscriptions_.count(id))
+                continue;
+
+            rapidjson::Document doc;
+            doc.Parse(data.c_str());
+            if (doc.HasParseError() || !doc.IsObject()
+                || !doc.HasMember("stats"))
+                continue;
+
+            replies[id] = std::move(doc);
+
+        } else if (retries_left-- == 0) {
+            break;
+        }
+    }
+
+    std::stringstream ss;
+
+    if (json) {
+        for (const auto &r : replies) {
+            rapidjson::StringBuffer buffer;
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+            r.second.Accept(writer);
+            ss << buffer.GetString() << "\n";
+        }
+        return ss.str();
+    }
+
+    const char sep = ' ';
+    const int idx_width = 8;
+    const int name_width = 30;
+    const int n_width = 10;
+    const int t_width = 10;
+
+    ss << std::left << std::setw(idx_width) << std::setfill(sep) << "Index";
+    ss << std::left << std::setw(name_width) << std::setfill(sep) << "Name";
+    ss << std::left << std::setw(n_width) << std::setfill(sep) << "Loops";
+    for (const auto h : {"Proc", "Src", "Sink"}) {
+        ss << std::left << std::setw(t_width) << std::setfill(sep) << (std::string(h) + " p50");
+        ss << std::left << std::setw(t_width) << std::setfill(sep) << (std::string(h) + " p99");
+        ss << std::left << std::setw(t_width) << std::setfill(sep) << (std::string(h) + " max");
+    }
+    ss << "Drops\n";
+
+    int idx = 0;
+    for (const auto &s : subscriptions_) {
+
+        const int i = idx++;
+        if (!replies.count(s.first))
+            continue;
+
+        const rapidjson::Value &st = replies.at(s.first)["stats"];
+
+        ss << std::left << std::setw(idx_width) << std::setfill(sep) << i;
+        ss << std::left << std::setw(name_width) << std::setfill(sep) << s.second.name;
+        ss << std::left << std::setw(n_width) << std::setfill(sep)
+           << st["process"]["count"].GetUint64();
+
+        ss << std::fixed << std::setprecision(1);
+        for (const auto h : {"process", "source_wait", "sink_wait"}) {
+            for (const auto q : {"p50_us", "p99_us", "max_us"})
+                ss << std::left << std::setw(t_width) << std::setfill(sep)
+                   << st[h][q].GetDouble();
+        }
+        ss << st["drops"].GetUint64() << "\n";
+    }
+
+    ss << "Times are in microseconds. Proc includes time blocked in Src and Sink.\n";
+    if (replies.size() < subscriptions_.size())
+        ss << std::to_string(subscriptions_.size() - replies.size())
+           << " component(s) did not reply.\n";
+
+    return ss.str();
+}
+
 int Controller::addSubscriber(const std::string &id_string,
                               const std::string &data)
 {
@@ -185,6 +279,7 @@ void Controller::help(const std::string &target_id) const
 
         auto cmds = subscriptions_.at(target_id).commands;
         cmds.emplace("help", "Print this message.");
+        cmds.emplace("stats", "Reply with timing histograms of the processing loop.");
         cmds.emplace("quit", "Exit the program..");
 
         size_t max_len = 7; // For "COMMAND"
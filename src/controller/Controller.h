@@ -64,6 +64,15 @@ public:
 
     std::string list(void) const;
 
+    /**
+     * @brief Ask each subscriber for the statistics of its processing loop
+     * and wait briefly for their replies.
+     * @param json Return the replies, one per line, instead of a table.
+     * @return Table of processing, SOURCE wait and SINK wait times and drop
+     * counts, one row per subscriber that replied.
+     */
+    std::string stats(const bool json = false);
+
     int addSubscriber(const std::string &identity,
                       const std::string &name);
 
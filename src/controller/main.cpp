@@ -33,6 +33,7 @@ namespace po = boost::program_options;
 void printUsage(po::options_description options) {
     std::cout << "Usage: control [INFO]\n"
               << "   or: control ENDPOINT [INFO]\n"
+              << "   or: control ENDPOINT --stats [--json]\n"
               << "   or: control ENDPOINT ID COMMAND\n"
               << "   or: control\n"
               << "Control running oat components.\n\n"
@@ -52,6 +53,12 @@ int main(int argc, char *argv[]) {
             ("version,v", "Print version information.")
             ("list,l", "Print a list of controllable components, along with IDs " 
              "and valid commands, for the specified endpoint.")
+            ("stats,s", "Poll each controllable component at the specified "
+             "endpoint for statistics of its processing loop and print them as "
+             "a table: process() duration, time blocked waiting on SOURCEs and "
+             "SINKs, and the number of samples dropped by lossy SOURCEs.")
+            ("json", "With --stats, print each component's full histograms as "
+             "a line of JSON instead of a table.")
             ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -118,7 +125,11 @@ int main(int argc, char *argv[]) {
 
             oat::Controller ctrl(endpoint.c_str());
             ctrl.scan();
-            std::cout << ctrl.list();
+
+            if (variable_map.count("stats"))
+                std::cout << ctrl.stats(variable_map.count("json") > 0);
+            else
+                std::cout << ctrl.list();
 
         } else if ((variable_map.count("endpoint") 
                   && variable_map.count("id")
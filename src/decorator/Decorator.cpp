@@ -121,8 +121,11 @@ bool Decorator::connectToNode()
     // Establish our a slots in the frame and positions sources
     frame_source_.touch(frame_source_address_);
 
-    for (auto &ps : position_sources_)
+    for (auto &ps : position_sources_) {
         ps.source->touch(ps.name);
+        source_set_.add(*ps.source);
+    }
+    frame_index_ = source_set_.add(frame_source_);
 
     // Wait for synchronous start with sink when it binds the node
     if (frame_source_.connect() != SourceState::CONNECTED)
@@ -140,7 +143,7 @@ bool Decorator::connectToNode()
     // Bind to sink sink node and create a shared frame
     frame_sink_.bind(frame_sink_address_, param.bytes);
     shared_frame_ = frame_sink_.retrieve(param.rows, param.cols, param.type, param.color);
-    all_ts.push_back(shared_frame_.sample_period_sec());
+    all_ts.push_back(shared_frame_->sample_period_sec());
 
     if (!oat::checkSamplePeriods(all_ts, sample_rate_hz)) {
         std::cerr << oat::Warn(oat::inconsistentSampleRateWarning(sample_rate_hz));
@@ -157,7 +160,7 @@ bool Decorator::connectToNode()
     if (decorate_position_) {
         previous_positions_.push_back(oat::Point2D(0,0));
         positions_found_.push_back(false);
-        history_frame_ = cv::Mat::zeros(shared_frame_.size(), shared_frame_.type());
+        history_frame_ = cv::Mat::zeros(shared_frame_->size(), shared_frame_->type());
     }
 
     return true;
@@ -165,37 +168,33 @@ bool Decorator::connectToNode()
 
 int Decorator::process()
 {
-    // 1. Get frame
-    // START CRITICAL SECTION //
-    ////////////////////////////
-
-    // Wait for sink to write to node
-    if (frame_source_.wait() == oat::NodeState::END)
-        return 1;
-
-    // Clone the shared frame
-    frame_source_.copyTo(internal_frame_);
-
-    // Tell sink it can continue
-    frame_source_.post();
-
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
-
-    // 2. Get positions
-    for (pvec_size_t i = 0; i !=  position_sources_.size(); i++) {
+    // Get the frame and positions, in the order in which they are written
+    do {
 
         // START CRITICAL SECTION //
         ////////////////////////////
-        if (position_sources_[i].source->wait() == oat::NodeState::END)
+        if (source_set_.wait() == oat::NodeState::END)
             return 1;
 
-        positions_[i] = position_sources_[i].source->clone();
+        for (const auto i : source_set_.ready()) {
+
+            if (i == frame_index_) {
+
+                // Decorations are drawn in place, so the shared frame must be
+                // copied
+                frame_source_.copyTo(internal_frame_);
+                frame_source_.post();
+
+            } else {
 
-        position_sources_[i].source->post();
+                positions_[i] = position_sources_[i].source->clone();
+                position_sources_[i].source->post();
+            }
+        }
         ////////////////////////////
         //  END CRITICAL SECTION  //
-    }
+
+    } while (source_set_.pending() > 0);
 
     // Decorate frame
     drawOnFrame();
@@ -206,7 +205,7 @@ int Decorator::process()
     // Wait for sources to read
     frame_sink_.wait();
 
-    internal_frame_.copyTo(shared_frame_);
+    internal_frame_.copyTo(*shared_frame_);
 
     // Tell sources there is new data
     frame_sink_.post();
@@ -33,6 +33,7 @@
 #include "../../lib/shmemdf/Helpers.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/Source.h"
+#include "../../lib/shmemdf/SourceSet.h"
 
 namespace po = boost::program_options;
 
@@ -85,7 +86,7 @@ private:
     oat::Source<oat::Frame> frame_source_;
 
     // Mat server for sending decorated frames
-    oat::Frame shared_frame_;
+    oat::Frame * shared_frame_ {nullptr};
     std::string frame_sink_address_;
     oat::Sink<oat::Frame> frame_sink_;
 
@@ -93,6 +94,10 @@ private:
     std::vector<oat::Position2D> positions_;
     oat::NamedSourceList<oat::Position2D> position_sources_;
 
+    // Waits on the position SOURCEs, followed by the frame SOURCE
+    oat::SourceSet source_set_;
+    size_t frame_index_ {0};
+
     // Options
     bool decorate_position_ {true};
     bool print_region_ {false};
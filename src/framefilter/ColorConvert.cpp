@@ -87,8 +87,9 @@ bool ColorConvert::connectToNode()
 
     // Bind to sink node and create a shared frame
     // Because this changes the color, it might change the size and type of
-    // frame
-    size_t bytes = frame_parameters.rows * frame_parameters.cols
+    // frame. Leave room for any frame that the source can reshape to.
+    size_t bytes = frame_source_.capacity()
+                   / oat::color_bytes(frame_parameters.color)
                    * oat::color_bytes(color_);
     frame_sink_.bind(frame_sink_address_, bytes);
     shared_frame_ = frame_sink_.retrieve(frame_parameters.rows,
@@ -106,4 +107,11 @@ void ColorConvert::filter(cv::Mat &frame)
     static_cast<oat::Frame &>(frame).set_color(color_);
 }
 
+void ColorConvert::filter(const oat::Frame &source, oat::Frame &sink)
+{
+    // The sink already has the converted type, so this converts straight
+    // into it
+    cv::cvtColor(source, sink, conversion_code_);
+}
+
 } /* namespace oat */
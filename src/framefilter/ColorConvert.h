@@ -46,6 +46,11 @@ private:
                             const config::OptionTable &config_table) override;
 
     void filter(cv::Mat &frame) override;
+    void filter(const oat::Frame &source, oat::Frame &sink) override;
+    oat::PixelColor sinkColor(const oat::PixelColor) const override
+    {
+        return color_;
+    }
 
     int conversion_code_;
     oat::PixelColor color_;
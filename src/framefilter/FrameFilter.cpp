@@ -46,8 +46,9 @@ bool FrameFilter::connectToNode()
     // Get frame meta data to format sink
     auto frame_parameters = frame_source_.parameters();
 
-    // Bind to sink node and create a shared frame
-    frame_sink_.bind(frame_sink_address_, frame_parameters.bytes);
+    // Bind to sink node and create a shared frame. Leave room for any frame
+    // that the source can reshape to.
+    frame_sink_.bind(frame_sink_address_, frame_source_.capacity());
     shared_frame_ = frame_sink_.retrieve(frame_parameters.rows,
                                          frame_parameters.cols,
                                          frame_parameters.type,
@@ -58,34 +59,36 @@ bool FrameFilter::connectToNode()
 
 int FrameFilter::process()
 {
-    oat::Frame internal_frame;
-
     // START CRITICAL SECTION //
     ////////////////////////////
 
-    // Wait for sink to write to node
-    if (frame_source_.wait() == oat::NodeState::END)
+    // Wait for sink to write to node and lease the shared frame
+    auto frame = frame_source_.lease();
+    if (frame.state() == oat::NodeState::END)
         return 1;
 
-    // Clone the shared frame
-    frame_source_.copyTo(internal_frame);
-
-    // Tell sink it can continue
-    frame_source_.post();
-
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
-
-    // Filter internal frame
-    filter(internal_frame);
-
-    // START CRITICAL SECTION //
-    ////////////////////////////
+    const uint64_t enter_ns = oat::Sample::now_ns();
+    frame_source_.trace(trace_);
 
-    // Wait for sources to read
+    // Wait for sources to read. The lease is held so that the frame is
+    // filtered straight from the SOURCE into the SINK.
     frame_sink_.wait();
 
-    internal_frame.copyTo(shared_frame_);
+    // Follow changes in geometry made upstream
+    const auto color = sinkColor(frame->color());
+    const int type = color == frame->color() ? frame->type()
+                                             : oat::cv_type(color);
+    if (frame->size() != shared_frame_->size()
+        || type != shared_frame_->type()
+        || color != shared_frame_->color())
+        shared_frame_ = frame_sink_.reshape(frame->rows, frame->cols, type, color);
+
+    filter(*frame, *shared_frame_);
+    shared_frame_->set_sample(frame->sample());
+    frame_sink_.trace(trace_, name_, enter_ns);
+
+    // Lease tells sink it can continue when it goes out of scope
+    frame.release();
 
     // Tell sources there is new data
     frame_sink_.post();
@@ -63,6 +63,29 @@ protected:
      */
     virtual void filter(cv::Mat &frame) = 0;
 
+    /**
+     * Filter a SOURCE frame into the SINK frame. By default, the frame is
+     * copied and filtered in place. Override for filters that can write
+     * their result directly.
+     * @param source Frame to be filtered
+     * @param sink Filtered frame, already shaped with the size of source and
+     * sinkColor()
+     */
+    virtual void filter(const oat::Frame &source, oat::Frame &sink)
+    {
+        source.copyTo(sink);
+        filter(sink);
+    }
+
+    /**
+     * Pixel color of filtered frames.
+     * @param source_color Pixel color of the SOURCE frame
+     */
+    virtual oat::PixelColor sinkColor(const oat::PixelColor source_color) const
+    {
+        return source_color;
+    }
+
 private:
     // Component Interface
     virtual bool connectToNode(void) override;
@@ -77,7 +100,10 @@ private:
     oat::Sink<oat::Frame> frame_sink_;
 
     // Currently acquired, shared frame
-    oat::Frame shared_frame_;
+    oat::Frame * shared_frame_ {nullptr};
+
+    // Latency trace of the frame being filtered
+    oat::Trace trace_;
 };
 
 }      /* namespace oat */
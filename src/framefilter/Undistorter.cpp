@@ -87,4 +87,11 @@ void Undistorter::filter(cv::Mat &frame)
     cv::undistort(temp, frame, camera_matrix_, dist_coeff_);
 }
 
+void Undistorter::filter(const oat::Frame &source, oat::Frame &sink)
+{
+    // Undistortion cannot be done in place, but it can be done straight
+    // into the sink
+    cv::undistort(source, sink, camera_matrix_, dist_coeff_);
+}
+
 } /* namespace oat */
@@ -53,6 +53,7 @@ private:
      * @return Filtered frame
      */
     void filter(cv::Mat &frame) override;
+    void filter(const oat::Frame &source, oat::Frame &sink) override;
 
     cv::Matx33d camera_matrix_ {cv::Matx33d::eye()};
     std::vector<double> dist_coeff_;
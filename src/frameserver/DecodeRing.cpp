@@ -0,0 +1,128 @@
+//******************************************************************************
+//* File:   DecodeRing.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "DecodeRing.h"
+
+#include <algorithm>
+
+#include "../../lib/base/Globals.h"
+
+namespace oat {
+
+DecodeRing::~DecodeRing()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    free_.notify_all();
+
+    for (auto &t : decoders_)
+        t.join();
+}
+
+void DecodeRing::reset(const size_t depth, const uint64_t first, const uint64_t end)
+{
+    ring_.resize(depth);
+    next_ = first;
+    claimed_ = first;
+    end_ = end;
+}
+
+void DecodeRing::start(const size_t num_decoders,
+                       const std::function<void(size_t)> &decode)
+{
+    for (size_t k = 0; k < num_decoders; k++)
+        decoders_.emplace_back(decode, k);
+}
+
+const DecodeRing::Entry * DecodeRing::next()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    const Entry &e = entry(next_);
+    ready_.wait(lock, [this, &e] {
+        return (e.ready && e.index == next_) || next_ >= end_ || quit;
+    });
+
+    if (next_ >= end_ || quit)
+        return nullptr;
+
+    return &e;
+}
+
+void DecodeRing::release()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry(next_).ready = false;
+        next_++;
+    }
+    free_.notify_all();
+}
+
+DecodeRing::Entry * DecodeRing::waitFree(const uint64_t i)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    free_.wait(lock, [this, i] {
+        return i < next_ + ring_.size() || i >= end_ || stop_;
+    });
+
+    if (stop_ || i >= end_)
+        return nullptr;
+
+    return &entry(i);
+}
+
+DecodeRing::Entry * DecodeRing::claim(uint64_t &i)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    free_.wait(lock, [this] {
+        return claimed_ < next_ + ring_.size() || claimed_ >= end_ || stop_;
+    });
+
+    if (stop_ || claimed_ >= end_)
+        return nullptr;
+
+    i = claimed_++;
+    return &entry(i);
+}
+
+void DecodeRing::ready(const uint64_t i, const std::string &error)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry &e = entry(i);
+        e.index = i;
+        e.error = error;
+        e.ready = true;
+    }
+    ready_.notify_one();
+}
+
+void DecodeRing::truncate(const uint64_t i)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        end_ = std::min(end_, i);
+    }
+    ready_.notify_one();
+    free_.notify_all();
+}
+
+} /* namespace oat */
@@ -0,0 +1,135 @@
+//******************************************************************************
+//* File:   DecodeRing.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_DECODERING_H
+#define	OAT_DECODERING_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+
+namespace oat {
+
+/**
+ * Decode-ahead for frame servers that read recorded data. Decoder threads
+ * fill a ring of frames ahead of the one being served, so that decoding
+ * overlaps with downstream processing. Frames can be decoded out of order,
+ * but they are served in order.
+ */
+class DecodeRing {
+public:
+
+    struct Entry {
+        cv::Mat frame;
+        uint64_t index {0};
+        bool ready {false};
+        std::string error; //!< Empty unless the frame could not be decoded
+    };
+
+    /**
+     * @brief Stops and joins the decoders.
+     */
+    ~DecodeRing();
+
+    /**
+     * @brief Allocate the ring. Must be called before start().
+     * @param depth Number of frames that can be decoded ahead
+     * @param first Index of the first frame to serve
+     * @param end Index of the first frame that will not be served
+     */
+    void reset(const size_t depth, const uint64_t first, const uint64_t end);
+
+    /**
+     * @brief Start decoder threads.
+     * @param num_decoders Number of decoder threads
+     * @param decode Body of each decoder thread, which is passed the
+     * decoder's number
+     */
+    void start(const size_t num_decoders,
+               const std::function<void(size_t)> &decode);
+
+    size_t size(void) const { return ring_.size(); }
+
+    /**
+     * @brief Entry that frame i is decoded into.
+     */
+    Entry & entry(const uint64_t i) { return ring_[i % ring_.size()]; }
+
+    // Serving thread
+
+    /**
+     * @brief Wait until the next frame has been decoded.
+     * @return The next frame's entry, which is not reused until release(),
+     * or nullptr at the end of the frames or on quit.
+     */
+    const Entry * next(void);
+
+    /**
+     * @brief Hand the entry of the frame that was served back to the
+     * decoders.
+     */
+    void release(void);
+
+    // Decoder threads
+
+    /**
+     * @brief Wait until frame i's entry has been served. The entry then
+     * belongs to the calling decoder until it calls ready().
+     * @return The entry, or nullptr if frame i will not be served.
+     */
+    Entry * waitFree(const uint64_t i);
+
+    /**
+     * @brief Claim the next frame that no decoder has claimed, once its
+     * entry has been served.
+     * @param i Set to the index of the claimed frame
+     * @return The frame's entry, or nullptr if there are no frames left.
+     */
+    Entry * claim(uint64_t &i);
+
+    /**
+     * @brief Mark frame i as decoded.
+     * @param error Why the frame could not be decoded, if it could not
+     */
+    void ready(const uint64_t i, const std::string &error = "");
+
+    /**
+     * @brief End the frames at i, which may be before the end passed to
+     * reset(), e.g. when a video is shorter than its container said.
+     */
+    void truncate(const uint64_t i);
+
+private:
+    std::vector<Entry> ring_;
+    std::vector<std::thread> decoders_;
+    std::mutex mutex_;
+    std::condition_variable ready_, free_;
+    uint64_t next_ {0};    //!< Next frame to serve
+    uint64_t end_ {0};     //!< First frame that will not be served
+    uint64_t claimed_ {0}; //!< Next frame to be claimed by a decoder
+    bool stop_ {false};
+};
+
+}       /* namespace oat */
+#endif	/* OAT_DECODERING_H */
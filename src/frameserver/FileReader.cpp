@@ -17,6 +17,7 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include <algorithm>
 #include <thread>
 
 #include <cpptoml.h>
@@ -42,12 +43,31 @@ po::options_description FileReader::options() const
         ("video-file,f", po::value<std::string>(),
          "Path to video file to serve frames from.")
         ("fps,r", po::value<double>(),
-         "Frames to serve per second.")
+         "Frames to serve per second. Defaults to the video's frame rate.")
+        ("start", po::value<uint64_t>(),
+         "Index of the first frame to serve. Defaults to 0.")
+        ("num-frames,n", po::value<uint64_t>(),
+         "Number of frames to serve before exiting. Defaults to the rest of "
+         "the video.")
         ("roi", po::value<std::string>(),
          "Four element array of unsigned ints, [x0,y0,width,height],"
          "defining a rectangular region of interest. Origin"
          "is upper left corner. ROI must fit within acquired"
          "frame size. Defaults to full video size.")
+        ("decode-ahead", po::value<size_t>(),
+         "Number of frames to decode ahead of the one being served, on "
+         "separate threads, so that decoding overlaps with downstream "
+         "processing. 0 decodes each frame on the processing thread. "
+         "Defaults to 0.")
+        ("decoders", po::value<size_t>(),
+         "Number of decoder threads used with --decode-ahead. Each decoder "
+         "seeks to its own blocks of frames, so more than one only helps for "
+         "intra-only codecs such as MJPEG. Defaults to 1.")
+        ("sink-depth", po::value<size_t>(),
+         "Number of frames the SINK can write ahead of its slowest SOURCE. "
+         "Values greater than 1 allow jittery downstream components to "
+         "read without stalling acquisition at the cost of additional "
+         "shared memory. Defaults to 1.")
         ;
 
     return local_opts;
@@ -57,24 +77,45 @@ void FileReader::applyConfiguration(const po::variables_map &vm,
                                     const config::OptionTable &config_table)
 {
     // Video file
-    std::string file_name;
-    oat::config::getValue(vm, config_table, "video-file", file_name, true);
-    file_reader_.open(file_name);
+    oat::config::getValue(vm, config_table, "video-file", file_name_, true);
+    file_reader_.open(file_name_);
 
-    // Frame rate
-    if (oat::config::getNumericValue(vm, config_table, "fps", frames_per_second_, 0.0))
-        calculateFramePeriod();
+    // Frame rate. Defaults to the rate the video was recorded at, which
+    // also sets the sample period when serving offline.
+    if (!oat::config::getNumericValue(vm, config_table, "fps", frames_per_second_, 0.0)) {
+        frames_per_second_ = file_reader_.get(cv::CAP_PROP_FPS);
+        if (frames_per_second_ <= 0)
+            frames_per_second_ = 30.0;
+    }
+    calculateFramePeriod();
+
+    // Range of frames
+    oat::config::getNumericValue<uint64_t>(
+        vm, config_table, "start", start_frame_, 0);
+    const uint64_t total = frames_in_file();
+    if (total > 0 && start_frame_ >= total)
+        throw std::runtime_error("Start frame " + std::to_string(start_frame_)
+                                 + " is past the end of the video, which has "
+                                 + std::to_string(total) + " frames.");
+
+    oat::config::getNumericValue<uint64_t>(
+        vm, config_table, "num-frames", frames_left_, 1);
 
     // ROI
-    std::vector<size_t> roi;
-    if (oat::config::getArray<size_t, 4>(vm, config_table, "roi", roi)) {
-
-        use_roi_ = true;
-        region_of_interest_.x      = roi[0];
-        region_of_interest_.y      = roi[1];
-        region_of_interest_.width  = roi[2];
-        region_of_interest_.height = roi[3];
-    }
+    configureROI(vm, config_table);
+
+    // Decode-ahead
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "decode-ahead", decode_ahead_, 0);
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "decoders", num_decoders_, 1);
+    if (num_decoders_ > 1 && decode_ahead_ < num_decoders_)
+        throw std::runtime_error("decode-ahead must be at least the number "
+                                 "of decoders.");
+
+    // Frame ring depth
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "sink-depth", sink_depth_, 1, oat::Node::MAX_DEPTH);
 }
 
 bool FileReader::connectToNode()
@@ -86,16 +127,38 @@ bool FileReader::connectToNode()
         example_frame = example_frame(region_of_interest_);
 
     frame_sink_.bind(frame_sink_address_,
-            example_frame.total() * example_frame.elemSize());
+            example_frame.total() * example_frame.elemSize(),
+            sink_depth_);
 
     shared_frame_ = frame_sink_.retrieve(
             example_frame.rows, example_frame.cols, example_frame.type(), PIX_BGR);
 
-    // Reset the video to the start
-    file_reader_.set(cv::CAP_PROP_POS_AVI_RATIO, 0);
+    // Rewind to the first frame to serve
+    if (start_frame_ > 0)
+        file_reader_.set(cv::CAP_PROP_POS_FRAMES, start_frame_);
+    else
+        file_reader_.set(cv::CAP_PROP_POS_AVI_RATIO, 0);
 
     // Put the sample rate in the shared frame
-    shared_frame_.set_rate_hz(1.0 / frame_period_in_sec_.count());
+    shared_frame_->set_rate_hz(1.0 / frame_period_in_sec_.count());
+
+    // Frames that will be served, if known
+    uint64_t end = frames_left_;
+    const uint64_t total = frames_in_file();
+    if (total > start_frame_)
+        end = std::min<uint64_t>(end, total - start_frame_);
+
+    // Start decoding ahead into frames of the video's size
+    if (decode_ahead_ > 0) {
+
+        ring_.reset(decode_ahead_, 0, end);
+        for (size_t k = 0; k < ring_.size(); k++)
+            ring_.entry(k).frame.create(example_frame.rows,
+                                        example_frame.cols,
+                                        example_frame.type());
+
+        ring_.start(num_decoders_, [this](size_t k) { decode(k); });
+    }
 
     return true;
 }
@@ -103,8 +166,11 @@ bool FileReader::connectToNode()
 int FileReader::process()
 {
     cv::Mat frame;
-    if (!file_reader_.read(frame)) 
+    if (!nextFrame(frame)) {
+        if (oat::offline())
+            reportThroughput();
         return 1;
+    }
 
     if (use_roi_ )
         frame = frame(region_of_interest_);
@@ -115,8 +181,9 @@ int FileReader::process()
     // Wait for sources to read
     frame_sink_.wait();
 
-    frame.copyTo(shared_frame_);
-    shared_frame_.incrementSampleCount();
+    frame.copyTo(*shared_frame_);
+    shared_frame_->incrementSampleCount();
+    shared_frame_->set_capture_ns(Sample::now_ns());
 
     // Tell sources there is new data
     frame_sink_.post();
@@ -124,12 +191,88 @@ int FileReader::process()
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    std::this_thread::sleep_for(frame_period_in_sec_ - (clock_.now() - tick_));
-    tick_ = clock_.now();
+    releaseFrame();
+    countServed();
+
+    // Offline, serve as fast as downstream components can read
+    if (!oat::offline()) {
+        std::this_thread::sleep_for(frame_period_in_sec_ - (clock_.now() - tick_));
+        tick_ = clock_.now();
+    }
 
     return 0;
 }
 
+bool FileReader::nextFrame(cv::Mat &frame)
+{
+    if (decode_ahead_ == 0) {
+        if (frames_left_ == 0 || !file_reader_.read(frame))
+            return false;
+
+        frames_left_--;
+        return true;
+    }
+
+    const auto *d = ring_.next();
+    if (d == nullptr)
+        return false;
+
+    // A view of the ring entry. It is not reused until releaseFrame().
+    frame = d->frame;
+    return true;
+}
+
+void FileReader::releaseFrame()
+{
+    if (decode_ahead_ > 0)
+        ring_.release();
+}
+
+void FileReader::decode(const size_t decoder)
+{
+    // A single decoder reads straight through the video. Several decoders
+    // each take every num_decoders_'th block and seek to it.
+    const size_t n = num_decoders_;
+    const uint64_t block = n == 1 ? std::numeric_limits<uint64_t>::max()
+                                  : std::max<size_t>(1, ring_.size() / n);
+
+    cv::VideoCapture own;
+    cv::VideoCapture &cap = n == 1 ? file_reader_ : own;
+    if (n > 1)
+        own.open(file_name_);
+
+    for (uint64_t b = decoder; ; b += n) {
+
+        // Blocks past the end are caught before they are decoded
+        const uint64_t first = b * block;
+        if (n > 1)
+            cap.set(cv::CAP_PROP_POS_FRAMES, start_frame_ + first);
+
+        for (uint64_t i = first; i - first < block; i++) {
+
+            // Wait for the entry to be served
+            auto *d = ring_.waitFree(i);
+            if (d == nullptr)
+                return;
+
+            // End of the video, which may be before the container said it
+            // would be
+            if (!cap.read(d->frame)) {
+                ring_.truncate(i);
+                return;
+            }
+
+            ring_.ready(i);
+        }
+    }
+}
+
+uint64_t FileReader::frames_in_file() const
+{
+    const double n = file_reader_.get(cv::CAP_PROP_FRAME_COUNT);
+    return n > 0 ? static_cast<uint64_t>(n) : 0;
+}
+
 void FileReader::calculateFramePeriod()
 {
     // Copy assignment provides automatic unit conversion
@@ -26,6 +26,7 @@
 
 #include <opencv2/videoio.hpp>
 
+#include "DecodeRing.h"
 #include "FrameServer.h"
 
 namespace oat {
@@ -35,6 +36,17 @@ public:
 
     FileReader(const std::string &sink_name);
 
+    /**
+     * @brief Number of frames in the video, as reported by its container.
+     * Zero if unknown. Valid once configured.
+     */
+    uint64_t frames_in_file(void) const;
+
+    /**
+     * @brief Sample rate of served frames. Valid once configured.
+     */
+    double frames_per_second(void) const { return frames_per_second_; }
+
 private:
     // Component Interface
     bool connectToNode(void) override;
@@ -46,19 +58,39 @@ private:
                             const config::OptionTable &config_table) override;
 
     // Video file
+    std::string file_name_;
     cv::VideoCapture file_reader_;
 
     // Playback speed
-    double frames_per_second_;
+    double frames_per_second_ {30.0};
     void calculateFramePeriod(void);
 
-    // Region of interest
-    cv::Rect_<size_t> region_of_interest_;
+    // Range of frames to serve
+    uint64_t start_frame_ {0};
+    uint64_t frames_left_ {std::numeric_limits<uint64_t>::max()};
+
+    // Decode-ahead. Decoders fill the ring with blocks of consecutive
+    // frames of preallocated size. Frame indices are relative to
+    // start_frame_.
+    size_t decode_ahead_ {0};
+    size_t num_decoders_ {1};
+
+    // Executed by each decoder thread
+    void decode(const size_t decoder);
+
+    // Next frame, from the decode-ahead ring or decoded in place. False at
+    // the end of the video.
+    bool nextFrame(cv::Mat &frame);
+    void releaseFrame(void);
 
     // Frame generation clock
     std::chrono::high_resolution_clock clock_;
     std::chrono::duration<double> frame_period_in_sec_;
     std::chrono::high_resolution_clock::time_point tick_;
+
+    // Declared last so that decoders are joined before the members they
+    // use are destroyed
+    oat::DecodeRing ring_;
 };
 
 }       /* namespace oat */
@@ -19,7 +19,13 @@
 
 #include "FrameServer.h"
 
+#include <cstdio>
+#include <iostream>
 #include <string>
+#include <vector>
+
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
 
 namespace oat {
 
@@ -29,4 +35,43 @@ FrameServer::FrameServer(const std::string &frame_sink_address) :
 {
     // Nothing
 }
+
+void FrameServer::countServed()
+{
+    last_served_ = std::chrono::steady_clock::now();
+    if (served_++ == 0)
+        first_served_ = last_served_;
+}
+
+void FrameServer::reportThroughput() const
+{
+    const double sec
+        = std::chrono::duration<double>(last_served_ - first_served_).count();
+
+    // The first frame marks the start, so it is not part of the rate
+    char msg[128];
+    std::snprintf(msg, sizeof(msg),
+                  "Served %llu frames in %.3f s (%.1f frames/s).",
+                  static_cast<unsigned long long>(served_), sec,
+                  sec > 0 ? (served_ - 1) / sec : 0.0);
+
+    std::cout << oat::whoMessage(name_, msg) << std::endl;
+}
+
+bool FrameServer::configureROI(const po::variables_map &vm,
+                               const config::OptionTable &config_table)
+{
+    std::vector<size_t> roi;
+    if (!oat::config::getArray<size_t, 4>(vm, config_table, "roi", roi))
+        return false;
+
+    use_roi_ = true;
+    region_of_interest_.x      = roi[0];
+    region_of_interest_.y      = roi[1];
+    region_of_interest_.width  = roi[2];
+    region_of_interest_.height = roi[3];
+
+    return true;
+}
+
 } /* namespace oat */
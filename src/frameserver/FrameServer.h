@@ -20,6 +20,7 @@
 #ifndef OAT_FRAMESERVER_H
 #define	OAT_FRAMESERVER_H
 
+#include <chrono>
 #include <string>
 
 #include <boost/program_options.hpp>
@@ -48,6 +49,25 @@ public:
     std::string name(void) const override { return name_; }
 
 protected:
+    /**
+     * @brief Count a frame that has been posted, for the throughput report.
+     */
+    void countServed(void);
+
+    /**
+     * @brief Print how many frames were served and how fast. Used when
+     * reprocessing recorded data offline.
+     */
+    void reportThroughput(void) const;
+
+    /**
+     * @brief Read the region of interest from the roi option, a four
+     * element array, [x0,y0,width,height].
+     * @return True if a region of interest was given.
+     */
+    bool configureROI(const po::variables_map &vm,
+                      const config::OptionTable &config_table);
+
     // Component name
     std::string name_;
 
@@ -58,10 +78,16 @@ protected:
     // Frame sink
     const std::string frame_sink_address_;
     oat::Sink<oat::Frame> frame_sink_;
+    size_t sink_depth_ {1};
 
     // Currently acquired, shared frame
     //bool frame_empty_ {true};
-    oat::Frame shared_frame_;
+    oat::Frame * shared_frame_ {nullptr};
+
+private:
+    // Throughput
+    uint64_t served_ {0};
+    std::chrono::steady_clock::time_point first_served_, last_served_;
 };
 
 }       /* namespace oat */
@@ -0,0 +1,434 @@
+//******************************************************************************
+//* File:   ImageSequence.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <set>
+#include <thread>
+
+#include <fcntl.h>
+#include <glob.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+#include <cpptoml.h>
+#include <opencv2/imgcodecs.hpp>
+
+#include "../../lib/base/Globals.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+#include "ImageSequence.h"
+
+namespace bfs = boost::filesystem;
+
+namespace oat {
+
+namespace {
+
+// Compares runs of digits by value, so that img_2.png sorts before
+// img_10.png whether or not the numbers are zero padded
+bool naturalLess(const std::string &a, const std::string &b)
+{
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+
+        if (std::isdigit(a[i]) && std::isdigit(b[j])) {
+
+            while (i < a.size() - 1 && a[i] == '0' && std::isdigit(a[i + 1]))
+                i++;
+            while (j < b.size() - 1 && b[j] == '0' && std::isdigit(b[j + 1]))
+                j++;
+
+            size_t i1 = i, j1 = j;
+            while (i1 < a.size() && std::isdigit(a[i1]))
+                i1++;
+            while (j1 < b.size() && std::isdigit(b[j1]))
+                j1++;
+
+            if (i1 - i != j1 - j)
+                return i1 - i < j1 - j;
+
+            const int c = a.compare(i, i1 - i, b, j, j1 - j);
+            if (c != 0)
+                return c < 0;
+
+            i = i1;
+            j = j1;
+
+        } else {
+
+            if (a[i] != b[j])
+                return a[i] < b[j];
+            i++;
+            j++;
+        }
+    }
+
+    return a.size() - i < b.size() - j;
+}
+
+// Image formats found when a directory is given
+const std::set<std::string> image_extensions {
+    ".bmp", ".jp2", ".jpeg", ".jpg", ".pbm", ".pgm", ".png",
+    ".ppm", ".sr", ".ras", ".tif", ".tiff", ".webp"
+};
+
+} /* namespace */
+
+ImageSequence::ImageSequence(const std::string &sink_address)
+: FrameServer(sink_address)
+{
+    // Initialize time
+    tick_ = clock_.now();
+}
+
+po::options_description ImageSequence::options() const
+{
+    // Update CLI options
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("images,i", po::value<std::string>(),
+         "Directory of images, or a quoted glob pattern such as "
+         "'./run1/*.png', to serve frames from. Images are served in "
+         "file name order, with numbers in names compared by value.")
+        ("timestamps,t", po::value<std::string>(),
+         "Path to a text file holding the time, in seconds, at which each "
+         "image was captured, one per line. Blank lines and lines starting "
+         "with '#' are ignored. Served frames are stamped with these times, "
+         "relative to the first. Defaults to regularly spaced times.")
+        ("color,C", po::value<std::string>(),
+         "Pixel color format of served frames. Defaults to BGR.\n"
+         "Values:\n"
+         "  GREY: \t 8-bit Greyscale image.\n"
+         "  BGR: \t8-bit, 3-chanel, BGR Color image.\n")
+        ("fps,r", po::value<double>(),
+         "Frames to serve per second. Defaults to the mean rate of the "
+         "timestamps, if given, or 30.")
+        ("start", po::value<uint64_t>(),
+         "Index of the first image to serve. Defaults to 0.")
+        ("num-frames,n", po::value<uint64_t>(),
+         "Number of frames to serve before exiting. Defaults to the rest of "
+         "the images.")
+        ("roi", po::value<std::string>(),
+         "Four element array of unsigned ints, [x0,y0,width,height],"
+         "defining a rectangular region of interest. Origin"
+         "is upper left corner. ROI must fit within acquired"
+         "frame size. Defaults to full image size.")
+        ("decoders", po::value<size_t>(),
+         "Number of threads decoding images in parallel. Defaults to the "
+         "number of hardware threads.")
+        ("decode-ahead", po::value<size_t>(),
+         "Number of decoded frames that can be held ahead of the one being "
+         "served. Must be at least the number of decoders. Defaults to "
+         "twice the number of decoders.")
+        ("sink-depth", po::value<size_t>(),
+         "Number of frames the SINK can write ahead of its slowest SOURCE. "
+         "Values greater than 1 allow jittery downstream components to "
+         "catch up without stalling playback. Defaults to 1.")
+        ;
+
+    return local_opts;
+}
+
+void ImageSequence::applyConfiguration(const po::variables_map &vm,
+                                       const config::OptionTable &config_table)
+{
+    // Images
+    std::string images;
+    oat::config::getValue(vm, config_table, "images", images, true);
+    findImages(images);
+
+    // Timestamps
+    std::string timestamps;
+    if (oat::config::getValue(vm, config_table, "timestamps", timestamps))
+        readTimestamps(timestamps);
+
+    // Pixel color
+    std::string col;
+    if (oat::config::getValue<std::string>(vm, config_table, "color", col)) {
+        color_ = oat::str_color(col);
+        if (color_ != oat::PIX_GREY && color_ != oat::PIX_BGR)
+            throw std::runtime_error("color must be GREY or BGR.");
+    }
+
+    // Frame rate. Defaults to the rate the images were captured at.
+    if (!oat::config::getNumericValue(vm, config_table, "fps", frames_per_second_, 0.0)
+        && times_.size() > 1 && times_.back() > times_.front()) {
+        frames_per_second_ = 1e6 * (times_.size() - 1)
+                             / (times_.back() - times_.front()).count();
+    }
+    frame_period_in_sec_ = std::chrono::duration<double>(1.0 / frames_per_second_);
+
+    // Range of images
+    oat::config::getNumericValue<uint64_t>(vm, config_table, "start", first_, 0);
+    if (first_ >= paths_.size())
+        throw std::runtime_error("Start image " + std::to_string(first_)
+                                 + " is past the end of the sequence, which "
+                                 "has " + std::to_string(paths_.size())
+                                 + " images.");
+
+    uint64_t num_frames = paths_.size();
+    oat::config::getNumericValue<uint64_t>(
+        vm, config_table, "num-frames", num_frames, 1);
+    end_ = first_ + std::min<uint64_t>(num_frames, paths_.size() - first_);
+
+    // ROI
+    configureROI(vm, config_table);
+
+    // Decoder pool
+    num_decoders_ = std::max(1u, std::thread::hardware_concurrency());
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "decoders", num_decoders_, 1);
+
+    decode_ahead_ = 2 * num_decoders_;
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "decode-ahead", decode_ahead_, 1);
+    if (decode_ahead_ < num_decoders_)
+        throw std::runtime_error("decode-ahead must be at least the number "
+                                 "of decoders.");
+
+    // Frame ring depth
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "sink-depth", sink_depth_, 1, oat::Node::MAX_DEPTH);
+}
+
+bool ImageSequence::connectToNode()
+{
+    // The first image served sets the frame size
+    cv::Mat example_frame;
+    const auto error = decodeImage(paths_[first_], example_frame);
+    if (!error.empty())
+        throw std::runtime_error(error);
+
+    frame_size_ = example_frame.size();
+
+    if (use_roi_)
+        example_frame = example_frame(region_of_interest_);
+
+    frame_sink_.bind(frame_sink_address_,
+            example_frame.total() * example_frame.elemSize(),
+            sink_depth_);
+
+    shared_frame_ = frame_sink_.retrieve(example_frame.rows,
+                                         example_frame.cols,
+                                         example_frame.type(),
+                                         color_);
+
+    // Put the sample rate in the shared frame
+    shared_frame_->set_rate_hz(frames_per_second_);
+
+    // Start decoding ahead
+    ring_.reset(std::min<uint64_t>(decode_ahead_, end_ - first_), first_, end_);
+    ring_.start(std::min(num_decoders_, ring_.size()),
+                [this](size_t) { decode(); });
+
+    return true;
+}
+
+int ImageSequence::process()
+{
+    const auto *d = ring_.next();
+    if (d == nullptr) {
+        if (oat::offline())
+            reportThroughput();
+        return 1;
+    }
+
+    if (!d->error.empty())
+        throw std::runtime_error(d->error);
+
+    // A view of the ring entry. It is not reused until it is released below.
+    cv::Mat frame = d->frame;
+
+    if (use_roi_)
+        frame = frame(region_of_interest_);
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    frame_sink_.wait();
+
+    frame.copyTo(*shared_frame_);
+    if (times_.empty())
+        shared_frame_->incrementSampleCount();
+    else
+        shared_frame_->incrementSampleCount(times_[d->index]);
+    shared_frame_->set_capture_ns(Sample::now_ns());
+
+    // Tell sources there is new data
+    frame_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // Release the ring entry
+    ring_.release();
+
+    countServed();
+
+    // Offline, serve as fast as downstream components can read
+    if (!oat::offline()) {
+        std::this_thread::sleep_for(frame_period_in_sec_ - (clock_.now() - tick_));
+        tick_ = clock_.now();
+    }
+
+    return 0;
+}
+
+void ImageSequence::decode()
+{
+    // Claim the next image once its ring entry has been served. The entry
+    // belongs to this thread until it is marked ready.
+    uint64_t i;
+    while (auto *d = ring_.claim(i)) {
+
+        auto error = decodeImage(paths_[i], d->frame);
+        if (error.empty() && d->frame.size() != frame_size_)
+            error = paths_[i] + " is " + std::to_string(d->frame.cols) + "x"
+                    + std::to_string(d->frame.rows) + ", but the first image "
+                    "is " + std::to_string(frame_size_.width) + "x"
+                    + std::to_string(frame_size_.height) + ".";
+
+        ring_.ready(i, error);
+    }
+}
+
+std::string ImageSequence::decodeImage(const std::string &path,
+                                       cv::Mat &frame) const
+{
+    // Decode straight from the page cache rather than reading a copy
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return "Could not open " + path + ".";
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return "Could not read " + path + ".";
+    }
+
+    const size_t bytes = st.st_size;
+    void *data = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return "Could not map " + path + ".";
+
+    ::madvise(data, bytes, MADV_SEQUENTIAL);
+
+    const int flags
+        = color_ == oat::PIX_GREY ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+    frame = cv::imdecode(
+        cv::Mat(1, static_cast<int>(bytes), CV_8UC1, data), flags);
+
+    ::munmap(data, bytes);
+
+    if (frame.empty())
+        return "Could not decode " + path + ".";
+
+    return "";
+}
+
+void ImageSequence::findImages(const std::string &images)
+{
+    paths_.clear();
+
+    if (bfs::is_directory(images)) {
+
+        for (const auto &entry : bfs::directory_iterator(images)) {
+
+            if (!bfs::is_regular_file(entry.status()))
+                continue;
+
+            auto ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (image_extensions.count(ext))
+                paths_.push_back(entry.path().string());
+        }
+
+    } else {
+
+        glob_t matches;
+        if (::glob(images.c_str(), 0, nullptr, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; i++)
+                paths_.push_back(matches.gl_pathv[i]);
+        }
+        ::globfree(&matches);
+    }
+
+    if (paths_.empty())
+        throw std::runtime_error("No images found at " + images + ".");
+
+    std::sort(paths_.begin(), paths_.end());
+    std::stable_sort(paths_.begin(), paths_.end(), naturalLess);
+}
+
+void ImageSequence::readTimestamps(const std::string &file_name)
+{
+    std::ifstream file(file_name);
+    if (!file)
+        throw std::runtime_error("Could not open " + file_name + ".");
+
+    times_.clear();
+
+    std::string line;
+    size_t line_number = 0;
+    double first = 0, last = 0;
+    while (std::getline(file, line)) {
+
+        line_number++;
+
+        const auto start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+
+        double t;
+        try {
+            t = std::stod(line.substr(start));
+        } catch (const std::logic_error &) {
+            throw std::runtime_error(file_name + ", line "
+                                     + std::to_string(line_number)
+                                     + ": expected a time in seconds.");
+        }
+
+        if (times_.empty())
+            first = t;
+        else if (t < last)
+            throw std::runtime_error(file_name + ", line "
+                                     + std::to_string(line_number)
+                                     + ": times must not decrease.");
+        last = t;
+
+        times_.emplace_back(std::llround((t - first) * 1e6));
+    }
+
+    if (times_.size() != paths_.size())
+        throw std::runtime_error(file_name + " holds "
+                                 + std::to_string(times_.size())
+                                 + " times, but there are "
+                                 + std::to_string(paths_.size())
+                                 + " images.");
+}
+
+} /* namespace oat */
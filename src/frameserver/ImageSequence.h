@@ -0,0 +1,100 @@
+//******************************************************************************
+//* File:   ImageSequence.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_IMAGESEQUENCE_H
+#define	OAT_IMAGESEQUENCE_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+
+#include "DecodeRing.h"
+#include "FrameServer.h"
+
+namespace oat {
+
+/**
+ * Serves a folder of still images (PNG, TIFF, JPEG, ...) as a video. Images
+ * are memory mapped and decoded in parallel by a pool of decoder threads
+ * into a ring of frames, and are served in order.
+ */
+class ImageSequence : public FrameServer {
+public:
+
+    ImageSequence(const std::string &sink_name);
+
+    /**
+     * @brief Number of images found. Valid once configured.
+     */
+    uint64_t frames_in_sequence(void) const { return paths_.size(); }
+
+private:
+    // Component Interface
+    bool connectToNode(void) override;
+    int process(void) override;
+
+    // Configurable Interface
+    po::options_description options() const override;
+    void applyConfiguration(const po::variables_map &vm,
+                            const config::OptionTable &config_table) override;
+
+    // Images, in the order they are served
+    std::vector<std::string> paths_;
+    void findImages(const std::string &images);
+
+    // Optional sample time of each image
+    std::vector<Sample::Microseconds> times_;
+    void readTimestamps(const std::string &file_name);
+
+    // Decoded pixel color and size. Every image must match the first.
+    oat::PixelColor color_ {oat::PIX_BGR};
+    cv::Size frame_size_;
+
+    // Playback speed
+    double frames_per_second_ {30.0};
+
+    // Range of images to serve, as indices into paths_
+    uint64_t first_ {0}; //!< First image to serve
+    uint64_t end_ {0};   //!< First image that will not be served
+
+    // Decode-ahead. Each decoder claims the next image that has a free
+    // entry in the ring.
+    size_t decode_ahead_ {0};
+    size_t num_decoders_ {0};
+
+    // Executed by each decoder thread
+    void decode(void);
+
+    // Decode one image into frame. Returns an error message on failure.
+    std::string decodeImage(const std::string &path, cv::Mat &frame) const;
+
+    // Frame generation clock
+    std::chrono::high_resolution_clock clock_;
+    std::chrono::duration<double> frame_period_in_sec_;
+    std::chrono::high_resolution_clock::time_point tick_;
+
+    // Declared last so that decoders are joined before the members they
+    // use are destroyed
+    oat::DecodeRing ring_;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_IMAGESEQUENCE_H */
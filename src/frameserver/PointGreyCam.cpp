@@ -730,7 +730,8 @@ int PointGreyCam<T>::process()
         else
             shmem_image_->DeepCopy(&raw_image);
 
-        shared_frame_.incrementSampleCount(tick_);
+        shared_frame_->incrementSampleCount(tick_);
+        shared_frame_->set_capture_ns(oat::Sample::now_ns());
 
         // Tell sources there is new data
         frame_sink_.post();
@@ -1045,9 +1046,9 @@ bool PointGreyCam<pg::GigECamera>::connectToNode()
 
     shared_frame_ = frame_sink_.retrieve(
         rows, cols, std::get<CV_TYPE>(pix_map_.at(pix_col_)), pix_col_);
-    shared_frame_.set_rate_hz(frames_per_second_);
+    shared_frame_->set_rate_hz(frames_per_second_);
 
-    // Use the shared_frame_.data, which points to a block of shared memory as
+    // Use the shared_frame_->data, which points to a block of shared memory as
     // rbg_image's data buffer. When changes are made to shmem_image_, this is
     // automatically propagated into shmem and 'converted' into a cv::Mat
     // (although this 'conversion' is simply filling in appropriate header info,
@@ -1056,7 +1057,7 @@ bool PointGreyCam<pg::GigECamera>::connectToNode()
         = oat::make_unique<pg::Image>(rows,
                                       cols,
                                       stride,
-                                      shared_frame_.data,
+                                      shared_frame_->data,
                                       bytes,
                                       std::get<PG_TO>(pix_map_.at(pix_col_)));
     return true;
@@ -1229,15 +1230,15 @@ bool PointGreyCam<pg::Camera>::connectToNode()
     frame_sink_.bind(frame_sink_address_, bytes);
 
     shared_frame_ = frame_sink_.retrieve(rows, cols, std::get<CV_TYPE>(pix_map_.at(pix_col_)), pix_col_);
-    shared_frame_.set_rate_hz(frames_per_second_);
+    shared_frame_->set_rate_hz(frames_per_second_);
 
-    // Use the shared_frame_.data, which points to a block of shared memory as
+    // Use the shared_frame_->data, which points to a block of shared memory as
     // rbg_image's data buffer. When changes are made to shmem_image_, this is
     // automatically propagated into shmem and 'converted' into a cv::Mat
     // (although this 'conversion' is simply filling in appropriate header info,
     // which was accomplished in the call to frame_sink_.retrieve())
     shmem_image_ = oat::make_unique<pg::Image>
-            (rows, cols, stride, shared_frame_.data, bytes, std::get<PG_TO>(pix_map_.at(pix_col_)));
+            (rows, cols, stride, shared_frame_->data, bytes, std::get<PG_TO>(pix_map_.at(pix_col_)));
 
     return true;
 }
@@ -0,0 +1,189 @@
+//******************************************************************************
+//* File:   RawReader.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <thread>
+
+#include <cpptoml.h>
+
+#include "../../lib/base/Globals.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+#include "RawReader.h"
+
+namespace oat {
+
+RawReader::RawReader(const std::string &sink_address)
+: FrameServer(sink_address)
+{
+    tick_ = clock_.now();
+}
+
+po::options_description RawReader::options() const
+{
+    // Update CLI options
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("raw-file,f", po::value<std::string>(),
+         "Path to .oatraw file, written by 'oat record --raw', to serve "
+         "frames from.")
+        ("fps,r", po::value<double>(),
+         "Frames to serve per second. Defaults to the rate the frames were "
+         "recorded at.")
+        ("start", po::value<uint64_t>(),
+         "Sample number to start serving from. If it was not recorded, "
+         "starts from the next sample that was. Defaults to the first "
+         "recorded sample.")
+        ("num-frames,n", po::value<uint64_t>(),
+         "Number of frames to serve before exiting. Defaults to the rest of "
+         "the file.")
+        ("roi", po::value<std::string>(),
+         "Four element array of unsigned ints, [x0,y0,width,height],"
+         "defining a rectangular region of interest. Origin"
+         "is upper left corner. ROI must fit within acquired"
+         "frame size. Defaults to full frame size.")
+        ("sink-depth", po::value<size_t>(),
+         "Number of frames the SINK can write ahead of its slowest SOURCE. "
+         "Values greater than 1 allow jittery downstream components to "
+         "catch up without stalling playback. Defaults to 1.")
+        ;
+
+    return local_opts;
+}
+
+void RawReader::applyConfiguration(const po::variables_map &vm,
+                                   const config::OptionTable &config_table)
+{
+    // Raw file
+    std::string file_name;
+    oat::config::getValue(vm, config_table, "raw-file", file_name, true);
+    file_.open(file_name);
+
+    if (file_.frames() == 0)
+        throw std::runtime_error(file_name + " holds no frames.");
+
+    // Frame rate. Defaults to the rate the frames were recorded at.
+    if (!oat::config::getNumericValue(vm, config_table, "fps", frames_per_second_, 0.0)) {
+        frames_per_second_ = file_.header().rate_hz;
+        if (frames_per_second_ <= 0)
+            frames_per_second_ = 30.0;
+    }
+    frame_period_in_sec_ = std::chrono::duration<double>(1.0 / frames_per_second_);
+
+    // Range of frames. Seeking is by sample number, since samples dropped
+    // during recording leave gaps.
+    uint64_t start = 0;
+    if (oat::config::getNumericValue<uint64_t>(vm, config_table, "start", start, 0)) {
+        next_ = file_.find(start);
+        if (next_ == file_.frames())
+            throw std::runtime_error("Sample " + std::to_string(start)
+                                     + " is past the end of the file, which "
+                                     "ends at sample "
+                                     + std::to_string(file_.record(
+                                           file_.frames() - 1).count)
+                                     + ".");
+    }
+
+    uint64_t num_frames = file_.frames();
+    oat::config::getNumericValue<uint64_t>(
+        vm, config_table, "num-frames", num_frames, 1);
+    end_ = next_ + std::min(num_frames, file_.frames() - next_);
+
+    // ROI
+    configureROI(vm, config_table);
+
+    // Frame ring depth
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "sink-depth", sink_depth_, 1, oat::Node::MAX_DEPTH);
+}
+
+bool RawReader::connectToNode()
+{
+    const auto &h = file_.header();
+    cv::Mat example_frame(h.rows, h.cols, h.type);
+
+    if (use_roi_)
+        example_frame = example_frame(region_of_interest_);
+
+    frame_sink_.bind(frame_sink_address_,
+            example_frame.total() * example_frame.elemSize(),
+            sink_depth_);
+
+    shared_frame_ = frame_sink_.retrieve(example_frame.rows,
+                                         example_frame.cols,
+                                         example_frame.type(),
+                                         static_cast<oat::PixelColor>(h.color));
+
+    // Put the sample rate in the shared frame
+    shared_frame_->set_rate_hz(frames_per_second_);
+
+    file_.prefetch(next_, READ_AHEAD);
+
+    return true;
+}
+
+int RawReader::process()
+{
+    if (next_ == end_ || quit) {
+        if (oat::offline())
+            reportThroughput();
+        return 1;
+    }
+
+    // Frames are viewed in place, in the mapped file
+    const auto &h = file_.header();
+    const auto &record = file_.record(next_);
+    cv::Mat frame(h.rows, h.cols, h.type, const_cast<void *>(file_.pixels(next_)));
+
+    if (use_roi_)
+        frame = frame(region_of_interest_);
+
+    // Keep the page cache ahead of playback
+    file_.prefetch(next_ + READ_AHEAD, 1);
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    frame_sink_.wait();
+
+    frame.copyTo(*shared_frame_);
+    shared_frame_->incrementSampleCount(
+        Sample::Microseconds(record.microseconds));
+    shared_frame_->set_capture_ns(Sample::now_ns());
+
+    // Tell sources there is new data
+    frame_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    next_++;
+    countServed();
+
+    // Offline, serve as fast as downstream components can read
+    if (!oat::offline()) {
+        std::this_thread::sleep_for(frame_period_in_sec_ - (clock_.now() - tick_));
+        tick_ = clock_.now();
+    }
+
+    return 0;
+}
+
+} /* namespace oat */
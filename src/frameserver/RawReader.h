@@ -0,0 +1,78 @@
+//******************************************************************************
+//* File:   RawReader.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_RAWREADER_H
+#define	OAT_RAWREADER_H
+
+#include <chrono>
+#include <limits>
+#include <string>
+
+#include "../../lib/utility/RawFrameFile.h"
+
+#include "FrameServer.h"
+
+namespace oat {
+
+/**
+ * Serves frames recorded by oat record --raw. The file is memory mapped and
+ * each frame is copied from the page cache straight into the SINK, along
+ * with its recorded sample time.
+ */
+class RawReader : public FrameServer {
+public:
+
+    RawReader(const std::string &sink_name);
+
+    /**
+     * @brief Number of frames in the file. Valid once configured.
+     */
+    uint64_t frames_in_file(void) const { return file_.frames(); }
+
+private:
+    // Component Interface
+    bool connectToNode(void) override;
+    int process(void) override;
+
+    // Configurable Interface
+    po::options_description options() const override;
+    void applyConfiguration(const po::variables_map &vm,
+                            const config::OptionTable &config_table) override;
+
+    // Raw frame file
+    oat::RawFrameReader file_;
+
+    // Playback speed
+    double frames_per_second_ {30.0};
+
+    // Range of frames to serve, as indices into the file
+    uint64_t next_ {0};
+    uint64_t end_ {std::numeric_limits<uint64_t>::max()};
+
+    // Frames to read ahead of the one being served
+    static constexpr uint64_t READ_AHEAD {8};
+
+    // Frame generation clock
+    std::chrono::high_resolution_clock clock_;
+    std::chrono::duration<double> frame_period_in_sec_;
+    std::chrono::high_resolution_clock::time_point tick_;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_RAWREADER_H */
@@ -0,0 +1,306 @@
+//******************************************************************************
+//* File:   SyntheticFrame.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "SyntheticFrame.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include <cpptoml.h>
+#include <opencv2/imgproc.hpp>
+
+#include "../../lib/base/Globals.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+namespace oat {
+
+SyntheticFrame::SyntheticFrame(const std::string &sink_address)
+: FrameServer(sink_address)
+{
+    // Initialize time
+    tick_ = clock_.now();
+}
+
+po::options_description SyntheticFrame::options() const
+{
+    // Update CLI options
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("size", po::value<std::string>(),
+         "Two element array of unsigned ints, [width,height], specifying "
+         "the frame size. Defaults to [640,480].")
+        ("color,C", po::value<std::string>(),
+         "Pixel color format. Defaults to BGR.\n"
+         "Values:\n"
+         "  GREY: \t 8-bit Greyscale image. Blobs are white.\n"
+         "  BGR: \t8-bit, 3-chanel, BGR Color image. Blobs have evenly "
+         "spaced, fully saturated hues, starting with red.\n")
+        ("fps,r", po::value<double>(),
+         "Frames to serve per second. Defaults to 30.")
+        ("num-frames,n", po::value<uint64_t>(),
+         "Number of frames to serve before exiting.")
+        ("blobs", po::value<size_t>(),
+         "Number of blobs. Defaults to 1.")
+        ("radius", po::value<double>(),
+         "Blob radius in pixels. Defaults to 10.")
+        ("background", po::value<double>(),
+         "Grey level, 0 to 255, of the background. Defaults to 32.")
+        ("noise", po::value<double>(),
+         "Standard deviation, in grey levels, of Gaussian noise added to "
+         "each pixel of each frame. Defaults to 0.")
+        ("sigma-accel,a", po::value<double>(),
+         "Standard deviation of the normally-distributed random "
+         "accelerations of each blob, in pixels/s^2. Blobs bounce off the "
+         "frame edges. Defaults to 100.")
+        ("seed", po::value<uint64_t>(),
+         "Seed for blob motion and noise. Runs with the same seed and "
+         "options serve the same frames. Defaults to a random seed.")
+        ("truth-sinks,t", po::value<std::vector<std::string>>()->multitoken(),
+         "Names of POSITION SINKS to publish the true position of each "
+         "blob to, one per blob. Each position has the sample number of "
+         "the frame it was rendered in.")
+        ;
+
+    return local_opts;
+}
+
+void SyntheticFrame::applyConfiguration(const po::variables_map &vm,
+                                        const config::OptionTable &config_table)
+{
+    // Frame size
+    std::vector<size_t> size;
+    if (oat::config::getArray<size_t, 2>(vm, config_table, "size", size)) {
+        cols_ = size[0];
+        rows_ = size[1];
+    }
+
+    // Pixel color
+    std::string col;
+    if (oat::config::getValue<std::string>(vm, config_table, "color", col)) {
+        color_ = oat::str_color(col);
+        if (color_ != oat::PIX_GREY && color_ != oat::PIX_BGR)
+            throw std::runtime_error("color must be GREY or BGR.");
+    }
+
+    // Number of frames to serve
+    oat::config::getNumericValue<uint64_t>(
+        vm, config_table, "num-frames", num_samples_, 1);
+
+    // Frame rate
+    oat::config::getNumericValue(vm, config_table, "fps", frames_per_second_, 0.0);
+    frame_period_in_sec_
+        = std::chrono::duration<double>(1.0 / frames_per_second_);
+
+    // Scene
+    size_t num_blobs = 1;
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "blobs", num_blobs, 1);
+    oat::config::getNumericValue<double>(
+        vm, config_table, "radius", radius_, 0.5);
+    oat::config::getNumericValue<double>(
+        vm, config_table, "background", background_, 0.0, 255.0);
+    oat::config::getNumericValue<double>(
+        vm, config_table, "noise", noise_, 0.0);
+
+    if (2 * radius_ >= std::min(rows_, cols_))
+        throw std::runtime_error("Blobs do not fit in the frame.");
+
+    double sigma_accel;
+    if (oat::config::getNumericValue<double>(
+            vm, config_table, "sigma-accel", sigma_accel, 0.0))
+        accel_.param(std::normal_distribution<double>::param_type(0, sigma_accel));
+
+    // Seed
+    uint64_t seed = std::random_device{}();
+    oat::config::getNumericValue<uint64_t>(vm, config_table, "seed", seed);
+    generator_.seed(seed);
+    noise_generator_ = cv::RNG(seed);
+
+    // Ground truth SINKs
+    std::vector<std::string> truth;
+    if (vm.count("truth-sinks")) {
+        truth = vm["truth-sinks"].as<std::vector<std::string>>();
+        if (truth.size() != num_blobs)
+            throw std::runtime_error("One truth SINK is required per blob.");
+    }
+
+    // Blobs start at rest, anywhere in the frame
+    std::uniform_real_distribution<double> x(radius_, cols_ - radius_);
+    std::uniform_real_distribution<double> y(radius_, rows_ - radius_);
+
+    for (size_t i = 0; i < num_blobs; i++) {
+
+        auto b = std::unique_ptr<Blob>(new Blob);
+        b->x = x(generator_);
+        b->y = y(generator_);
+        b->vx = 0;
+        b->vy = 0;
+
+        if (color_ == oat::PIX_GREY) {
+            b->color = cv::Scalar::all(255);
+        } else {
+            const cv::Mat hsv(1, 1, CV_8UC3,
+                              cv::Scalar(180.0 * i / num_blobs, 255, 255));
+            cv::Mat bgr;
+            cv::cvtColor(hsv, bgr, cv::COLOR_HSV2BGR);
+            const auto &p = bgr.at<cv::Vec3b>(0, 0);
+            b->color = cv::Scalar(p[0], p[1], p[2]);
+        }
+
+        if (!truth.empty())
+            b->address = truth[i];
+
+        blobs_.push_back(std::move(b));
+    }
+}
+
+bool SyntheticFrame::connectToNode()
+{
+    const int type = oat::cv_type(color_);
+    frame_.create(rows_, cols_, type);
+    if (noise_ > 0)
+        noise_frame_.create(rows_, cols_, CV_MAKETYPE(CV_16S, CV_MAT_CN(type)));
+
+    frame_sink_.bind(frame_sink_address_,
+                     frame_.total() * frame_.elemSize());
+
+    shared_frame_ = frame_sink_.retrieve(rows_, cols_, type, color_);
+
+    // Put the sample rate in the shared frame
+    shared_frame_->set_rate_hz(frames_per_second_);
+
+    for (auto &b : blobs_) {
+        if (!b->address.empty()) {
+            b->sink.bind(b->address, b->address);
+            b->shared = b->sink.retrieve();
+        }
+    }
+
+    return true;
+}
+
+int SyntheticFrame::process()
+{
+    if (shared_frame_->sample_count() >= num_samples_ || quit) {
+        if (oat::offline())
+            reportThroughput();
+        return 1;
+    }
+
+    // Rendering is outside the critical section
+    for (auto &b : blobs_)
+        move(*b);
+    render();
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    frame_sink_.wait();
+
+    frame_.copyTo(*shared_frame_);
+    shared_frame_->incrementSampleCount();
+    shared_frame_->set_capture_ns(Sample::now_ns());
+    const auto sample = shared_frame_->sample();
+
+    // Tell sources there is new data
+    frame_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // Publish where the blobs really are
+    for (auto &b : blobs_) {
+
+        if (b->shared == nullptr)
+            continue;
+
+        b->sink.wait();
+
+        b->shared->set_sample(sample);
+        b->shared->position_valid = true;
+        b->shared->position = oat::Point2D(b->x, b->y);
+        b->shared->velocity_valid = true;
+        b->shared->velocity = oat::Velocity2D(b->vx, b->vy);
+
+        b->sink.post();
+    }
+
+    countServed();
+
+    // Offline, serve as fast as downstream components can read
+    if (!oat::offline()) {
+        std::this_thread::sleep_for(frame_period_in_sec_ - (clock_.now() - tick_));
+        tick_ = clock_.now();
+    }
+
+    return 0;
+}
+
+void SyntheticFrame::move(Blob &b)
+{
+    const double dt = frame_period_in_sec_.count();
+    const double ax = accel_(generator_);
+    const double ay = accel_(generator_);
+
+    b.x += b.vx * dt + 0.5 * ax * dt * dt;
+    b.y += b.vy * dt + 0.5 * ay * dt * dt;
+    b.vx += ax * dt;
+    b.vy += ay * dt;
+
+    // Bounce off the frame edges, so that motion stays smooth
+    auto bounce = [](double &p, double &v, const double lo, const double hi) {
+        if (p < lo) {
+            p = 2 * lo - p;
+            v = -v;
+        } else if (p > hi) {
+            p = 2 * hi - p;
+            v = -v;
+        }
+        p = std::min(std::max(p, lo), hi);
+    };
+
+    bounce(b.x, b.vx, radius_, cols_ - radius_);
+    bounce(b.y, b.vy, radius_, rows_ - radius_);
+}
+
+void SyntheticFrame::render()
+{
+    // Sub-pixel, anti-aliased blobs, so that their centroids are where the
+    // ground truth says
+    constexpr int SHIFT {4};
+    constexpr double SCALE {1 << SHIFT};
+
+    frame_.setTo(cv::Scalar::all(background_));
+
+    for (const auto &b : blobs_)
+        cv::circle(frame_,
+                   cv::Point(std::lround(b->x * SCALE), std::lround(b->y * SCALE)),
+                   std::lround(radius_ * SCALE),
+                   b->color, -1, cv::LINE_AA, SHIFT);
+
+    if (noise_ > 0) {
+        noise_generator_.fill(noise_frame_, cv::RNG::NORMAL, 0.0, noise_);
+        cv::add(frame_, noise_frame_, frame_, cv::noArray(), frame_.type());
+    }
+}
+
+} /* namespace oat */
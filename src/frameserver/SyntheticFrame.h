@@ -0,0 +1,111 @@
+//******************************************************************************
+//* File:   SyntheticFrame.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SYNTHETICFRAME_H
+#define	OAT_SYNTHETICFRAME_H
+
+#include "FrameServer.h"
+
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "../../lib/datatypes/Position2D.h"
+
+namespace oat {
+
+/**
+ * Serves rendered frames of blobs that move with random accelerations, like
+ * the positions of posigen rand2D, over a uniform, noisy background. The
+ * true position of each blob can be published alongside, so that the
+ * accuracy of detectors and filters can be measured as well as their speed.
+ */
+class SyntheticFrame : public FrameServer {
+public:
+    /**
+     * @brief Serve synthetic frames of moving blobs.
+     * @param sink_address frame sink address
+     */
+    explicit SyntheticFrame(const std::string &sink_address);
+
+private:
+    // Component Interface
+    bool connectToNode(void) override;
+    int process(void) override;
+
+    // Configurable Interface
+    po::options_description options() const override;
+    void applyConfiguration(const po::variables_map &vm,
+                            const config::OptionTable &config_table) override;
+
+    struct Blob {
+        double x, vx, y, vy;   //!< Pixels and pixels per second
+        cv::Scalar color;
+
+        // Ground truth SINK
+        std::string address;
+        oat::Sink<oat::Position2D> sink;
+        oat::Position2D * shared {nullptr};
+    };
+
+    // Advance a blob by one frame period
+    void move(Blob &blob);
+
+    // Draw all blobs into frame_
+    void render(void);
+
+    // Frame geometry and color
+    size_t rows_ {480};
+    size_t cols_ {640};
+    oat::PixelColor color_ {oat::PIX_BGR};
+
+    // Scene
+    std::vector<std::unique_ptr<Blob>> blobs_;
+    double radius_ {10.0};
+    double background_ {32.0};
+    double noise_ {0.0};
+
+    // Motion, seeded so that runs can be repeated
+    std::mt19937 generator_;
+    std::normal_distribution<double> accel_ {0.0, 100.0};
+    cv::RNG noise_generator_;
+
+    // Rendered frame and its noise
+    cv::Mat frame_;
+    cv::Mat noise_frame_;
+
+    // Frame speed
+    double frames_per_second_ {30.0};
+
+    // frame generation clock
+    std::chrono::high_resolution_clock clock_;
+    std::chrono::duration<double> frame_period_in_sec_;
+    std::chrono::high_resolution_clock::time_point tick_;
+
+    // Sample count specification
+    uint64_t num_samples_ {std::numeric_limits<uint64_t>::max()};
+};
+
+}       /* namespace oat */
+#endif	/* OAT_SYNTHETICFRAME_H */
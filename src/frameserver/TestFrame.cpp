@@ -92,17 +92,17 @@ bool TestFrame::connectToNode() {
             mat.rows, mat.cols, mat.type(), color_);
 
     // Static image, never changes
-    mat.copyTo(shared_frame_);
+    mat.copyTo(*shared_frame_);
 
     // Put the sample rate in the shared frame
-    shared_frame_.set_rate_hz(1.0 / frame_period_in_sec_.count());
+    shared_frame_->set_rate_hz(1.0 / frame_period_in_sec_.count());
 
     return true;
 }
 
 int TestFrame::process()
 {
-    if (shared_frame_.sample_count() < num_samples_) {
+    if (shared_frame_->sample_count() < num_samples_) {
 
         // START CRITICAL SECTION //
         ////////////////////////////
@@ -111,7 +111,8 @@ int TestFrame::process()
         frame_sink_.wait();
 
         // Zero frame copy
-        shared_frame_.incrementSampleCount();
+        shared_frame_->incrementSampleCount();
+        shared_frame_->set_capture_ns(Sample::now_ns());
 
         // Tell sources there is new data
         frame_sink_.post();
@@ -119,11 +120,20 @@ int TestFrame::process()
         ////////////////////////////
         //  END CRITICAL SECTION  //
 
-        std::this_thread::sleep_for(frame_period_in_sec_ - (clock_.now() - tick_));
-        tick_ = clock_.now();
+        countServed();
+
+        // Offline, serve as fast as downstream components can read
+        if (!oat::offline()) {
+            std::this_thread::sleep_for(frame_period_in_sec_ - (clock_.now() - tick_));
+            tick_ = clock_.now();
+        }
 
         return 0;
     }
+
+    if (oat::offline())
+        reportThroughput();
+
     return 1;
 }
 
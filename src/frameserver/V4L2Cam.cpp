@@ -0,0 +1,537 @@
+//******************************************************************************
+//* File:   V4L2Cam.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "V4L2Cam.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../lib/base/Globals.h"
+#include "../../lib/utility/Clock.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+namespace oat {
+
+namespace {
+
+struct PixelFormat {
+    const char *name;
+    uint32_t fourcc;
+};
+
+const PixelFormat PIXEL_FORMATS[] {
+    {"yuyv", V4L2_PIX_FMT_YUYV},
+    {"mjpeg", V4L2_PIX_FMT_MJPEG},
+    {"grey", V4L2_PIX_FMT_GREY},
+};
+
+// ioctl, retried if interrupted by a signal
+int xioctl(const int fd, const unsigned long request, void *arg)
+{
+    int rc;
+    do {
+        rc = ioctl(fd, request, arg);
+    } while (rc == -1 && errno == EINTR);
+
+    return rc;
+}
+
+std::runtime_error deviceError(const std::string &what)
+{
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+} /* namespace */
+
+V4L2Cam::V4L2Cam(const std::string &sink_address)
+: FrameServer(sink_address)
+{
+    // Nothing
+}
+
+V4L2Cam::~V4L2Cam()
+{
+    // Ignore error return values -- throwing exception unsafe in destructor
+    if (streaming_) {
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(fd_, VIDIOC_STREAMOFF, &type);
+    }
+
+    for (auto &b : buffers_)
+        munmap(b.start, b.length);
+
+    if (fd_ >= 0)
+        close(fd_);
+
+    if (dropped_ > 0)
+        std::cerr << oat::Warn(name_ + ": the driver dropped "
+                               + std::to_string(dropped_) + " frames.\n");
+}
+
+po::options_description V4L2Cam::options() const
+{
+    // Update CLI options
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("device,d", po::value<std::string>(),
+         "Path to the V4L2 device. Defaults to /dev/video0.")
+        ("format", po::value<std::string>(),
+         "Pixel format to capture in. Values:\n"
+         "  auto: \tDefault. The first of yuyv, mjpeg or grey that the device "
+         "supports, starting with grey when serving GREY frames.\n"
+         "  yuyv: \tUncompressed 4:2:2 YUV.\n"
+         "  mjpeg: \tMotion JPEG.\n"
+         "  grey: \t8-bit greyscale.")
+        ("size", po::value<std::string>(),
+         "Two element array of unsigned ints, [width,height], requesting a "
+         "capture size. The driver picks the nearest size it supports. "
+         "Defaults to the device's current size.")
+        ("fps,r", po::value<double>(),
+         "Frames to capture per second. The driver picks the nearest rate it "
+         "supports. Defaults to the device's current rate.")
+        ("color,C", po::value<std::string>(),
+         "Pixel color format of served frames. Defaults to BGR.\n"
+         "Values:\n"
+         "  GREY: \t 8-bit Greyscale image.\n"
+         "  BGR: \t8-bit, 3-chanel, BGR Color image.\n")
+        ("buffers", po::value<size_t>(),
+         "Number of driver buffers to capture into. More buffers let the "
+         "device keep capturing while frames wait to be served. Defaults to "
+         "4.")
+        ("roi", po::value<std::string>(),
+         "Four element array of unsigned ints, [x0,y0,width,height],"
+         "defining a rectangular region of interest. Origin"
+         "is upper left corner. ROI must fit within acquired"
+         "frame size. x0 and width must be even for yuyv. Defaults to full "
+         "sensor size.")
+        ("sink-depth", po::value<size_t>(),
+         "Number of frames the SINK can write ahead of its slowest SOURCE. "
+         "Values greater than 1 allow jittery downstream components to "
+         "read without stalling acquisition at the cost of additional "
+         "shared memory. Defaults to 1.")
+        ;
+
+    return local_opts;
+}
+
+void V4L2Cam::applyConfiguration(const po::variables_map &vm,
+                                 const config::OptionTable &config_table)
+{
+    // Device
+    oat::config::getValue(vm, config_table, "device", device_);
+
+    fd_ = open(device_.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd_ < 0)
+        throw deviceError("Could not open " + device_);
+
+    v4l2_capability cap;
+    std::memset(&cap, 0, sizeof(cap));
+    if (xioctl(fd_, VIDIOC_QUERYCAP, &cap) == -1)
+        throw deviceError(device_ + " is not a V4L2 device");
+
+    const uint32_t caps = cap.capabilities & V4L2_CAP_DEVICE_CAPS
+                        ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE))
+        throw std::runtime_error(device_ + " cannot capture video.");
+    if (!(caps & V4L2_CAP_STREAMING))
+        throw std::runtime_error(device_ + " does not support streaming I/O.");
+
+    // Pixel color
+    std::string col;
+    if (oat::config::getValue<std::string>(vm, config_table, "color", col)) {
+        color_ = oat::str_color(col);
+        if (color_ != oat::PIX_GREY && color_ != oat::PIX_BGR)
+            throw std::runtime_error("color must be GREY or BGR.");
+    }
+
+    // Capture format
+    std::string format {"auto"};
+    oat::config::getValue(vm, config_table, "format", format);
+
+    std::vector<size_t> size;
+    oat::config::getArray<size_t, 2>(vm, config_table, "size", size);
+
+    setFormat(format, size);
+
+    // Frame rate
+    double fps = 0;
+    oat::config::getNumericValue(vm, config_table, "fps", fps, 0.0);
+    setFrameRate(fps);
+
+    // ROI
+    if (configureROI(vm, config_table)) {
+
+        const auto &roi = region_of_interest_;
+        if (roi.x + roi.width > width_ || roi.y + roi.height > height_)
+            throw std::runtime_error("ROI does not fit within the "
+                                     + std::to_string(width_) + "x"
+                                     + std::to_string(height_)
+                                     + " capture size.");
+
+        // YUYV pixels come in pairs that share their chroma
+        if (fourcc_ == V4L2_PIX_FMT_YUYV && (roi.x % 2 || roi.width % 2))
+            throw std::runtime_error("ROI x0 and width must be even when "
+                                     "capturing yuyv.");
+    }
+
+    // Driver buffers
+    size_t count = 4;
+    oat::config::getNumericValue<size_t>(vm, config_table, "buffers", count, 2);
+    mapBuffers(count);
+
+    // Frame ring depth
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "sink-depth", sink_depth_, 1, oat::Node::MAX_DEPTH);
+}
+
+void V4L2Cam::setFormat(const std::string &format,
+                        const std::vector<size_t> &size)
+{
+    // Formats the device offers
+    std::vector<uint32_t> offered;
+    v4l2_fmtdesc desc;
+    std::memset(&desc, 0, sizeof(desc));
+    desc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    while (xioctl(fd_, VIDIOC_ENUM_FMT, &desc) == 0) {
+        offered.push_back(desc.pixelformat);
+        desc.index++;
+    }
+
+    auto isOffered = [&offered](const uint32_t f) {
+        return std::find(offered.begin(), offered.end(), f) != offered.end();
+    };
+
+    // Formats we would take, best first
+    std::vector<uint32_t> wanted;
+    if (format == "auto") {
+        if (color_ == oat::PIX_GREY)
+            wanted.push_back(V4L2_PIX_FMT_GREY);
+        for (const auto &f : PIXEL_FORMATS)
+            wanted.push_back(f.fourcc);
+    } else {
+        for (const auto &f : PIXEL_FORMATS)
+            if (format == f.name)
+                wanted.push_back(f.fourcc);
+        if (wanted.empty())
+            throw std::runtime_error("Unrecognized format '" + format
+                                     + "'. Use auto, yuyv, mjpeg or grey.");
+    }
+
+    fourcc_ = 0;
+    for (const auto f : wanted) {
+        if (isOffered(f)) {
+            fourcc_ = f;
+            break;
+        }
+    }
+
+    if (fourcc_ == 0)
+        throw std::runtime_error(device_ + " does not offer "
+                                 + (format == "auto" ? "yuyv, mjpeg or grey"
+                                                     : format)
+                                 + " frames.");
+
+    // Start from the current format so that the size is kept unless one
+    // was requested
+    v4l2_format fmt;
+    std::memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd_, VIDIOC_G_FMT, &fmt) == -1)
+        throw deviceError("Could not get the format of " + device_);
+
+    fmt.fmt.pix.pixelformat = fourcc_;
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (!size.empty()) {
+        fmt.fmt.pix.width = size[0];
+        fmt.fmt.pix.height = size[1];
+    }
+
+    if (xioctl(fd_, VIDIOC_S_FMT, &fmt) == -1)
+        throw deviceError("Could not set the format of " + device_);
+
+    if (fmt.fmt.pix.pixelformat != fourcc_)
+        throw std::runtime_error(device_ + " did not accept the requested "
+                                 "pixel format.");
+
+    width_ = fmt.fmt.pix.width;
+    height_ = fmt.fmt.pix.height;
+    bytes_per_line_ = fmt.fmt.pix.bytesperline;
+
+    if (!size.empty() && (width_ != size[0] || height_ != size[1]))
+        std::cerr << oat::Warn("Capturing at " + std::to_string(width_) + "x"
+                               + std::to_string(height_)
+                               + ", the nearest size " + device_
+                               + " supports.\n");
+}
+
+void V4L2Cam::setFrameRate(const double fps)
+{
+    v4l2_streamparm parm;
+    std::memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    const bool have_parm = xioctl(fd_, VIDIOC_G_PARM, &parm) == 0;
+    const bool settable = have_parm
+        && (parm.parm.capture.capability & V4L2_CAP_TIMEPERFRAME);
+
+    if (fps > 0) {
+        if (settable) {
+            parm.parm.capture.timeperframe.numerator = 1000;
+            parm.parm.capture.timeperframe.denominator
+                = static_cast<uint32_t>(std::lround(fps * 1000));
+            if (xioctl(fd_, VIDIOC_S_PARM, &parm) == -1)
+                throw deviceError("Could not set the frame rate of " + device_);
+        } else {
+            std::cerr << oat::Warn(device_ + " does not support setting its "
+                                   "frame rate.\n");
+        }
+    }
+
+    const auto &tpf = parm.parm.capture.timeperframe;
+    if (have_parm && tpf.numerator > 0 && tpf.denominator > 0)
+        fps_ = static_cast<double>(tpf.denominator) / tpf.numerator;
+    else
+        fps_ = fps > 0 ? fps : 30.0;
+}
+
+void V4L2Cam::mapBuffers(const size_t count)
+{
+    v4l2_requestbuffers req;
+    std::memset(&req, 0, sizeof(req));
+    req.count = count;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if (xioctl(fd_, VIDIOC_REQBUFS, &req) == -1)
+        throw deviceError("Could not allocate buffers on " + device_);
+
+    if (req.count < 2)
+        throw std::runtime_error("Not enough buffer memory on " + device_);
+
+    for (uint32_t i = 0; i < req.count; i++) {
+
+        v4l2_buffer buf;
+        std::memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if (xioctl(fd_, VIDIOC_QUERYBUF, &buf) == -1)
+            throw deviceError("Could not query buffer on " + device_);
+
+        void *start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd_, buf.m.offset);
+        if (start == MAP_FAILED)
+            throw deviceError("Could not map buffer on " + device_);
+
+        buffers_.push_back({start, buf.length});
+    }
+}
+
+bool V4L2Cam::connectToNode()
+{
+    const int rows = use_roi_ ? region_of_interest_.height : height_;
+    const int cols = use_roi_ ? region_of_interest_.width : width_;
+
+    frame_sink_.bind(frame_sink_address_,
+                     rows * cols * oat::color_bytes(color_),
+                     sink_depth_);
+
+    shared_frame_ = frame_sink_.retrieve(
+        rows, cols, oat::cv_type(color_), color_);
+
+    // Put the sample rate in the shared frame
+    shared_frame_->set_rate_hz(fps_);
+
+    // Hand all buffers to the driver and start capturing
+    for (size_t i = 0; i < buffers_.size(); i++) {
+
+        v4l2_buffer buf;
+        std::memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if (xioctl(fd_, VIDIOC_QBUF, &buf) == -1)
+            throw deviceError("Could not queue buffer on " + device_);
+    }
+
+    int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd_, VIDIOC_STREAMON, &type) == -1)
+        throw deviceError("Could not start streaming from " + device_);
+    streaming_ = true;
+
+    return true;
+}
+
+int V4L2Cam::process()
+{
+    // Wait for a frame, checking for quit now and then
+    pollfd pfd {fd_, POLLIN, 0};
+    int rc = 0;
+    while (rc == 0 && !quit) {
+        rc = poll(&pfd, 1, 100);
+        if (rc == -1 && errno == EINTR)
+            rc = 0;
+    }
+
+    if (quit)
+        return 1;
+
+    if (rc == -1)
+        throw deviceError("Could not wait for a frame from " + device_);
+
+    v4l2_buffer buf;
+    std::memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+
+    if (xioctl(fd_, VIDIOC_DQBUF, &buf) == -1) {
+        if (errno == EAGAIN)
+            return 0;
+        throw deviceError("Could not dequeue a frame from " + device_);
+    }
+
+    // Frames the driver had to drop because all buffers were full
+    const int64_t sequence = buf.sequence;
+    if (last_sequence_ >= 0 && sequence > last_sequence_ + 1)
+        dropped_ += sequence - last_sequence_ - 1;
+    last_sequence_ = sequence;
+
+    const void *data = buffers_[buf.index].start;
+
+    // Decoding is expensive, so do it outside the critical section. A
+    // corrupt frame is handed back to the driver and skipped.
+    const bool ok = buf.flags & V4L2_BUF_FLAG_ERROR
+                  ? false : decode(data, buf.bytesused);
+
+    if (ok) {
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        // Wait for sources to read
+        frame_sink_.wait();
+
+        // Pure SINKs increment sample count and stamp the capture time
+        const uint64_t captured = captureTime(buf);
+        const auto &clock = SharedClock::instance();
+        shared_frame_->incrementSampleCount(Sample::Microseconds(
+            static_cast<int64_t>(captured - clock.start_ns()) / 1000));
+        shared_frame_->set_capture_ns(captured);
+
+        // Uncompressed frames are converted from the driver's buffer
+        // straight into shared memory
+        convert(data);
+
+        // Tell sources there is new data
+        frame_sink_.post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
+    // Give the buffer back to the driver
+    if (xioctl(fd_, VIDIOC_QBUF, &buf) == -1)
+        throw deviceError("Could not queue buffer on " + device_);
+
+    return 0;
+}
+
+bool V4L2Cam::decode(const void *data, const size_t bytes)
+{
+    if (fourcc_ != V4L2_PIX_FMT_MJPEG)
+        return true;
+
+    const cv::Mat jpeg(1, bytes, CV_8UC1, const_cast<void *>(data));
+    cv::imdecode(jpeg, oat::imread_code(color_), &decoded_);
+
+    return decoded_.rows == static_cast<int>(height_)
+           && decoded_.cols == static_cast<int>(width_);
+}
+
+void V4L2Cam::convert(const void *data)
+{
+    void *src = const_cast<void *>(data);
+
+    cv::Mat frame;
+    int code = -1;
+
+    switch (fourcc_) {
+        case V4L2_PIX_FMT_YUYV:
+            frame = cv::Mat(height_, width_, CV_8UC2, src, bytes_per_line_);
+            code = color_ == oat::PIX_GREY ? cv::COLOR_YUV2GRAY_YUYV
+                                           : cv::COLOR_YUV2BGR_YUYV;
+            break;
+        case V4L2_PIX_FMT_GREY:
+            frame = cv::Mat(height_, width_, CV_8UC1, src, bytes_per_line_);
+            if (color_ == oat::PIX_BGR)
+                code = cv::COLOR_GRAY2BGR;
+            break;
+        case V4L2_PIX_FMT_MJPEG:
+            frame = decoded_;
+            break;
+    }
+
+    if (use_roi_)
+        frame = frame(region_of_interest_);
+
+    // The shared frame already has the right size and type, so neither
+    // reallocates it
+    if (code == -1)
+        frame.copyTo(*shared_frame_);
+    else
+        cv::cvtColor(frame, *shared_frame_, code);
+}
+
+uint64_t V4L2Cam::captureTime(const v4l2_buffer &buf) const
+{
+    // Without a monotonic driver timestamp, the best we can do is now
+    if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK)
+            != V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+        return Sample::now_ns();
+
+    // The driver stamps CLOCK_MONOTONIC. Carry the frame's age over to the
+    // pipeline's clock.
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    const int64_t mono_now = static_cast<int64_t>(ts.tv_sec) * 1000000000
+                           + ts.tv_nsec;
+    const int64_t captured = static_cast<int64_t>(buf.timestamp.tv_sec)
+                           * 1000000000 + buf.timestamp.tv_usec * 1000;
+
+    return static_cast<uint64_t>(
+        static_cast<int64_t>(Sample::now_ns()) - (mono_now - captured));
+}
+
+} /* namespace oat */
@@ -0,0 +1,110 @@
+//******************************************************************************
+//* File:   V4L2Cam.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_V4L2CAM_H
+#define OAT_V4L2CAM_H
+
+#include "FrameServer.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <linux/videodev2.h>
+
+#include <opencv2/core/mat.hpp>
+
+namespace oat {
+
+/**
+ * Serves frames from a Video4Linux2 device using mmap streaming I/O. Frames
+ * are dequeued from the driver's buffers and converted straight into the
+ * SINK's shared frame, and are stamped with the time the driver captured
+ * them.
+ */
+class V4L2Cam : public FrameServer {
+public:
+    /**
+     * @brief Serve frames from a V4L2 device.
+     * @param sink_address frame sink address
+     */
+    explicit V4L2Cam(const std::string &sink_address);
+    ~V4L2Cam();
+
+private:
+    // Component Interface
+    bool connectToNode(void) override;
+    int process(void) override;
+
+    // Configurable Interface
+    po::options_description options() const override;
+    void applyConfiguration(const po::variables_map &vm,
+                            const config::OptionTable &config_table) override;
+
+    // Negotiate the capture format with the driver
+    void setFormat(const std::string &format,
+                   const std::vector<size_t> &size);
+    void setFrameRate(const double fps);
+
+    // Allocate and map the driver's buffers
+    void mapBuffers(const size_t count);
+
+    // Decode a compressed buffer outside the critical section. False if it
+    // is corrupt.
+    bool decode(const void *data, const size_t bytes);
+
+    // Convert a captured buffer, or the decoded frame, into the shared frame
+    void convert(const void *data);
+
+    // Capture time of a buffer on the pipeline's shared clock, see
+    // Sample::now_ns()
+    uint64_t captureTime(const struct v4l2_buffer &buf) const;
+
+    // Device
+    std::string device_ {"/dev/video0"};
+    int fd_ {-1};
+    bool streaming_ {false};
+
+    // Negotiated capture format
+    uint32_t fourcc_ {0};
+    size_t width_ {0};
+    size_t height_ {0};
+    size_t bytes_per_line_ {0};
+    double fps_ {0};
+
+    // Served pixel color
+    oat::PixelColor color_ {oat::PIX_BGR};
+
+    // Driver buffers, mapped into our address space
+    struct Buffer {
+        void *start;
+        size_t length;
+    };
+    std::vector<Buffer> buffers_;
+
+    // Decoded MJPEG frame
+    cv::Mat decoded_;
+
+    // Driver frame sequence numbers, to count frames it dropped
+    int64_t last_sequence_ {-1};
+    uint64_t dropped_ {0};
+};
+
+}      /* namespace oat */
+#endif /* OAT_V4L2CAM_H */
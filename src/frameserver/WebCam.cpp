@@ -50,6 +50,11 @@ po::options_description WebCam::options() const
          "defining a rectangular region of interest. Origin"
          "is upper left corner. ROI must fit within acquired"
          "mat size. Defaults to full sensor size.")
+        ("sink-depth", po::value<size_t>(),
+         "Number of frames the SINK can write ahead of its slowest SOURCE. "
+         "Values greater than 1 allow jittery downstream components to "
+         "read without stalling acquisition at the cost of additional "
+         "shared memory. Defaults to 1.")
         ;
 
     return local_opts; 
@@ -76,14 +81,11 @@ void WebCam::applyConfiguration(const po::variables_map &vm,
     }
 
     // ROI
-    std::vector<size_t> roi;
-    if (oat::config::getArray<size_t, 4>(vm, config_table, "roi", roi)) {
-        use_roi_ = true;
-        region_of_interest_.x      = roi[0];
-        region_of_interest_.y      = roi[1];
-        region_of_interest_.width  = roi[2];
-        region_of_interest_.height = roi[3];
-    }
+    configureROI(vm, config_table);
+
+    // Frame ring depth
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "sink-depth", sink_depth_, 1, oat::Node::MAX_DEPTH);
 }
 
 bool WebCam::connectToNode()
@@ -95,13 +97,14 @@ bool WebCam::connectToNode()
         example_frame = example_frame(region_of_interest_);
 
     frame_sink_.bind(frame_sink_address_,
-                     example_frame.total() * oat::color_bytes(oat::PIX_BGR));
+                     example_frame.total() * oat::color_bytes(oat::PIX_BGR),
+                     sink_depth_);
 
     shared_frame_ = frame_sink_.retrieve(
         example_frame.rows, example_frame.cols, example_frame.type(), oat::PIX_BGR);
 
     // Put the sample rate in the shared mat
-    shared_frame_.set_rate_hz(cv_camera_->get(cv::CAP_PROP_FPS));
+    shared_frame_->set_rate_hz(cv_camera_->get(cv::CAP_PROP_FPS));
 
     return true;
 }
@@ -117,9 +120,6 @@ int WebCam::process()
     if (use_roi_ )
         mat = mat(region_of_interest_);
 
-    if (first_frame_) 
-        start_ = clock_.now();
-
     // START CRITICAL SECTION //
     ////////////////////////////
     
@@ -128,17 +128,11 @@ int WebCam::process()
 
     // Pure SINKs increment sample count
     // NOTE: webcams have poorly controlled sample period, so it must be
-    // calculated. This operation is very inexpensive
-    if (first_frame_) {
-        first_frame_ = false; 
-    } else {
-        auto time_since_start
-            = std::chrono::duration_cast<Sample::Microseconds>(clock_.now()
-                                                               - start_);
-        shared_frame_.incrementSampleCount(time_since_start);
-    }
+    // measured. This operation is very inexpensive
+    shared_frame_->incrementSampleCount(Sample::since_start());
+    shared_frame_->set_capture_ns(Sample::now_ns());
 
-    mat.copyTo(shared_frame_);
+    mat.copyTo(*shared_frame_);
 
     // Tell sources there is new data
     frame_sink_.post();
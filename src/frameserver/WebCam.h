@@ -49,11 +49,6 @@ private:
 
     int index_ {0};
     std::unique_ptr<cv::VideoCapture> cv_camera_;
-
-    // frame generation clock
-    bool first_frame_ {true};
-    std::chrono::steady_clock clock_;
-    std::chrono::steady_clock::time_point start_;
 };
 
 }      /* namespace oat */
@@ -34,6 +34,10 @@
 
 #include "TestFrame.h"
 #include "FileReader.h"
+#include "ImageSequence.h"
+#include "RawReader.h"
+#include "SyntheticFrame.h"
+#include "V4L2Cam.h"
 #include "WebCam.h"
 #ifdef USE_FLYCAP
  #include "FlyCapture2.h"
@@ -48,10 +52,14 @@ namespace po = boost::program_options;
 const char usage_type[] =
     "TYPE\n"
     "  wcam: Onboard or USB webcam.\n"
+    "  v4l2: Video4Linux2 device, captured without OpenCV.\n"
     "  usb: Point Grey USB camera.\n"
     "  gige: Point Grey GigE camera.\n"
     "  file: Video from file (*.mpg, *.avi, etc.).\n"
-    "  test: Write-free static image server for performance testing.";
+    "  raw: Raw frames from file (*.oatraw), written by oat record --raw.\n"
+    "  images: Folder of images (*.png, *.tif, *.jpg, etc.).\n"
+    "  test: Write-free static image server for performance testing.\n"
+    "  synth: Moving blobs with ground truth positions for benchmarks.";
 
 const char usage_io[] =
     "SINK:\n"
@@ -98,6 +106,10 @@ int main(int argc, char *argv[])
     type_hash["file"] = 'c';
     type_hash["test"] = 'd';
     type_hash["usb"] = 'e';
+    type_hash["raw"] = 'f';
+    type_hash["v4l2"] = 'g';
+    type_hash["synth"] = 'h';
+    type_hash["images"] = 'i';
 
     // The component itself
     std::string comp_name = "frameserve";
@@ -196,6 +208,26 @@ int main(int argc, char *argv[])
 #endif
                     break;
                 }
+                case 'f':
+                {
+                    server = std::make_shared<oat::RawReader>(sink);
+                    break;
+                }
+                case 'g':
+                {
+                    server = std::make_shared<oat::V4L2Cam>(sink);
+                    break;
+                }
+                case 'h':
+                {
+                    server = std::make_shared<oat::SyntheticFrame>(sink);
+                    break;
+                }
+                case 'i':
+                {
+                    server = std::make_shared<oat::ImageSequence>(sink);
+                    break;
+                }
                 default:
                 {
                     printUsage(visible_options, "");
@@ -32,7 +32,10 @@ namespace oat {
 po::options_description MeanPosition::options() const
 {
     // Update CLI options
-    po::options_description local_opts;
+    // Start with base options
+    po::options_description local_opts(baseOptions());
+
+    // Add local options
     local_opts.add_options()
         ("heading-anchor,h", po::value<int>(),
          "Index of the SOURCE position to use as an anchor when calculating "
@@ -51,6 +54,9 @@ void MeanPosition::applyConfiguration(const po::variables_map &vm,
     // TODO: Code smell -- this is required to get a source and sink list
     PositionCombiner::resolvePositionSources(vm);
 
+    // Batch mode
+    oat::config::getValue<bool>(vm, config_table, "batch", batch_);
+
     // Adaptation coefficient
     generate_heading_ = oat::config::getNumericValue<int>(
         vm, config_table, "heading-anchor", heading_anchor_idx_, 0, num_sources() - 1
@@ -19,6 +19,7 @@
 
 #include "PositionCombiner.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -34,6 +35,22 @@
 
 namespace oat {
 
+po::options_description PositionCombiner::baseOptions(void) const
+{
+    po::options_description base_opts;
+
+    // Common program options
+    base_opts.add_options()
+        ("batch",
+         "If set, SOURCES and SINK carry batches of positions (e.g. from 'oat "
+         "posigen --batch-size') instead of single positions. Positions at the "
+         "same index in each SOURCE batch are combined. SOURCE batches must "
+         "be the same size.")
+        ;
+
+    return base_opts;
+}
+
 void PositionCombiner::resolvePositionSources(const po::variables_map &vm)
 {
     // Pull the sources and sink out as positional options
@@ -58,14 +75,45 @@ void PositionCombiner::resolvePositionSources(const po::variables_map &vm)
                 oat::make_unique<oat::Source< oat::Position2D>>()
             )
         );
+
+        // Only connected in batch mode
+        batches_.emplace_back(addr);
+        batch_sources_.push_back(
+            oat::NamedSource<oat::PositionBatch>(
+                addr,
+                oat::make_unique<oat::Source<oat::PositionBatch>>()
+            )
+        );
     }
 }
 
 bool PositionCombiner::connectToNode()
 {
+    if (batch_) {
+
+        for (auto &bs : batch_sources_) {
+            bs.source->touch(bs.name);
+            source_set_.add(*bs.source);
+        }
+
+        // Batches carry their own sample periods, which may not be known
+        // until the first write, so they are not compared here
+        for (auto &bs : batch_sources_) {
+            if (bs.source->connect() != SourceState::CONNECTED)
+                return false;
+        }
+
+        batch_sink_.bind(position_sink_address_, position_sink_address_);
+        shared_batch_ = batch_sink_.retrieve();
+
+        return true;
+    }
+
     // Establish our slot in each node
-    for (auto &ps : position_sources_)
+    for (auto &ps : position_sources_) {
         ps.source->touch(ps.name);
+        source_set_.add(*ps.source);
+    }
 
     // Examine sample period of sources to make sure they are the same
     double sample_rate_hz;
@@ -90,22 +138,39 @@ bool PositionCombiner::connectToNode()
 
 int PositionCombiner::process()
 {
-    for (pvec_size_t i = 0; i != position_sources_.size(); i++) {
+    if (batch_)
+        return processBatch();
+
+    uint64_t enter_ns = 0;
+
+    // Read each source once, in the order in which they are written
+    do {
 
         // START CRITICAL SECTION //
         ////////////////////////////
-        if (position_sources_[i].source->wait() == oat::NodeState::END)
+        if (source_set_.wait() == oat::NodeState::END)
             return 1;
 
-        positions_[i] = position_sources_[i].source->clone();
+        // Time from the first source to arrive
+        if (enter_ns == 0)
+            enter_ns = oat::Sample::now_ns();
 
-        position_sources_[i].source->post();
+        for (const auto i : source_set_.ready()) {
+            positions_[i] = position_sources_[i].source->clone();
+            if (i == 0)
+                position_sources_[i].source->trace(trace_);
+            position_sources_[i].source->post();
+        }
         ////////////////////////////
         //  END CRITICAL SECTION  //
-    }
+
+    } while (source_set_.pending() > 0);
 
     combine(positions_, internal_position_);
 
+    // Sample info and latency trace follow the first source
+    internal_position_.set_sample(positions_[0].sample());
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
@@ -113,6 +178,7 @@ int PositionCombiner::process()
     position_sink_.wait();
 
     *shared_position_ = internal_position_;
+    position_sink_.trace(trace_, name_, enter_ns);
 
     // Tell sources there is new data
     position_sink_.post();
@@ -124,4 +190,78 @@ int PositionCombiner::process()
     return 0;
 }
 
+int PositionCombiner::processBatch()
+{
+    uint64_t enter_ns = 0;
+
+    // Read each source once, in the order in which they are written
+    do {
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+        if (source_set_.wait() == oat::NodeState::END)
+            return 1;
+
+        // Time from the first source to arrive
+        if (enter_ns == 0)
+            enter_ns = oat::Sample::now_ns();
+
+        for (const auto i : source_set_.ready()) {
+            batches_[i] = *batch_sources_[i].source->retrieve();
+            if (i == 0)
+                batch_sources_[i].source->trace(trace_);
+            batch_sources_[i].source->post();
+        }
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+
+    } while (source_set_.pending() > 0);
+
+    combine(batches_, internal_batch_);
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    batch_sink_.wait();
+
+    *shared_batch_ = internal_batch_;
+    batch_sink_.trace(trace_, name_, enter_ns);
+
+    // Tell sources there is new data
+    batch_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // Sink was not at END state
+    return 0;
+}
+
+void PositionCombiner::combine(const std::vector<oat::PositionBatch> &source_batches,
+                               oat::PositionBatch &combined_batch)
+{
+    const size_t n = source_batches[0].size();
+    for (const auto &b : source_batches) {
+        if (b.size() != n)
+            throw std::runtime_error("Batches of different sizes, "
+                                     + std::to_string(n) + " and "
+                                     + std::to_string(b.size())
+                                     + ", cannot be combined.");
+    }
+
+    combined_batch.clear();
+    for (size_t i = 0; i < n; i++) {
+
+        for (pvec_size_t j = 0; j != source_batches.size(); j++)
+            positions_[j] = source_batches[j][i];
+
+        combine(positions_, internal_position_);
+
+        // Sample info follows the first source
+        internal_position_.set_sample(source_batches[0][i].sample());
+        combined_batch.push_back(internal_position_);
+    }
+}
+
 } /* namespace oat */
@@ -30,9 +30,11 @@
 #include "../../lib/base/Component.h"
 #include "../../lib/base/Configurable.h"
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionBatch.h"
 #include "../../lib/shmemdf/Helpers.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/Source.h"
+#include "../../lib/shmemdf/SourceSet.h"
 
 namespace po = boost::program_options;
 
@@ -67,16 +69,38 @@ protected:
     virtual void combine(const std::vector<oat::Position2D> &source_positions,
                          oat::Position2D &combined_position) = 0;
 
+    /**
+     * Perform position combination on batches. By default, the i-th
+     * positions of each SOURCE batch are combined into the i-th position of
+     * the combined batch. Each combined position takes its sample from the
+     * first SOURCE. Throws if batch sizes differ.
+     * @param source_batches SOURCE position batches
+     * @param combined_batch combined batch
+     */
+    virtual void combine(const std::vector<oat::PositionBatch> &source_batches,
+                         oat::PositionBatch &combined_batch);
+
+    /**
+     * @brief Provide a copy of the base program options for derived
+     * types that need it.
+     * @return Base program options description.
+     */
+    po::options_description baseOptions(void) const;
+
     /**
      * Get the number of SOURCE positions.
      * @return number of SOURCE positions
      */
     int num_sources(void) const { return position_sources_.size(); };
 
+    // SOURCEs and SINK carry position batches
+    bool batch_ {false};
+
 private:
     // Component Interface
     virtual bool connectToNode(void) override;
     int process(void) override;
+    int processBatch(void);
 
     // Combiner name
     std::string name_;
@@ -92,6 +116,19 @@ private:
     oat::Position2D * shared_position_ {nullptr};
     std::string position_sink_address_;
     oat::Sink<oat::Position2D> position_sink_;
+
+    // Latency trace of the first source's position
+    oat::Trace trace_;
+
+    // Batch mode SOURCEs, SINK and internal batches
+    std::vector<oat::PositionBatch> batches_;
+    oat::NamedSourceList<oat::PositionBatch> batch_sources_;
+    oat::PositionBatch internal_batch_ {"internal"};
+    oat::PositionBatch * shared_batch_ {nullptr};
+    oat::Sink<oat::PositionBatch> batch_sink_;
+
+    // Waits on whichever SOURCEs are in use, reading them as they arrive
+    oat::SourceSet source_set_;
 };
 
 }      /* namespace oat */
@@ -95,7 +95,7 @@ void DifferenceDetector::applyConfiguration(
     oat::config::getValue<bool>(vm, config_table, "tune", tuning_on_);
 }
 
-void DifferenceDetector::detectPosition(cv::Mat &frame,
+void DifferenceDetector::detectPosition(const cv::Mat &frame,
                                         oat::Position2D &position)
 {
     if (tuning_on_)
@@ -151,7 +151,7 @@ void DifferenceDetector::tune(cv::Mat &frame, const oat::Position2D &position) {
     cv::waitKey(1);
 }
 
-void DifferenceDetector::applyThreshold(cv::Mat &frame) {
+void DifferenceDetector::applyThreshold(const cv::Mat &frame) {
 
     if (last_image_set_) {
         cv::absdiff(frame, last_image_, threshold_frame_);
@@ -55,7 +55,7 @@ private:
     void applyConfiguration(const po::variables_map &vm,
                             const config::OptionTable &config_table) override;
 
-    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+    void detectPosition(const cv::Mat &frame, oat::Position2D &position) override;
 
     // Intermediate variables
     cv::Mat this_image_, last_image_;
@@ -85,7 +85,7 @@ private:
     bool tuning_windows_created_ {false};
     void createTuningWindows(void);
     void tune(cv::Mat &frame, const oat::Position2D &position);
-    void applyThreshold(cv::Mat &frame);
+    void applyThreshold(const cv::Mat &frame);
 };
 
 }       /* namespace oat */
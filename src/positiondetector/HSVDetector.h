@@ -71,7 +71,7 @@ private:
      * @param Frame to look for object within.
      * @param position Detected object position.
      */
-    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+    void detectPosition(const cv::Mat &frame, oat::Position2D &position) override;
 
     // Erode and dilate kernels
     int erode_px_ {0}, dilate_px_ {10};
@@ -97,6 +97,7 @@ private:
     bool tuning_on_ {false};
     bool tuning_windows_created_ {false};
     const std::string tuning_image_title_;
+    cv::Mat tune_frame_;
     void tune(cv::Mat &frame, const oat::Position2D &position);
     void createTuningWindows(void);
 };
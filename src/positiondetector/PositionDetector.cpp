@@ -57,28 +57,31 @@ bool PositionDetector::connectToNode()
 
 int PositionDetector::process()
 {
-    oat::Frame internal_frame;
     oat::Position2D internal_pos("");
+    uint64_t enter_ns;
 
-    // START CRITICAL SECTION //
-    ////////////////////////////
+    {
+        // START CRITICAL SECTION //
+        ////////////////////////////
 
-    // Wait for sink to write to node
-    if (frame_source_.wait() == oat::NodeState::END)
-        return 1;
+        // Wait for sink to write to node and lease the shared frame
+        auto frame = frame_source_.lease();
+        if (frame.state() == oat::NodeState::END)
+            return 1;
 
-    // Clone the shared frame
-    frame_source_.copyTo(internal_frame);
+        enter_ns = oat::Sample::now_ns();
+        frame_source_.trace(trace_);
 
-    // Tell sink it can continue
-    frame_source_.post();
+        // Propagate sample info and detect position directly on the shared
+        // frame
+        internal_pos.set_sample(frame->sample());
+        detectPosition(*frame, internal_pos);
 
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
+        // Lease tells sink it can continue when it goes out of scope
 
-    // Propagate sample info and detect position
-    internal_pos.set_sample(internal_frame.sample());
-    detectPosition(internal_frame, internal_pos);
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
 
     // START CRITICAL SECTION //
     ////////////////////////////
@@ -87,6 +90,7 @@ int PositionDetector::process()
     position_sink_.wait();
 
     *shared_position_ = internal_pos;
+    position_sink_.trace(trace_, name_, enter_ns);
 
     // Tell sources there is new data
     position_sink_.post();
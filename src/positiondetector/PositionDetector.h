@@ -59,10 +59,11 @@ public:
 protected:
     /**
      * Perform object position detection.
-     * @param Frame to look for object within.
+     * @param Frame to look for object within. This is a view of the SOURCE's
+     * shared frame and must not be modified.
      * @param position Detected object position.
      */
-    virtual void detectPosition(cv::Mat &frame, oat::Position2D &position) = 0;
+    virtual void detectPosition(const cv::Mat &frame, oat::Position2D &position) = 0;
 
     // Detector name
     const std::string name_;
@@ -88,6 +89,9 @@ private:
     // Position sink
     const std::string position_sink_address_;
     oat::Sink<oat::Position2D> position_sink_;
+
+    // Latency trace of the frame being processed
+    oat::Trace trace_;
 };
 
 }      /* namespace oat */
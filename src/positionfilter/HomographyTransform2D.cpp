@@ -30,7 +30,10 @@ namespace oat {
 po::options_description HomographyTransform2D::options() const
 {
     // Update CLI options
-    po::options_description local_opts;
+    // Start with base options
+    po::options_description local_opts(baseOptions());
+
+    // Add local options
     local_opts.add_options()
         ("homography,H", po::value<std::string>(),
          "A nine-element array of floats, [h11,h12,...,h33], specifying a "
@@ -44,6 +47,9 @@ po::options_description HomographyTransform2D::options() const
 void HomographyTransform2D::applyConfiguration(
     const po::variables_map &vm, const config::OptionTable &config_table)
 {
+    // Batch mode
+    oat::config::getValue<bool>(vm, config_table, "batch", batch_);
+
     // Homography
     std::vector<double> H;
     if (oat::config::getArray<double, 9>(vm, config_table, "homography", H)) {
@@ -40,7 +40,10 @@ KalmanFilter2D::KalmanFilter2D(const std::string& position_source_address,
 po::options_description KalmanFilter2D::options() const
 {
     // Update CLI options
-    po::options_description local_opts;
+    // Start with base options
+    po::options_description local_opts(baseOptions());
+
+    // Add local options
     local_opts.add_options()
         ("dt", po::value<double>(), // TODO: should be automatic?
          "Kalman filter time step in seconds.")
@@ -65,6 +68,9 @@ po::options_description KalmanFilter2D::options() const
 void KalmanFilter2D::applyConfiguration(const po::variables_map &vm,
                                         const config::OptionTable &config_table)
 {
+    // Batch mode
+    oat::config::getValue<bool>(vm, config_table, "batch", batch_);
+
     // Time step
     oat::config::getNumericValue<double>(vm, config_table, "dt", dt_, 0);
 
@@ -32,8 +32,35 @@ PositionFilter::PositionFilter(const std::string &position_source_address,
   // Nothing
 }
 
+po::options_description PositionFilter::baseOptions(void) const
+{
+    po::options_description base_opts;
+
+    // Common program options
+    base_opts.add_options()
+        ("batch",
+         "If set, SOURCE and SINK carry batches of positions (e.g. from 'oat posigen "
+         "--batch-size') instead of single positions. Each position in a "
+         "batch is filtered in order.")
+        ;
+
+    return base_opts;
+}
+
 bool PositionFilter::connectToNode()
 {
+    if (batch_) {
+
+        batch_source_.touch(position_source_address_);
+        if (batch_source_.connect() != SourceState::CONNECTED)
+            return false;
+
+        batch_sink_.bind(position_sink_address_, position_sink_address_);
+        shared_batch_ = batch_sink_.retrieve();
+
+        return true;
+    }
+
     // Establish our a slot in the node
     position_source_.touch(position_source_address_);
 
@@ -50,6 +77,9 @@ bool PositionFilter::connectToNode()
 
 int PositionFilter::process()
 {
+    if (batch_)
+        return processBatch();
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
@@ -57,8 +87,11 @@ int PositionFilter::process()
     if (position_source_.wait() == oat::NodeState::END)
         return 1;
 
+    const uint64_t enter_ns = oat::Sample::now_ns();
+
     // Clone the shared frame
     internal_position_ = position_source_.clone();
+    position_source_.trace(trace_);
 
     // Tell sink it can continue
     position_source_.post();
@@ -76,6 +109,7 @@ int PositionFilter::process()
     position_sink_.wait();
 
     *shared_position_ = internal_position_;
+    position_sink_.trace(trace_, name_, enter_ns);
 
     // Tell sources there is new data
     position_sink_.post();
@@ -87,4 +121,52 @@ int PositionFilter::process()
     return 0;
 }
 
+int PositionFilter::processBatch()
+{
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sink to write to node
+    if (batch_source_.wait() == oat::NodeState::END)
+        return 1;
+
+    const uint64_t enter_ns = oat::Sample::now_ns();
+
+    // Copy the occupied part of the shared batch
+    internal_batch_ = *batch_source_.retrieve();
+    batch_source_.trace(trace_);
+
+    // Tell sink it can continue
+    batch_source_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    filter(internal_batch_);
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    batch_sink_.wait();
+
+    *shared_batch_ = internal_batch_;
+    batch_sink_.trace(trace_, name_, enter_ns);
+
+    // Tell sources there is new data
+    batch_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // Sink was not at END state
+    return 0;
+}
+
+void PositionFilter::filter(oat::PositionBatch &batch)
+{
+    for (auto &p : batch)
+        filter(p);
+}
+
 } /* namespace oat */
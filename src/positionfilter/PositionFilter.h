@@ -27,6 +27,7 @@
 #include "../../lib/base/Component.h"
 #include "../../lib/base/Configurable.h"
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionBatch.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/Source.h"
 
@@ -58,10 +59,29 @@ protected:
      */
     virtual void filter(oat::Position2D &position) = 0;
 
+    /**
+     * Perform filtering on a batch of positions. By default, each position
+     * is filtered in order, so stateful filters treat the batch as
+     * consecutive samples of a single object.
+     * @param batch Positions to be filtered
+     */
+    virtual void filter(oat::PositionBatch &batch);
+
+    /**
+     * @brief Provide a copy of the base program options for derived
+     * types that need it.
+     * @return Base program options description.
+     */
+    po::options_description baseOptions(void) const;
+
+    // SOURCE and SINK carry position batches
+    bool batch_ {false};
+
 private:
     // Component Interface
     virtual bool connectToNode(void) override;
     int process(void) override;
+    int processBatch(void);
 
     // Filter name
     const std::string name_;
@@ -79,6 +99,15 @@ private:
     // Position SINK
     const std::string position_sink_address_;
     oat::Sink<oat::Position2D> position_sink_;
+
+    // Latency trace of the position being filtered
+    oat::Trace trace_;
+
+    // Batch mode SOURCE, SINK and internal batch
+    oat::Source<oat::PositionBatch> batch_source_;
+    oat::PositionBatch internal_batch_ {"internal"};
+    oat::PositionBatch * shared_batch_ {nullptr};
+    oat::Sink<oat::PositionBatch> batch_sink_;
 };
 
 }      /* namespace oat */
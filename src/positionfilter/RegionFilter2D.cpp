@@ -41,10 +41,15 @@ RegionFilter2D::~RegionFilter2D()
 po::options_description RegionFilter2D::options() const
 {
     // Update CLI options
-    po::options_description local_opts;
+    // Start with base options
+    po::options_description local_opts(baseOptions());
+
+    // Add local options
     local_opts.add_options()
         ("regions", po::value<std::string>(),
-         "NOTE: Regions can only be specified in a config file.\n"
+         "NOTE: Regions can only be specified in a config file, in a "
+         "'regions' sub-table of the component's table, e.g. "
+         "[myfilter.regions].\n"
          "Regions contours are specified as n-point matrices, [[x0, y0],[x1, "
          "y1],...,[xn, yn]], which define the vertices of a polygon:\n\n"
          "  <region> = [[+float, +float],\n"
@@ -74,19 +79,27 @@ po::options_description RegionFilter2D::options() const
 void RegionFilter2D::applyConfiguration(const po::variables_map &vm,
                                         const config::OptionTable &config_table)
 {
-    // The config should be an table of arrays.
-    // Each key specifies the region ID and its value specifies an array
-    // defining a vector of 2D points.
+    // Batch mode
+    oat::config::getValue<bool>(vm, config_table, "batch", batch_);
+
+    // The regions sub-table should be an table of arrays. Each key specifies
+    // the region ID and its value specifies an array defining a vector of 2D
+    // points. Regions have their own table so that they cannot be confused
+    // with options.
     if (vm.count("regions"))
         throw std::runtime_error("Regions can only be specified using a config file.");
 
+    oat::config::OptionTable regions_table;
+    if (!oat::config::getTable(config_table, "regions", regions_table))
+        return;
+
     // Iterate through each region definition
-    auto it = config_table->begin();
+    auto it = regions_table->begin();
 
-    while (it != config_table->end()) {
+    while (it != regions_table->end()) {
 
         oat::config::Array region_array;
-        oat::config::getArray(config_table, it->first, region_array);
+        oat::config::getArray(regions_table, it->first, region_array);
 
         // Push the name of this region onto the id list
         region_ids_.push_back(it->first);
@@ -45,6 +45,12 @@ public:
 
     ~RegionFilter2D();
 
+    /**
+     * @brief Names of the configured regions, in the order they are
+     * checked. Valid once configured.
+     */
+    const std::vector<std::string> &region_ids(void) const { return region_ids_; }
+
 private:
     // Configurable Interface
     po::options_description options() const override;
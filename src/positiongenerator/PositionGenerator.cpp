@@ -51,6 +51,11 @@ po::options_description PositionGenerator::baseOptions(void) const
          "Array of floats, [x0,y0,width,height], specifying the boundaries in "
          "which generated positions reside. The room has periodic boundaries so "
          "when a position leaves one side it will enter the opposing one.")
+        ("batch-size", po::value<size_t>(),
+         "Publish batches of this many consecutive positions, one sample "
+         "period apart, in each write instead of single positions. Read them "
+         "with the '--batch' option of posifilt and posicom. Must be between "
+         "1 and 64.")
         ;
 
     return base_opts;
@@ -58,9 +63,14 @@ po::options_description PositionGenerator::baseOptions(void) const
 
 bool PositionGenerator::connectToNode()
 {
-    // Bind to sink sink node and create a shared position
-    position_sink_.bind(position_sink_address_, position_sink_address_);
-    shared_position_ = position_sink_.retrieve();
+    // Bind to sink sink node and create a shared position or batch
+    if (batch_size_ > 0) {
+        batch_sink_.bind(position_sink_address_, position_sink_address_);
+        shared_batch_ = batch_sink_.retrieve();
+    } else {
+        position_sink_.bind(position_sink_address_, position_sink_address_);
+        shared_position_ = position_sink_.retrieve();
+    }
 
     // Setup sample rate info on internal copy
     internal_position_.set_rate_hz(1.0 / sample_period_in_sec_.count());
@@ -70,8 +80,12 @@ bool PositionGenerator::connectToNode()
 
 int PositionGenerator::process()
 {
+    if (batch_size_ > 0)
+        return processBatch();
+
     // Generate internal position
     bool eof = generatePosition(internal_position_);
+    internal_position_.set_capture_ns(Sample::now_ns());
 
     // START CRITICAL SECTION //
     ////////////////////////////
@@ -79,11 +93,6 @@ int PositionGenerator::process()
     // Wait for sources to read
     position_sink_.wait();
 
-    if (first_pos_) {
-        first_pos_ = false;
-        start_ = clock_.now();
-    }
-
     *shared_position_ = internal_position_;
 
     // Tell sources there is new data
@@ -99,9 +108,47 @@ int PositionGenerator::process()
     }
 
     // Pure SINKs increment sample count
-    auto time_since_start = std::chrono::duration_cast<Sample::Microseconds>(
-        clock_.now() - start_);
-    internal_position_.incrementSampleCount(time_since_start);
+    internal_position_.incrementSampleCount(Sample::since_start());
+
+    return eof;
+}
+
+int PositionGenerator::processBatch()
+{
+    // Generate consecutive positions. Within a batch, samples are a sample
+    // period apart.
+    bool eof = false;
+    internal_batch_.clear();
+    while (internal_batch_.size() < batch_size_ && !eof) {
+
+        eof = generatePosition(internal_position_);
+        if (!eof) {
+            internal_position_.set_capture_ns(Sample::now_ns());
+            internal_batch_.push_back(internal_position_);
+            internal_position_.incrementSampleCount();
+        }
+    }
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    batch_sink_.wait();
+
+    *shared_batch_ = internal_batch_;
+
+    // Tell sources there is new data
+    batch_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    if (enforce_sample_clock_) {
+        auto tock = clock_.now();
+        std::this_thread::sleep_for(
+            sample_period_in_sec_ * internal_batch_.size() - (tock - tick_));
+        tick_ = clock_.now();
+    }
 
     return eof;
 }
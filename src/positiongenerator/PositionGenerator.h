@@ -31,6 +31,7 @@
 #include "../../lib/base/Component.h"
 #include "../../lib/base/Configurable.h"
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionBatch.h"
 #include "../../lib/shmemdf/Sink.h"
 
 namespace po = boost::program_options;
@@ -66,7 +67,7 @@ protected:
     bool enforce_sample_clock_ {false};
     std::chrono::high_resolution_clock clock_;
     std::chrono::duration<double> sample_period_in_sec_;
-    std::chrono::high_resolution_clock::time_point start_, tick_;
+    std::chrono::high_resolution_clock::time_point tick_;
 
     // Periodic boundaries in which simulated particle resides.
     cv::Rect_<double> room_ {0, 0, 100, 100};
@@ -75,6 +76,9 @@ protected:
     uint64_t num_samples_ {std::numeric_limits<uint64_t>::max()};
     uint64_t it_ {0};
 
+    // Positions per write. 0 publishes single positions rather than batches.
+    size_t batch_size_ {0};
+
     /**
      * Configure the sample period
      * @param samples_per_second Sample period in seconds.
@@ -92,6 +96,7 @@ private:
     // Component Interface
     virtual bool connectToNode(void) override;
     int process(void) override;
+    int processBatch(void);
 
     // Test position name
     std::string name_;
@@ -102,12 +107,14 @@ private:
     // Shared position
     oat::Position2D * shared_position_;
 
-    // First position
-    bool first_pos_ {true};
-
     // The test position SINK
     std::string position_sink_address_;
     oat::Sink<oat::Position2D> position_sink_;
+
+    // Batch mode SINK and internal batch
+    oat::PositionBatch internal_batch_ {"internal"};
+    oat::PositionBatch * shared_batch_ {nullptr};
+    oat::Sink<oat::PositionBatch> batch_sink_;
 };
 
 }      /* namespace oat */
@@ -58,6 +58,10 @@ void RandomAccel2D::applyConfiguration(const po::variables_map &vm,
     oat::config::getNumericValue<uint64_t>(
         vm, config_table, "num-samples", num_samples_, 0);
 
+    // Batch size
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "batch-size", batch_size_, 1, PositionBatch::CAPACITY);
+
     // Room
     std::vector<double> r;
     if (oat::config::getArray<double, 4>(vm, config_table, "room", r)) {
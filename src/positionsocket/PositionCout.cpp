@@ -38,6 +38,10 @@ po::options_description PositionCout::options() const
     local_opts.add_options()
         ("pretty-print,p", 
          "If true, print formated positions to the command line.")
+        ("lossy,l",
+         "If set, do not hold back the upstream component. Only the most "
+         "recent position is sent and intermediate positions might be "
+         "skipped.")
         ;
 
     return local_opts; 
@@ -48,6 +52,9 @@ void PositionCout::applyConfiguration(const po::variables_map &vm,
 {
     // Format output
     oat::config::getValue<bool>(vm, config_table, "pretty-print", pretty_);
+
+    // Lossy reads
+    oat::config::getValue<bool>(vm, config_table, "lossy", lossy_);
 }
 
 void PositionCout::sendPosition(const oat::Position2D &position)
@@ -57,10 +64,10 @@ void PositionCout::sendPosition(const oat::Position2D &position)
 
     if (pretty_) {
         rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
-        oat::serializePosition(position, writer);
+        oat::serializePosition(position, writer, false, trace());
     } else {
         rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-        oat::serializePosition(position, writer);
+        oat::serializePosition(position, writer, false, trace());
     }
 
     std::cout << buffer.GetString() << std::flush;
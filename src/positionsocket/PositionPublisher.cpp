@@ -46,7 +46,11 @@ po::options_description PositionPublisher::options() const
          "ZMQ-style endpoint. For TCP: '<transport>://<host>:<port>'. For instance, "
          "'tcp://*:5555'. Or, for interprocess communication: "
          "'<transport>:///<user-named-pipe>. For instance "
-         "'ipc:///tmp/test.pipe'.");
+         "'ipc:///tmp/test.pipe'.")
+        ("lossy,l",
+         "If set, do not hold back the upstream component. Only the most "
+         "recent position is sent and intermediate positions might be "
+         "skipped.")
         ;
 
     return local_opts;
@@ -60,6 +64,9 @@ void PositionPublisher::applyConfiguration(
     oat::config::getValue<std::string>(
         vm, config_table, "endpoint", endpoint, true);
     publisher_.bind(endpoint);
+
+    // Lossy reads
+    oat::config::getValue<bool>(vm, config_table, "lossy", lossy_);
 }
 
 void PositionPublisher::sendPosition(const oat::Position2D &position)
@@ -67,7 +74,7 @@ void PositionPublisher::sendPosition(const oat::Position2D &position)
     // Serialize the current position
     rapidjson::StringBuffer buffer;
     rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    oat::serializePosition(position, writer);
+    oat::serializePosition(position, writer, false, trace());
 
     // Publish update
     zmq::message_t zmsg(buffer.GetSize());
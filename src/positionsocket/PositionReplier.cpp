@@ -46,7 +46,11 @@ po::options_description PositionReplier::options() const
          "ZMQ-style endpoint. For TCP: '<transport>://<host>:<port>'. For instance, "
          "'tcp://*:5555'. Or, for interprocess communication: "
          "'<transport>:///<user-named-pipe>. For instance "
-         "'ipc:///tmp/test.pipe'.");
+         "'ipc:///tmp/test.pipe'.")
+        ("lossy,l",
+         "If set, do not hold back the upstream component. Only the most "
+         "recent position is sent and intermediate positions might be "
+         "skipped.")
         ;
 
     return local_opts;
@@ -59,6 +63,9 @@ void PositionReplier::applyConfiguration(
     std::string endpoint;
     oat::config::getValue<std::string>(vm, config_table, "endpoint", endpoint, true);
     replier_.bind(endpoint);
+
+    // Lossy reads
+    oat::config::getValue<bool>(vm, config_table, "lossy", lossy_);
 }
 
 void PositionReplier::sendPosition(const oat::Position2D& position)
@@ -66,7 +73,7 @@ void PositionReplier::sendPosition(const oat::Position2D& position)
     // Serialize the current position
     rapidjson::StringBuffer buffer;
     rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    oat::serializePosition(position, writer);
+    oat::serializePosition(position, writer, false, trace());
 
     //  Wait for next request from client
     // TODO: Use incoming string to decide which part of the position to send
@@ -37,7 +37,9 @@ PositionSocket::PositionSocket(const std::string &position_source_address)
 bool PositionSocket::connectToNode()
 {
     // Establish our a slot in the node 
-    position_source_.touch(position_source_address_);
+    position_source_.touch(position_source_address_,
+                           lossy_ ? oat::SourceMode::LOSSY
+                                  : oat::SourceMode::SYNCHRONOUS);
 
     // Wait for synchronous start with sink when it binds its node
     if (position_source_.connect() != SourceState::CONNECTED)
@@ -54,8 +56,13 @@ int PositionSocket::process()
     if (node_state_ == oat::NodeState::END)
         return 1;
 
+    const uint64_t enter_ns = oat::Sample::now_ns();
+
     // Clone the shared position
     internal_position_ = position_source_.clone();
+    traced_ = position_source_.trace(trace_);
+    if (traced_)
+        trace_.appendHop(name_, enter_ns, oat::Sample::now_ns());
 
     // Tell sink it can continue
     position_source_.post();
@@ -56,6 +56,16 @@ protected:
      */
     virtual void sendPosition(const oat::Position2D &position) = 0;
 
+    /**
+     * Latency trace of the position being sent, or nullptr if it was not
+     * traced.
+     */
+    const oat::Trace * trace() const { return traced_ ? &trace_ : nullptr; }
+
+    // If true, only the most recent position is sent and the upstream SINK
+    // is never held back by this socket
+    bool lossy_ {false};
+
 private:
     // Component Interface
     bool connectToNode(void) override;
@@ -71,6 +81,10 @@ private:
 
     // The current, internally allocated position
     oat::Position2D internal_position_ {"internal"};
+
+    // Its latency trace
+    oat::Trace trace_;
+    bool traced_ {false};
 };
 
 }      /* namespace oat */
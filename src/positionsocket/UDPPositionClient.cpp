@@ -47,6 +47,10 @@ po::options_description UDPPositionClient::options() const
         ("port,p", po::value<int>(),
          "Port number of endpoint on remote device to send positions to. For "
          "instance, 5555.")
+        ("lossy,l",
+         "If set, do not hold back the upstream component. Only the most "
+         "recent position is sent and intermediate positions might be "
+         "skipped.")
         ;
 
     return local_opts;
@@ -74,6 +78,9 @@ void UDPPositionClient::applyConfiguration(
 
     udp_stream_.reset(new rapidjson::SocketWriteStream<UDPSocket, UDPEndpoint>(
             &socket_, endpoint, buffer_, sizeof(buffer_)));
+
+    // Lossy reads
+    oat::config::getValue<bool>(vm, config_table, "lossy", lossy_);
 }
 
 // Each position is sent in a single UDP packet
@@ -82,7 +89,7 @@ void UDPPositionClient::sendPosition(const oat::Position2D &current_position)
     rapidjson::Writer < rapidjson::SocketWriteStream
                       < UDPSocket, UDPEndpoint > > udp_writer_ {*udp_stream_};
 
-    oat::serializePosition(current_position, udp_writer_);
+    oat::serializePosition(current_position, udp_writer_, false, trace());
 
     // Flush the stream after each Serialization call so that each UDP packet
     // corresponds to a single position value
@@ -47,6 +47,9 @@ void FrameWriter::configure(const oat::config::OptionTable &t,
         if (fourcc_ < 0)
             throw std::runtime_error("Unsupported fourcc code.");
     }
+
+    // Raw frames
+    oat::config::getValue(vm, t, "raw", raw_);
 }
 
 oat::SourceState FrameWriter::connect()
@@ -66,7 +69,7 @@ oat::SourceState FrameWriter::connect()
 
 void FrameWriter::initialize(const std::string &path)
 {
-    path_ = path + ".avi";
+    path_ = path + (raw_ ? ".oatraw" : ".avi");
 
     if (!allow_overwrite_)
        oat::ensureUniquePath(path_);
@@ -74,6 +77,19 @@ void FrameWriter::initialize(const std::string &path)
     if (!oat::checkWritePermission(path_))
         throw std::runtime_error("Write permission denied for " + path_);
 
+    if (raw_) {
+
+        oat::RawFrameHeader h {};
+        h.rows = frame_params_.rows;
+        h.cols = frame_params_.cols;
+        h.type = frame_params_.type;
+        h.color = frame_params_.color;
+        h.frame_bytes = frame_params_.bytes;
+        h.rate_hz = fps_;
+        raw_writer_.open(path_, h);
+        return;
+    }
+
     auto sz = cv::Size(frame_params_.cols, frame_params_.rows);
 
     if (!video_writer_.open(path_, fourcc_, fps_, sz))
@@ -82,15 +98,46 @@ void FrameWriter::initialize(const std::string &path)
 
 void FrameWriter::write(void)
 {
-    cv::Mat mat;
-    while (buffer_.pop(mat))
-        video_writer_.write(mat);
+    if (raw_) {
+
+        const auto &h = raw_writer_.header();
+        oat::Frame frame;
+        while (buffer_.pop(frame)) {
+
+            if (static_cast<size_t>(frame.rows) != h.rows
+                || static_cast<size_t>(frame.cols) != h.cols
+                || frame.type() != h.type)
+                throw std::runtime_error("Frames from " + addr()
+                                         + " changed size, which raw "
+                                         "files do not support.");
+
+            const auto s = frame.sample();
+            oat::RawFrameRecord r {};
+            r.count = s.count();
+            r.microseconds = s.microseconds().count();
+            r.capture_ns = s.capture_ns();
+            raw_writer_.write(r, frame.data);
+        }
+
+    } else {
+
+        cv::Mat mat;
+        while (buffer_.pop(mat))
+            video_writer_.write(mat);
+    }
+
+    notifyRoom();
 }
 
 void FrameWriter::push(void )
 {
-    if (!buffer_.push(source_.clone()))
-        throw std::runtime_error(OVERRUN_MSG);
+    auto frame = source_.clone();
+
+    if (buffer_.write_available() == 0
+        && !overrun([this] { return buffer_.write_available() > 0; }))
+        return;
+
+    buffer_.push(frame);
 }
 
 } /* namespace oat */
@@ -27,6 +27,7 @@
 
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/utility/FileFormat.h"
+#include "../../lib/utility/RawFrameFile.h"
 
 namespace oat {
 namespace blf = boost::lockfree;
@@ -38,13 +39,13 @@ public:
 
     void configure(const oat::config::OptionTable &t,
                    const po::variables_map &vm) override;
-    void touch() override { source_.touch(addr_); }
+    void touch() override { source_.touch(addr_, mode_); }
     oat::SourceState connect() override;
     double sample_period_sec() override
     {
         return source_.retrieve()->sample_period_sec();
     }
-    oat::NodeState wait() override { return source_.wait(); }
+    void addTo(oat::SourceSet &set) override { set.add(source_); }
     void post(void) override { source_.post(); }
 
     void initialize(const std::string &path) override;
@@ -68,6 +69,10 @@ private:
     oat::FrameParams frame_params_;
     cv::VideoWriter video_writer_;
 
+    // Write frames and their samples to a .oatraw file instead of a video
+    bool raw_ {false};
+    oat::RawFrameWriter raw_writer_;
+
     // The held frame source
     oat::Source<oat::Frame> source_;
 };
@@ -84,6 +84,10 @@ void PositionWriter::initializeBinary(const std::string &path)
 
 void PositionWriter::initializeJSON(const std::string &path)
 {
+    // Only JSON files carry latency traces
+    if (oat::Trace::enabled())
+        traces_.reset(new TraceBuffer);
+
     auto path_ =  path + ".json";
 
     if (!allow_overwrite_)
@@ -140,6 +144,7 @@ void PositionWriter::initializeJSON(const std::string &path)
 void PositionWriter::write() {
 
     oat::Position2D p("");
+    oat::Trace trace;
 
     while (buffer_.pop(p)) {
 
@@ -148,17 +153,41 @@ void PositionWriter::write() {
             auto pack = oat::packPosition(p);
             fwrite(pack.data(), 1, pack.size(), fd_);
         } else {
-            oat::serializePosition(p, json_writer_, !concise_file_);
+            const bool traced = traces_ != nullptr && traces_->pop(trace);
+            oat::serializePosition(p, json_writer_, !concise_file_,
+                                   traced ? &trace : nullptr);
         }
 
         completed_writes_++;
     }
+
+    notifyRoom();
 }
 
 void PositionWriter::push() {
 
-    if (!buffer_.push(source_.clone()))
-        throw std::runtime_error(OVERRUN_MSG);
+    // Pushed as soon as the sample arrives
+    const uint64_t enter_ns = oat::Sample::now_ns();
+    auto p = source_.clone();
+
+    // Untraced positions get an empty trace to keep the buffers in step
+    if (traces_ != nullptr) {
+        if (source_.trace(trace_))
+            trace_.appendHop("record[" + addr_ + "]", enter_ns,
+                             oat::Sample::now_ns());
+        else
+            trace_ = oat::Trace();
+    }
+
+    if (buffer_.write_available() == 0
+        && !overrun([this] { return buffer_.write_available() > 0; }))
+        return;
+
+    // The trace is queued first so that it is there when the position is
+    // popped
+    if (traces_ != nullptr)
+        traces_->push(trace_);
+    buffer_.push(p);
 }
 
 } /* namespace oat */
@@ -40,14 +40,14 @@ public:
 
     void configure(const oat::config::OptionTable &t,
                    const po::variables_map &vm) override;
-    void touch() override { source_.touch(addr_); }
+    void touch() override { source_.touch(addr_, mode_); }
     oat::SourceState connect() override { return source_.connect(); }
     double sample_period_sec() override
     {
         return source_.retrieve()->sample_period_sec();
     }
 
-    oat::NodeState wait() override { return source_.wait(); }
+    void addTo(oat::SourceSet &set) override { set.add(source_); }
     void post(void) override { source_.post(); }
 
     void initialize(const std::string &path) override;
@@ -72,6 +72,12 @@ private:
     std::string path_ {""};
     SPSCBuffer buffer_;
 
+    // Latency trace of each buffered position, when tracing
+    using TraceBuffer = boost::lockfree::spsc_queue<oat::Trace,
+                                                    blf::capacity<BUFFER_SIZE>>;
+    std::unique_ptr<TraceBuffer> traces_;
+    oat::Trace trace_;
+
     //// Timestamp clock
     //std::chrono::system_clock clock_;
     //std::chrono::system_clock::time_point start_;
@@ -84,6 +84,11 @@ po::options_description Recorder::options() const
          "must be implemented by the low  level writer. Common values are "
          "'DIVX' or 'H264'. Defaults to 'None' indicating uncompressed "
          "video.")
+        ("raw",
+         "Write frames uncompressed to .oatraw files instead of AVI video. "
+         "Each frame keeps its sample number and time, writing costs no "
+         "codec time, and the files can be replayed with 'oat frameserve "
+         "raw'. Overrides --fourcc.")
         ("binary-file,b",
          "Position data will be written as numpy data file (version 1.0) "
          "instead of JSON. Each position data point occupies a single entry "
@@ -95,6 +100,18 @@ po::options_description Recorder::options() const
          "pos_ok = false. This means that position objects will be of "
          "variable size depending on the validity of whether a position was "
          "detected or not, potentially complicating file parsing.")
+        ("policy", po::value<std::string>(),
+         "What to do when the recorder cannot keep up with its SOURCES. "
+         "Values:\n"
+         "  block: \tDefault. Hold back the SINKs, and so capture, until each "
+         "sample is read. Exit if the write queue overruns.\n"
+         "  drop-oldest: \tNever hold back the SINKs. Record the latest sample "
+         "when ready for one.\n"
+         "  drop-newest: \tNever hold back the SINKs. Samples arriving while the "
+         "recorder is busy are dropped.\n"
+         "With either drop policy, samples are also dropped when the write "
+         "queue is full. Dropped samples appear as gaps in the recorded sample "
+         "numbers.")
         ;
 
     return local_opts;
@@ -133,6 +150,26 @@ void Recorder::applyConfiguration(const po::variables_map &vm,
     else
         name_ = "recorder[" + writers_[0]->addr()  + "]";
 
+    // Backpressure policy
+    std::string policy;
+    if (oat::config::getValue(vm, config_table, "policy", policy)) {
+
+        oat::SourceMode mode;
+        if (policy == "block")
+            mode = oat::SourceMode::SYNCHRONOUS;
+        else if (policy == "drop-oldest")
+            mode = oat::SourceMode::LOSSY;
+        else if (policy == "drop-newest")
+            mode = oat::SourceMode::DROP_NEWEST;
+        else
+            throw std::runtime_error("Unrecognized policy '" + policy
+                                     + "'. Use block, drop-oldest or "
+                                     "drop-newest.");
+
+        for (auto &w : writers_)
+            w->set_mode(mode);
+    }
+
     // Base file name
     oat::config::getValue(vm, config_table, "filename", file_name_);
 
@@ -153,8 +190,10 @@ void Recorder::applyConfiguration(const po::variables_map &vm,
 bool Recorder::connectToNode()
 {
     // Touch frame and position source nodes
-    for (auto &w : writers_)
+    for (auto &w : writers_) {
         w->touch();
+        w->addTo(source_set_);
+    }
 
     std::vector<double> all_ts;
     for (auto &w : writers_) {
@@ -177,22 +216,27 @@ int Recorder::process()
 {
     bool source_eof = false;
 
-    // Read sources, push samples to write buffers
-    for (auto &w : writers_) {
+    // Read sources as they arrive, push samples to write buffers
+    do {
 
         // START CRITICAL SECTION //
         ////////////////////////////
-        source_eof |= w->wait() == oat::NodeState::END;
+        source_eof |= source_set_.wait() == oat::NodeState::END;
 
-        if (record_on_ && !source_eof) {
-           w->push();
-           files_have_data_ = true;
-        }
+        for (const auto i : source_set_.ready()) {
+
+            auto &w = writers_[i];
+            if (record_on_ && !source_eof) {
+               w->push();
+               files_have_data_ = true;
+            }
 
-        w->post();
+            w->post();
+        }
         ////////////////////////////
         //  END CRITICAL SECTION  //
-    }
+
+    } while (source_set_.pending() > 0);
 
     // Notify the writer thread that there are new queued samples
     writer_condition_variable_.notify_one();
@@ -96,6 +96,7 @@ private:
 
     // Writers (each owns its SOURCE)
     std::vector<std::unique_ptr<Writer>> writers_;
+    oat::SourceSet source_set_;
 
     // File-writer threading
     std::thread writer_thread_;
@@ -19,12 +19,29 @@
 
 #include "Writer.h"
 
+#include <iostream>
+
+#include "../../lib/utility/IOFormat.h"
+
 namespace oat {
 
 const char Writer::OVERRUN_MSG[]
     = "Record buffer overrun. You can:\n"
       " - decrease the sample rate\n"
       " - use multiple recorders on multiple disks\n"
-      " - or, get a faster hard disk";
+      " - or, get a faster hard disk\n"
+      " - or, use a dropping --policy";
+
+bool Writer::drop()
+{
+    if (mode_ == oat::SourceMode::SYNCHRONOUS)
+        throw std::runtime_error(OVERRUN_MSG);
+
+    if (overruns_++ == 0)
+        std::cerr << oat::Warn("Record buffer overrun on " + addr_
+                               + ". Samples are being dropped.\n");
+
+    return false;
+}
 
 } /* namespace oat */
@@ -30,6 +30,7 @@
 
 #include "../../lib/shmemdf/Node.h"
 #include "../../lib/shmemdf/Source.h"
+#include "../../lib/shmemdf/SourceSet.h"
 #include "../../lib/utility/FileFormat.h"
 #include "../../lib/utility/TOMLSanitize.h"
 
@@ -46,10 +47,11 @@ public:
     Writer(const std::string &addr)
     : addr_(addr)
     {
-        // Nothing
+        // SIGINT must be able to wake a push() blocked in overrun()
+        registerForShutdown(&room_);
     }
 
-    virtual ~Writer() { }
+    virtual ~Writer() { unregisterForShutdown(&room_); }
 
     // Program option handling
     virtual void configure(const oat::config::OptionTable &t,
@@ -58,10 +60,14 @@ public:
     // Stuff for manipulating held source
     virtual void touch(void) = 0;
     virtual oat::SourceState connect(void) = 0;
-    virtual oat::NodeState wait(void) = 0;
     virtual void post(void) = 0;
     virtual double sample_period_sec(void) = 0;
 
+    /**
+     * @brief Add the held source to the set that the recorder waits on.
+     */
+    virtual void addTo(oat::SourceSet &set) = 0;
+
     /**
      * @brief Create and initialize recording file. Must be called
      * before writeStreams.
@@ -85,10 +91,51 @@ public:
 
     std::string addr(void) const { return addr_; }
 
+    /**
+     * @brief Set the backpressure policy of the held source. Must be called
+     * before touch().
+     */
+    void set_mode(const oat::SourceMode mode) { mode_ = mode; }
+
 protected:
     static constexpr int BUFFER_SIZE {1000};
     static const char OVERRUN_MSG[];
 
+    /**
+     * @brief Handle a full write queue. Offline, blocks until write() has
+     * made room. Otherwise, throws if the source is SYNCHRONOUS, or drops the
+     * sample and warns once.
+     * @param has_room Predicate that is true once the queue has room.
+     * @return True if there is room for the sample, false if it should be
+     * dropped.
+     */
+    template <typename Room>
+    bool overrun(Room has_room)
+    {
+        if (oat::offline()) {
+            room_.wait([&has_room] { return has_room() || quit; });
+            return !quit;
+        }
+
+        return drop();
+    }
+
+    /**
+     * @brief Wake a push() that is blocked in overrun(). Must be called by
+     * write() once it has emptied the queue.
+     */
+    void notifyRoom(void) { room_.notify(); }
+
+    /**
+     * @brief Backpressure policy of the held source
+     */
+    oat::SourceMode mode_ {oat::SourceMode::SYNCHRONOUS};
+
+    /**
+     * @brief Samples dropped because the write queue was full
+     */
+    uint64_t overruns_ {0};
+
     /**
      * @breif Address of shmem for held source
      */
@@ -99,6 +146,13 @@ protected:
      * file name to make it unique.
      */
     bool allow_overwrite_ {false};
+
+private:
+    // Signalled by write() when it makes room in the queue
+    oat::WaitQueue room_;
+
+    // Not offline, a full queue is an error or a dropped sample
+    bool drop(void);
 };
 
 }      /* namespace oat */
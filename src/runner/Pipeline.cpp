@@ -0,0 +1,464 @@
+//******************************************************************************
+//* File:   Pipeline.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include "Pipeline.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/program_options.hpp>
+#include <cpptoml.h>
+
+#include "../../lib/base/Globals.h"
+#include "../../lib/shmemdf/Channel.h"
+#include "../../lib/shmemdf/Semaphore.h"
+
+#include "../frameserver/FileReader.h"
+#include "../frameserver/ImageSequence.h"
+#include "../frameserver/RawReader.h"
+#include "../frameserver/SyntheticFrame.h"
+#include "../frameserver/TestFrame.h"
+#include "../frameserver/V4L2Cam.h"
+#include "../frameserver/WebCam.h"
+#ifdef USE_FLYCAP
+ #include "FlyCapture2.h"
+ #include "../frameserver/PointGreyCam.h"
+ namespace pg = FlyCapture2;
+#endif
+#include "../framefilter/BackgroundSubtractor.h"
+#include "../framefilter/BackgroundSubtractorMOG.h"
+#include "../framefilter/ColorConvert.h"
+#include "../framefilter/FrameMasker.h"
+#include "../framefilter/Threshold.h"
+#include "../framefilter/Undistorter.h"
+#include "../positioncombiner/MeanPosition.h"
+#include "../positiondetector/DifferenceDetector.h"
+#include "../positiondetector/HSVDetector.h"
+#include "../positiondetector/SimpleThreshold.h"
+#include "../positionfilter/HomographyTransform2D.h"
+#include "../positionfilter/KalmanFilter2D.h"
+#include "../positionfilter/RegionFilter2D.h"
+#include "../positiongenerator/RandomAccel2D.h"
+
+#include "Stitcher.h"
+
+namespace oat {
+
+namespace po = boost::program_options;
+
+// Parse CONFIGURATION arguments exactly as the component's stand-alone
+// executable would and apply them
+template <typename T>
+static std::shared_ptr<T>
+configured(std::shared_ptr<T> component,
+           std::vector<std::string> args,
+           const std::vector<std::string> &sources_and_sink = {})
+{
+    po::options_description options;
+    component->appendOptions(options);
+
+    // Combiners read their IO from the option map
+    po::positional_options_description positional;
+    if (!sources_and_sink.empty()) {
+        options.add_options()
+            ("sources-and-sink", po::value<std::vector<std::string>>(), "");
+        positional.add("sources-and-sink", -1);
+        args.insert(args.begin(), sources_and_sink.begin(), sources_and_sink.end());
+    }
+
+    po::variables_map option_map;
+    po::store(po::command_line_parser(args)
+              .options(options)
+              .positional(positional)
+              .run(), option_map);
+    po::notify(option_map);
+
+    component->configure(option_map);
+
+    return component;
+}
+
+// Arguments of each [[stage]] in a pipeline file
+static std::vector<std::vector<std::string>>
+readStages(const std::string &file)
+{
+    // Will throw if file contains bad syntax
+    auto config = cpptoml::parse_file(file);
+
+    auto stages = config->get_table_array("stage");
+    if (!stages)
+        throw std::runtime_error("Pipeline file '" + file
+                                 + "' does not contain any [[stage]] tables.");
+
+    std::vector<std::vector<std::string>> all_args;
+    for (const auto &t : *stages) {
+
+        auto args = t->get_array_of<std::string>("args");
+        if (!args || args->empty())
+            throw std::runtime_error("Each [[stage]] must provide its "
+                                     "command and arguments as an 'args' "
+                                     "array of strings.");
+
+        all_args.push_back(*args);
+    }
+
+    return all_args;
+}
+
+// Split a stage's arguments into its SOURCEs and SINKs, which precede the
+// CONFIGURATION options, and the options themselves
+static void splitArgs(const std::vector<std::string> &args,
+                      std::vector<std::string> &io,
+                      std::vector<std::string> &config)
+{
+    auto opt = args.begin() + std::min<size_t>(args.size(), 2);
+    io.clear();
+    while (opt != args.end() && opt->compare(0, 1, "-") != 0)
+        io.push_back(*opt++);
+    config.assign(opt, args.end());
+}
+
+void Pipeline::load(const std::string &file)
+{
+    for (const auto &args : readStages(file))
+        addStage(args);
+}
+
+void Pipeline::addStage(const std::vector<std::string> &args)
+{
+    Stage s;
+    s.component = makeComponent(args);
+    stages_.push_back(s);
+
+    // Servers and generators only write. Every other stage reads all of its
+    // streams but the last.
+    std::vector<std::string> io, config;
+    splitArgs(args, io, config);
+    if (args[0] != "frameserve" && args[0] != "posigen")
+        read_.insert(io.begin(), io.end() - 1);
+    written_.insert(io.back());
+}
+
+void Pipeline::loadChunked(const std::string &file,
+                           const size_t num_chunks,
+                           const uint64_t overlap)
+{
+    const auto all_args = readStages(file);
+
+    // Find the video and the streams that leave the pipeline
+    const std::vector<std::string> *reader_args = nullptr;
+    std::set<std::string> frame_sinks, position_sinks;
+    std::map<std::string, size_t> readers;
+    for (const auto &args : all_args) {
+
+        const std::string &command = args[0];
+        const std::string type = args.size() > 1 ? args[1] : "";
+        std::vector<std::string> io, config;
+        splitArgs(args, io, config);
+        if (io.empty())
+            continue; // Reported by makeComponent()
+
+        if (command == "frameserve") {
+            if (type != "file" || reader_args != nullptr)
+                throw std::runtime_error("A chunked pipeline must be fed by "
+                                         "exactly one 'frameserve file' "
+                                         "stage.");
+            reader_args = &args;
+            frame_sinks.insert(io[0]);
+        } else if (command == "framefilt") {
+            readers[io[0]]++;
+            frame_sinks.insert(io.back());
+        } else if (command == "posigen") {
+            throw std::runtime_error("Position generators cannot be run in a "
+                                     "chunked pipeline.");
+        } else {
+            for (auto s = io.begin(); s != io.end() - 1; s++)
+                readers[*s]++;
+            position_sinks.insert(io.back());
+        }
+    }
+
+    if (reader_args == nullptr)
+        throw std::runtime_error("A chunked pipeline must be fed by exactly "
+                                 "one 'frameserve file' stage.");
+
+    // Frame streams cannot be joined, and offline, a stream that is never
+    // read would stall its chunk
+    for (const auto &f : frame_sinks) {
+        if (readers.count(f) == 0)
+            throw std::runtime_error("Frame stream '" + f + "' is not read by "
+                                     "any stage. Chunked pipelines can only "
+                                     "publish position streams.");
+    }
+
+    std::vector<std::string> outputs;
+    for (const auto &p : position_sinks) {
+        if (readers.count(p) == 0)
+            outputs.push_back(p);
+    }
+
+    if (outputs.empty())
+        throw std::runtime_error("A chunked pipeline must publish at least "
+                                 "one position stream that no stage reads.");
+
+    // Probe the video to find the chunk boundaries
+    std::vector<std::string> io, config;
+    splitArgs(*reader_args, io, config);
+    auto probe = configured(std::make_shared<oat::FileReader>(io[0]), config);
+
+    const uint64_t total = probe->frames_in_file();
+    if (total == 0)
+        throw std::runtime_error("The number of frames in the video is "
+                                 "unknown, so it cannot be chunked.");
+
+    const uint64_t n = std::min<uint64_t>(std::max<size_t>(num_chunks, 1), total);
+
+    std::vector<std::shared_ptr<oat::Stitcher>> stitchers;
+    for (const auto &o : outputs)
+        stitchers.push_back(
+            std::make_shared<oat::Stitcher>(o, probe->frames_per_second()));
+
+    // Offline, a SINK waits for the readers declared in OAT_OFFLINE before
+    // its first write. Declare the streams that several stages read so that
+    // none of them miss the start of their chunk.
+    const char *env = std::getenv("OAT_OFFLINE");
+    std::string offline = env != nullptr ? env : "1";
+
+    for (uint64_t k = 0; k < n; k++) {
+
+        const uint64_t first = total * k / n;
+        const uint64_t end = total * (k + 1) / n;
+        const uint64_t start = first - std::min(first, overlap);
+        const std::string suffix = "_chunk" + std::to_string(k);
+
+        for (const auto &r : readers) {
+            if (r.second > 1)
+                offline += "," + r.first + suffix + "=" + std::to_string(r.second);
+        }
+
+        for (const auto &args : all_args) {
+
+            // Give each chunk its own streams
+            splitArgs(args, io, config);
+            std::vector<std::string> chunk_args(
+                args.begin(), args.begin() + std::min<size_t>(args.size(), 2));
+            for (const auto &addr : io)
+                chunk_args.push_back(addr + suffix);
+            chunk_args.insert(chunk_args.end(), config.begin(), config.end());
+
+            if (&args == reader_args) {
+                chunk_args.insert(chunk_args.end(),
+                                  {"--start", std::to_string(start),
+                                   "--num-frames", std::to_string(end - start)});
+            }
+
+            addStage(chunk_args);
+        }
+
+        for (size_t i = 0; i < outputs.size(); i++) {
+            stitchers[i]->addChunk(outputs[i] + suffix, start, first);
+            read_.insert(outputs[i] + suffix);
+        }
+    }
+
+    setenv("OAT_OFFLINE", offline.c_str(), 1);
+
+    for (const auto &st : stitchers) {
+        Stage s;
+        s.component = st;
+        stages_.push_back(s);
+    }
+}
+
+size_t Pipeline::run()
+{
+    // Streams that start and end within the pipeline do not need shared
+    // memory. The rest are published for other processes.
+    if (!shared_memory_) {
+        for (const auto &addr : read_) {
+            if (written_.count(addr) > 0)
+                Channels::instance().enable(addr);
+        }
+    }
+
+    std::vector<std::thread> threads;
+
+    for (auto &s : stages_) {
+        threads.emplace_back([&s] {
+            try {
+                s.component->run();
+            } catch (const std::exception &ex) {
+                s.error = ex.what();
+            } catch (...) {
+                s.error = "Unknown exception.";
+            }
+
+            // A failed stage would otherwise leave its neighbours blocked
+            // on nodes that will never be written or read
+            if (!s.error.empty()) {
+                quit = 1;
+                wakeForShutdown();
+            }
+        });
+    }
+
+    for (auto &t : threads)
+        t.join();
+
+    size_t failed = 0;
+    for (const auto &s : stages_)
+        failed += !s.error.empty();
+
+    return failed;
+}
+
+std::shared_ptr<oat::Component>
+Pipeline::makeComponent(const std::vector<std::string> &args)
+{
+    const std::string &command = args[0];
+    const std::string type = args.size() > 1 ? args[1] : "";
+
+    // SOURCEs and SINKs precede the CONFIGURATION options
+    std::vector<std::string> io, config;
+    splitArgs(args, io, config);
+
+    auto require_io = [&](const size_t n, const char *names) {
+        if (io.size() != n)
+            throw std::runtime_error("Stage '" + command + " " + type
+                                     + "' requires " + names + ".");
+    };
+
+    if (command == "frameserve") {
+
+        require_io(1, "a SINK");
+        const std::string &sink = io[0];
+
+        if (type == "wcam")
+            return configured(std::make_shared<oat::WebCam>(sink), config);
+        if (type == "v4l2")
+            return configured(std::make_shared<oat::V4L2Cam>(sink), config);
+        if (type == "file")
+            return configured(std::make_shared<oat::FileReader>(sink), config);
+        if (type == "raw")
+            return configured(std::make_shared<oat::RawReader>(sink), config);
+        if (type == "images")
+            return configured(std::make_shared<oat::ImageSequence>(sink), config);
+        if (type == "test")
+            return configured(std::make_shared<oat::TestFrame>(sink), config);
+        if (type == "synth")
+            return configured(std::make_shared<oat::SyntheticFrame>(sink), config);
+#ifdef USE_FLYCAP
+        if (type == "gige")
+            return configured(
+                std::make_shared<oat::PointGreyCam<pg::GigECamera>>(sink), config);
+        if (type == "usb")
+            return configured(
+                std::make_shared<oat::PointGreyCam<pg::Camera>>(sink), config);
+#endif
+
+    } else if (command == "framefilt") {
+
+        require_io(2, "a SOURCE and a SINK");
+        const std::string &source = io[0];
+        const std::string &sink = io[1];
+
+        if (type == "bsub")
+            return configured(
+                std::make_shared<oat::BackgroundSubtractor>(source, sink), config);
+        if (type == "mask")
+            return configured(
+                std::make_shared<oat::FrameMasker>(source, sink), config);
+        if (type == "mog")
+            return configured(
+                std::make_shared<oat::BackgroundSubtractorMOG>(source, sink), config);
+        if (type == "undistort")
+            return configured(
+                std::make_shared<oat::Undistorter>(source, sink), config);
+        if (type == "col")
+            return configured(
+                std::make_shared<oat::ColorConvert>(source, sink), config);
+        if (type == "thresh")
+            return configured(
+                std::make_shared<oat::Threshold>(source, sink), config);
+
+    } else if (command == "posidet") {
+
+        require_io(2, "a SOURCE and a SINK");
+        const std::string &source = io[0];
+        const std::string &sink = io[1];
+
+        if (type == "diff")
+            return configured(
+                std::make_shared<oat::DifferenceDetector>(source, sink), config);
+        if (type == "hsv")
+            return configured(
+                std::make_shared<oat::HSVDetector>(source, sink), config);
+        if (type == "thresh")
+            return configured(
+                std::make_shared<oat::SimpleThreshold>(source, sink), config);
+
+    } else if (command == "posifilt") {
+
+        require_io(2, "a SOURCE and a SINK");
+        const std::string &source = io[0];
+        const std::string &sink = io[1];
+
+        if (type == "kalman")
+            return configured(
+                std::make_shared<oat::KalmanFilter2D>(source, sink), config);
+        if (type == "homography")
+            return configured(
+                std::make_shared<oat::HomographyTransform2D>(source, sink), config);
+        if (type == "region")
+            return configured(
+                std::make_shared<oat::RegionFilter2D>(source, sink), config);
+
+    } else if (command == "posicom") {
+
+        if (io.size() < 3)
+            throw std::runtime_error("Stage 'posicom " + type + "' requires at "
+                                     "least two SOURCEs and a SINK.");
+
+        if (type == "mean")
+            return configured(std::make_shared<oat::MeanPosition>(), config, io);
+
+    } else if (command == "posigen") {
+
+        require_io(1, "a SINK");
+        const std::string &sink = io[0];
+
+        if (type == "rand2D")
+            return configured(std::make_shared<oat::RandomAccel2D>(sink), config);
+
+    } else {
+        throw std::runtime_error("Command '" + command
+                                 + "' cannot be run as a pipeline stage.");
+    }
+
+    throw std::runtime_error("Invalid TYPE '" + type + "' for command '"
+                             + command + "'.");
+}
+
+} /* namespace oat */
@@ -0,0 +1,106 @@
+//******************************************************************************
+//* File:   Pipeline.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_PIPELINE_H
+#define	OAT_PIPELINE_H
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../../lib/base/Component.h"
+
+namespace oat {
+
+/**
+ * Several components running as threads of a single process. Each stage is
+ * described by the arguments its stand-alone executable would take. Streams
+ * that are both written and read by stages use in-process channels, which
+ * hand samples between threads without shared memory or copies. Streams that
+ * leave the pipeline still use shared memory nodes so that other processes
+ * (e.g. oat view or oat record) can attach to them.
+ */
+class Pipeline {
+
+    struct Stage {
+        std::shared_ptr<oat::Component> component;
+        std::string error;
+    };
+
+public:
+
+    /**
+     * Create and configure the component for each [[stage]] table in a
+     * pipeline file.
+     *
+     * @param file TOML pipeline file
+     */
+    void load(const std::string &file);
+
+    /**
+     * Split the video served by the pipeline's 'frameserve file' stage into
+     * time chunks and create an independent copy of the pipeline for each.
+     * Each chunk starts serving overlap frames early so that stateful stages
+     * are warmed up by its first frame. The position streams that no stage
+     * reads are joined back together, in order, under their original names.
+     *
+     * @param file TOML pipeline file
+     * @param num_chunks Number of chunks
+     * @param overlap Number of warm up frames served before each chunk
+     */
+    void loadChunked(const std::string &file,
+                     const size_t num_chunks,
+                     const uint64_t overlap);
+
+    /**
+     * Pass every stream through a shared memory node, as stand-alone
+     * components do, so that other processes can also attach to streams that
+     * stages read. Must be set before run().
+     */
+    void set_shared_memory(const bool value) { shared_memory_ = value; }
+
+    /**
+     * Run each stage on its own thread until all have exited. If a stage
+     * fails, the remaining stages are told to quit.
+     *
+     * @return Number of stages that failed
+     */
+    size_t run();
+
+    size_t num_stages() const { return stages_.size(); }
+    std::string name(const size_t i) const { return stages_[i].component->name(); }
+    std::string error(const size_t i) const { return stages_[i].error; }
+
+private:
+
+    static std::shared_ptr<oat::Component>
+    makeComponent(const std::vector<std::string> &args);
+
+    // Create a stage and note the streams it writes and reads
+    void addStage(const std::vector<std::string> &args);
+
+    std::vector<Stage> stages_;
+    std::set<std::string> written_, read_;
+    bool shared_memory_ {false};
+};
+
+}      /* namespace oat */
+#endif /* OAT_PIPELINE_H */
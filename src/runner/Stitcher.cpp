@@ -0,0 +1,146 @@
+//******************************************************************************
+//* File:   Stitcher.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "Stitcher.h"
+
+#include "../../lib/base/Globals.h"
+#include "../../lib/shmemdf/Source.h"
+
+namespace oat {
+
+Stitcher::Stitcher(const std::string &address, const double rate_hz)
+: name_("stitch[" + address + "]")
+, sample_(1.0 / rate_hz)
+, position_sink_address_(address)
+{
+    // Nothing
+}
+
+Stitcher::~Stitcher()
+{
+    // Collectors leave once their chunk ends or we are told to quit
+    for (auto &t : collectors_)
+        t.join();
+}
+
+void Stitcher::addChunk(const std::string &address,
+                        const uint64_t start,
+                        const uint64_t first)
+{
+    auto c = std::unique_ptr<Chunk>(new Chunk);
+    c->address = address;
+    c->start = start;
+    c->first = first;
+    chunks_.push_back(std::move(c));
+}
+
+bool Stitcher::connectToNode()
+{
+    // Chunks run concurrently, so later ones are buffered while earlier ones
+    // are being published
+    for (auto &c : chunks_)
+        collectors_.emplace_back(&Stitcher::collect, this, std::ref(*c));
+
+    position_sink_.bind(position_sink_address_, position_sink_address_);
+    shared_position_ = position_sink_.retrieve();
+
+    return true;
+}
+
+int Stitcher::process()
+{
+    oat::Position2D pos;
+
+    // Take the next position in time order
+    while (current_ < chunks_.size()) {
+
+        auto &c = *chunks_[current_];
+        std::unique_lock<std::mutex> lock(c.mutex);
+        c.ready.wait(lock, [&c] {
+            return !c.positions.empty() || c.done || quit;
+        });
+
+        if (quit)
+            return 1;
+
+        if (!c.positions.empty()) {
+            pos = c.positions.front();
+            c.positions.pop_front();
+            break;
+        }
+
+        // This chunk is exhausted
+        current_++;
+    }
+
+    if (current_ == chunks_.size())
+        return 1;
+
+    // Number the position as if the video was processed in one piece, but
+    // keep the time its frame was captured
+    sample_.incrementCount();
+    sample_.set_capture_ns(pos.sample().capture_ns());
+    pos.set_sample(sample_);
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    position_sink_.wait();
+
+    *shared_position_ = pos;
+
+    // Tell sources there is new data
+    position_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    return 0;
+}
+
+void Stitcher::collect(Chunk &chunk)
+{
+    oat::Source<oat::Position2D> source;
+    source.touch(chunk.address);
+
+    if (source.connect() == SourceState::CONNECTED) {
+
+        while (source.wait() != oat::NodeState::END && !quit) {
+
+            const auto pos = source.clone();
+            source.post();
+
+            // Sample counts start at 1 with the first frame served
+            const uint64_t frame = chunk.start + pos.sample_count() - 1;
+            if (frame < chunk.first)
+                continue;
+
+            std::lock_guard<std::mutex> lock(chunk.mutex);
+            chunk.positions.push_back(pos);
+            chunk.ready.notify_one();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(chunk.mutex);
+    chunk.done = true;
+    chunk.ready.notify_one();
+}
+
+} /* namespace oat */
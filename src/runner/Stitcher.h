@@ -0,0 +1,107 @@
+//******************************************************************************
+//* File:   Stitcher.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_STITCHER_H
+#define	OAT_STITCHER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../lib/base/Component.h"
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/shmemdf/Sink.h"
+
+namespace oat {
+
+/**
+ * Joins the position streams produced by pipelines that each processed one
+ * time chunk of a video back into a single stream. Positions a chunk
+ * produced while warming up on frames that belong to the previous chunk are
+ * discarded. The joined stream is numbered as if the video had been
+ * processed in one piece.
+ */
+class Stitcher : public Component {
+
+    struct Chunk {
+        std::string address;
+        uint64_t start;  //!< First frame served to the chunk
+        uint64_t first;  //!< First frame whose position is kept
+
+        std::deque<oat::Position2D> positions;
+        bool done {false};
+        std::mutex mutex;
+        std::condition_variable ready;
+    };
+
+public:
+
+    /**
+     * @param address Address of the joined position stream.
+     * @param rate_hz Sample rate of the video.
+     */
+    Stitcher(const std::string &address, const double rate_hz);
+    ~Stitcher();
+
+    /**
+     * @brief Add the next chunk's position stream. Chunks must be added in
+     * time order.
+     * @param address Address of the chunk's position stream.
+     * @param start Index of the first frame served to the chunk.
+     * @param first Index of the first frame whose position is kept.
+     */
+    void addChunk(const std::string &address,
+                  const uint64_t start,
+                  const uint64_t first);
+
+    // Component Interface
+    oat::ComponentType type(void) const override { return oat::positioncombiner; };
+    std::string name(void) const override { return name_; }
+
+private:
+    // Component Interface
+    bool connectToNode(void) override;
+    int process(void) override;
+
+    // Executed by one collector thread per chunk
+    void collect(Chunk &chunk);
+
+    // Stitcher name
+    std::string name_;
+
+    // Chunks, in time order, and the one being published
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+    size_t current_ {0};
+    std::vector<std::thread> collectors_;
+
+    // Joined positions are renumbered from this sample
+    oat::Sample sample_;
+
+    // Position SINK object for publishing the joined stream
+    oat::Position2D * shared_position_ {nullptr};
+    std::string position_sink_address_;
+    oat::Sink<oat::Position2D> position_sink_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_STITCHER_H */
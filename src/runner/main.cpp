@@ -0,0 +1,200 @@
+//******************************************************************************
+//* File:   oat run main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/program_options.hpp>
+#include <cpptoml.h>
+#include <opencv2/core.hpp>
+
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/ProgramOptions.h"
+
+#include "Pipeline.h"
+
+namespace po = boost::program_options;
+
+void printUsage(const po::options_description &options) {
+    std::cout <<
+    "Usage: run [INFO]\n"
+    "   or: run PIPELINE\n"
+    "Run the components described by the PIPELINE file as threads of a "
+    "single\nprocess. Each [[stage]] table in PIPELINE lists the arguments "
+    "that would be\npassed to the stand-alone component, beginning with its "
+    "command, e.g.\n\n"
+    "  [[stage]]\n"
+    "  args = [\"framefilt\", \"mog\", \"raw\", \"filt\", \"-c\", "
+    "\"config.toml\", \"mog\"]\n\n"
+    "Supported commands are frameserve, framefilt, posidet, posifilt, "
+    "posicom and\nposigen. Streams that stages both write and read are passed "
+    "between threads\nwithout shared memory. The rest are published to shared "
+    "memory, so other\ncomponents can attach to them as usual. Use --shmem to "
+    "publish every stream.\n\n"
+    "With --chunks, a pipeline fed by a 'frameserve file' stage is copied once "
+    "per\ntime chunk of the video and the copies run in parallel. The position "
+    "streams\nthat no stage reads are joined back together, in order, under "
+    "their original\nnames, e.g. for 'oat record'. Chunked pipelines always "
+    "run with OAT_OFFLINE=1.\n\n"
+    "PIPELINE:\n"
+    "  Path to a TOML pipeline file.\n";
+
+    std::cout << options << "\n";
+}
+
+int main(int argc, char *argv[]) {
+
+    std::string file;
+    std::string comp_name = "run";
+    size_t chunks = 0;
+    uint64_t overlap = 300;
+    oat::Pipeline pipeline;
+
+    po::options_description visible_options;
+
+    try {
+
+        po::options_description positional_opt_desc("POSITIONAL");
+        positional_opt_desc.add_options()
+            ("pipeline", po::value<std::string>(&file),
+             "Path to a TOML pipeline file.")
+            ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("pipeline", 1);
+
+        po::options_description stream_opt_desc("STREAMS");
+        stream_opt_desc.add_options()
+            ("shmem",
+             "Publish every stream to shared memory, as stand-alone "
+             "components do, so that other components can attach to streams "
+             "that stages read. By default, these streams are passed between "
+             "threads without shared memory.")
+            ;
+
+        po::options_description chunk_opt_desc("OFFLINE");
+        chunk_opt_desc.add_options()
+            ("chunks,j", po::value<size_t>(&chunks),
+             "Split the video into this many time chunks and process them in "
+             "parallel. 0 for one chunk per CPU.")
+            ("overlap", po::value<uint64_t>(&overlap),
+             "Number of frames each chunk processes before its first frame "
+             "so that stateful stages (e.g. kalman filters and background "
+             "models) are warmed up. Defaults to 300.")
+            ;
+
+        // Visible options for help message
+        visible_options.add(oat::config::ComponentInfo::instance()->get())
+                       .add(stream_opt_desc)
+                       .add(chunk_opt_desc);
+
+        // All options, including positional
+        po::options_description options;
+        options.add(positional_opt_desc)
+               .add(oat::config::ComponentInfo::instance()->get())
+               .add(stream_opt_desc)
+               .add(chunk_opt_desc);
+
+        po::variables_map option_map;
+        po::store(po::command_line_parser(argc, argv)
+                  .options(options)
+                  .positional(positional_options)
+                  .run(), option_map);
+        po::notify(option_map);
+
+        // Check INFO arguments
+        if (option_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (option_map.count("version")) {
+            std::cout << oat::config::VERSION_STRING;
+            return 0;
+        }
+
+        if (!option_map.count("pipeline")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("A PIPELINE must be specified.\n");
+            return -1;
+        }
+
+        comp_name = "run[" + file + "]";
+
+        // Create and configure every stage before any of them start
+        if (option_map.count("chunks")) {
+
+            // Chunks must not drop frames at their boundaries
+            setenv("OAT_OFFLINE", "1", 1);
+
+            if (chunks == 0)
+                chunks = std::max(1u, std::thread::hardware_concurrency());
+
+            pipeline.loadChunked(file, chunks, overlap);
+
+        } else {
+            pipeline.load(file);
+        }
+
+        pipeline.set_shared_memory(option_map.count("shmem") > 0);
+
+        // Tell user
+        for (size_t i = 0; i < pipeline.num_stages(); i++)
+            std::cout << oat::whoMessage(comp_name,
+                         "Running " + pipeline.name(i) + ".\n");
+        std::cout << oat::whoMessage(comp_name, "Press CTRL+C to exit.\n");
+
+        // Run until ctrl-c or every stage reaches the end of its stream
+        const size_t failed = pipeline.run();
+
+        for (size_t i = 0; i < pipeline.num_stages(); i++) {
+            if (!pipeline.error(i).empty())
+                std::cerr << oat::whoError(pipeline.name(i), pipeline.error(i))
+                          << std::endl;
+        }
+
+        // Tell user
+        std::cout << oat::whoMessage(comp_name, "Exiting.")
+                  << std::endl;
+
+        return failed == 0 ? 0 : -1;
+
+    } catch (const po::error &ex) {
+        printUsage(visible_options);
+        std::cerr << oat::whoError(comp_name, ex.what()) << std::endl;
+    } catch (const cpptoml::parse_exception &ex) {
+        std::cerr << oat::whoError(comp_name + "(TOML) ", ex.what()) << std::endl;
+    } catch (const cv::Exception &ex) {
+        std::cerr << oat::whoError(comp_name + "(OPENCV) ", ex.what()) << std::endl;
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+        std::cerr << oat::whoError(comp_name + "(SHMEM) ", ex.what()) << std::endl;
+    } catch (const std::runtime_error &ex) {
+        std::cerr << oat::whoError(comp_name, ex.what()) << std::endl;
+    } catch (...) {
+        std::cerr << oat::whoError(comp_name, "Unknown exception.")
+                  << std::endl;
+    }
+
+    // Exit failure
+    return -1;
+}
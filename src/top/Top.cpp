@@ -0,0 +1,227 @@
+//******************************************************************************
+//* File:   Top.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "Top.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+#include "../../lib/shmemdf/Registry.h"
+
+namespace oat {
+
+static const std::string NODE_SUFFIX = "_node";
+
+// Sink wait fraction above which a node's readers are holding it back
+static constexpr double STALL_THRESHOLD {0.5};
+
+// Fraction of an interval of dt seconds covered by ns nanoseconds. Blocking
+// periods straddle refreshes, so this can slightly exceed 1.
+static double fraction(const uint64_t ns, const double dt)
+{
+    return std::min(1.0, ns / 1e9 / dt);
+}
+
+void Top::scan()
+{
+    std::set<std::string> present;
+    for (const auto &e : Registry::instance().list())
+        present.insert(e.name);
+
+    // Forget nodes that have left the registry
+    for (auto it = nodes_.begin(); it != nodes_.end(); ) {
+        if (present.count(it->first) == 0)
+            it = nodes_.erase(it);
+        else
+            ++it;
+    }
+
+    // Attach read-only to new nodes
+    for (const auto &name : present) {
+
+        if (nodes_.count(name))
+            continue;
+
+        Attached a;
+        try {
+            a.shmem.reset(new bip::managed_shared_memory(
+                bip::open_read_only, (name + NODE_SUFFIX).c_str()));
+            a.node = Node::findReadOnly(*a.shmem);
+        } catch (const bip::interprocess_exception &) {
+            // Not a managed segment or we are not allowed to read it
+            continue;
+        }
+
+        if (a.node != nullptr)
+            nodes_.emplace(name, std::move(a));
+    }
+}
+
+std::string Top::report()
+{
+    std::ostringstream out;
+    std::ostringstream stalls;
+    char line[256];
+
+    std::snprintf(line, sizeof(line), "%-16s %-6s %-24s %9s %9s %8s %5s %10s\n",
+                  "NODE", "STATE", "SINK", "RATE (Hz)", "SINK WAIT",
+                  "READERS", "DEPTH", "LAST WRITE");
+    out << line;
+
+    const uint64_t now = telemetry::now();
+
+    for (auto &kv : nodes_) {
+
+        const std::string &name = kv.first;
+        Attached &a = kv.second;
+        const Node &node = *a.node;
+        const auto &t = node.telemetry();
+
+        NodeSnapshot snap;
+        snap.time_ns = now;
+        snap.writes = node.write_number();
+        snap.sink_wait_ns = t.sink_wait_ns;
+        snap.skipped = t.skipped;
+
+        const double dt = a.last.time_ns > 0 ? (now - a.last.time_ns) / 1e9 : 0;
+        const double rate = dt > 0 ? (snap.writes - a.last.writes) / dt : 0;
+        const double sink_wait = dt > 0
+            ? fraction(snap.sink_wait_ns - a.last.sink_wait_ns, dt) : 0;
+
+        const char *state = "?";
+        switch (node.sink_state()) {
+            case NodeState::UNDEFINED:  state = "WAIT"; break;
+            case NodeState::SINK_BOUND: state = "BOUND"; break;
+            case NodeState::END:        state = "END"; break;
+            case NodeState::ERROR:      state = "ERROR"; break;
+        }
+
+        char readers[32], last_write[32];
+        std::snprintf(readers, sizeof(readers), "%zu/%zu",
+                      node.source_ref_count(), node.num_slots());
+        if (t.last_write_ns > 0)
+            std::snprintf(last_write, sizeof(last_write), "%.3f s",
+                          (now - t.last_write_ns) / 1e9);
+        else
+            std::snprintf(last_write, sizeof(last_write), "never");
+
+        std::snprintf(line, sizeof(line),
+                      "%-16s %-6s %-24s %9.1f %8.0f%% %8s %5zu %10s\n",
+                      name.c_str(), state,
+                      processName(t.sink_pid).c_str(), rate,
+                      100 * sink_wait, readers, node.depth(), last_write);
+        out << line;
+
+        // Per-slot statistics
+        size_t slowest = node.num_slots();
+        double slowest_latency = -1;
+
+        for (size_t i = 0; i < node.num_slots(); i++) {
+
+            if (!node.slot_bound(i))
+                continue;
+
+            const auto &st = node.slot_telemetry(i);
+            SlotSnapshot s;
+            s.pid = st.pid;
+            s.reads = st.reads;
+            s.read_latency_ns = st.read_latency_ns;
+            s.wait_ns = st.wait_ns;
+            snap.slots[i] = s;
+
+            // A new owner resets the slot's counters
+            SlotSnapshot l;
+            auto prev = a.last.slots.find(i);
+            if (prev != a.last.slots.end() && prev->second.pid == s.pid
+                && prev->second.reads <= s.reads)
+                l = prev->second;
+
+            const uint64_t reads = s.reads - l.reads;
+            const double read_rate = dt > 0 ? reads / dt : 0;
+            const double latency_ms = reads > 0
+                ? (s.read_latency_ns - l.read_latency_ns) / 1e6 / reads : 0;
+            const double wait = dt > 0 ? fraction(s.wait_ns - l.wait_ns, dt) : 0;
+
+            // A reader that has not finished a read all interval is the
+            // slowest, no matter what its past reads looked like
+            const double rank = reads == 0 ? 1e12 : latency_ms;
+            if (rank > slowest_latency) {
+                slowest_latency = rank;
+                slowest = i;
+            }
+
+            std::snprintf(line, sizeof(line),
+                          "  slot %-9zu %-24s reads %8.1f Hz  latency %8.2f ms  wait %3.0f%%\n",
+                          i, processName(s.pid).c_str(), read_rate, latency_ms,
+                          100 * wait);
+            out << line;
+        }
+
+        // Lossy readers have no slots, so only their combined skips are known
+        if (node.lossy_ref_count() > 0) {
+            const double skip_rate = dt > 0 && snap.skipped >= a.last.skipped
+                ? (snap.skipped - a.last.skipped) / dt : 0;
+            std::snprintf(line, sizeof(line),
+                          "  lossy %-8zu %-24s skips %8.1f Hz\n",
+                          node.lossy_ref_count(), "", skip_rate);
+            out << line;
+        }
+
+        // Stall attribution: a SINK that spends most of its time waiting is
+        // being held back by its slowest reader
+        if (dt > 0 && sink_wait > STALL_THRESHOLD && slowest < node.num_slots()) {
+            const auto &s = snap.slots[slowest];
+            stalls << "  '" << name << "' sink waits "
+                   << static_cast<int>(100 * sink_wait)
+                   << "% of the time. Slowest reader: slot " << slowest << ", "
+                   << processName(s.pid);
+            if (slowest_latency >= 1e12)
+                stalls << ", no reads completed.\n";
+            else
+                stalls << ", " << std::fixed << std::setprecision(2)
+                       << slowest_latency << " ms per read.\n";
+        }
+
+        a.last = snap;
+    }
+
+    if (!stalls.str().empty())
+        out << "\nStalls:\n" << stalls.str();
+
+    return out.str();
+}
+
+std::string Top::processName(const int32_t pid)
+{
+    if (pid <= 0)
+        return "-";
+
+    std::string comm;
+    std::ifstream f("/proc/" + std::to_string(pid) + "/comm");
+    if (!std::getline(f, comm))
+        comm = "<exited>";
+
+    return comm + " (" + std::to_string(pid) + ")";
+}
+
+}      /* namespace oat */
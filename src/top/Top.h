@@ -0,0 +1,85 @@
+//******************************************************************************
+//* File:   Top.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_TOP_H
+#define	OAT_TOP_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+
+#include "../../lib/shmemdf/Node.h"
+
+namespace oat {
+
+/**
+ * Read-only monitor of the telemetry blocks of every node in shared memory.
+ */
+class Top {
+
+    // Counters at the time of the last refresh
+    struct SlotSnapshot {
+        int32_t pid {0};
+        uint64_t reads {0};
+        uint64_t read_latency_ns {0};
+        uint64_t wait_ns {0};
+    };
+
+    struct NodeSnapshot {
+        uint64_t time_ns {0};
+        uint64_t writes {0};
+        uint64_t sink_wait_ns {0};
+        uint64_t skipped {0};
+        std::map<size_t, SlotSnapshot> slots;
+    };
+
+    struct Attached {
+        std::unique_ptr<bip::managed_shared_memory> shmem;
+        const oat::Node *node {nullptr};
+        NodeSnapshot last;
+    };
+
+public:
+
+    /**
+     * Find nodes that have been created or destroyed since the last call.
+     */
+    void scan();
+
+    /**
+     * Update statistics for all attached nodes and produce a report. Rates
+     * are computed over the time since the previous call.
+     */
+    std::string report();
+
+    size_t num_nodes() const { return nodes_.size(); }
+
+private:
+
+    static std::string processName(const int32_t pid);
+
+    // Nodes, keyed by stream name
+    std::map<std::string, Attached> nodes_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_TOP_H */
@@ -0,0 +1,140 @@
+//******************************************************************************
+//* File:   oat top main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <boost/program_options.hpp>
+
+#include "Top.h"
+
+#include "../../lib/utility/IOFormat.h"
+
+namespace po = boost::program_options;
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: top [INFO]\n"
+              << "   or: top [CONFIGURATION]\n"
+              << "Monitor the throughput of all shared memory nodes and find "
+                 "the components\nthat are stalling them. Attaches read-only "
+                 "and can be run at any time.\n\n"
+              << "SINK WAIT is the fraction of time the node's SINK spends "
+                 "waiting for its\nSOURCEs to finish reading. Each reader's "
+                 "latency is the time from the SINK\nwriting to the SOURCE "
+                 "finishing its read. Its wait is the fraction of time it\n"
+                 "spends waiting for the SINK to write.\n\n"
+              << options << "\n";
+}
+
+int main(int argc, char *argv[]) {
+
+    double interval = 1.0;
+    int iterations = 0;
+    bool batch = false;
+
+    try {
+
+        po::options_description options("INFO");
+        options.add_options()
+            ("help", "Produce help message.")
+            ("version,v", "Print version information.")
+            ;
+
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+            ("interval,i", po::value<double>(&interval),
+             "Seconds between refreshes. Defaults to 1.")
+            ("iterations,n", po::value<int>(&iterations),
+             "Number of refreshes before exiting. Defaults to 0, which runs "
+             "until interrupted.")
+            ("batch,b", "Batch mode. Print each refresh below the last "
+             "instead of redrawing the screen.")
+            ;
+
+        po::options_description visible_options("OPTIONS");
+        visible_options.add(options).add(config);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(visible_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        // Use the parsed options
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Top version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (interval <= 0)
+            throw std::runtime_error("Interval must be positive.");
+
+        if (variable_map.count("batch"))
+            batch = true;
+
+        oat::Top top;
+
+        // Rates need two samples
+        top.scan();
+        top.report();
+
+        for (int i = 0; iterations == 0 || i < iterations; i++) {
+
+            std::this_thread::sleep_for(std::chrono::duration<double>(interval));
+
+            const std::string report = top.report();
+
+            // Clear the screen and move to the top left
+            if (!batch)
+                std::cout << "\033[2J\033[H";
+
+            std::cout << "oat top - " << top.num_nodes() << " nodes, "
+                      << interval << " s interval\n\n"
+                      << report << std::endl;
+
+            // Pick up nodes that appeared or disappeared for the next interval
+            top.scan();
+        }
+
+    } catch (std::exception& e) {
+        std::cerr << oat::Error(e.what()) << "\n";
+        return -1;
+    } catch (...) {
+        std::cerr << oat::Error("Exception of unknown type.\n");
+        return -1;
+    }
+
+    // Exit
+    return 0;
+}
@@ -51,8 +51,9 @@ Viewer<T>::~Viewer()
 template <typename T>
 bool Viewer<T>::connectToNode()
 {
-    // Establish our a slot in the node
-    source_.touch(source_address_);
+    // Viewers are monitors and should never hold back the processing
+    // pipeline, so they only ever look at the latest sample
+    source_.touch(source_address_, oat::SourceMode::LOSSY);
 
     // Wait for synchronous start with sink when it binds the node
     if (source_.connect() != SourceState::CONNECTED)
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""Compare detected positions to the true positions of 'oat frameserve synth'.
+
+Usage: accuracy.py TRUTH.json DETECTED.json [RADIUS]
+
+Positions are matched by sample number. Detections further than RADIUS
+pixels (default 15) from the truth are counted as misses and are excluded
+from the error statistics.
+"""
+
+import json
+import math
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        return {p['tick']: p for p in json.load(f)['positions']}
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+
+    truth = load(sys.argv[1])
+    detected = load(sys.argv[2])
+    radius = float(sys.argv[3]) if len(sys.argv) > 3 else 15.0
+
+    errors = []
+    misses = 0
+    for tick, t in truth.items():
+        d = detected.get(tick)
+        if d is None or not d['pos_ok']:
+            misses += 1
+            continue
+        e = math.hypot(d['pos_xy'][0] - t['pos_xy'][0],
+                       d['pos_xy'][1] - t['pos_xy'][1])
+        if e > radius:
+            misses += 1
+        else:
+            errors.append(e)
+
+    n = len(truth)
+    print('Samples:        {}'.format(n))
+    print('Detection rate: {:.2f} %'.format(100.0 * len(errors) / n if n else 0))
+    if errors:
+        rms = math.sqrt(sum(e * e for e in errors) / len(errors))
+        print('RMS error:      {:.3f} px'.format(rms))
+        print('Max error:      {:.3f} px'.format(max(errors)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,150 @@
+//******************************************************************************
+//* File:   node-fanout.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+// Fan-out cost of a node as the number of SOURCEs grows.
+//
+// A Sink<uint64_t> writes to a node that is read by N SOURCEs, each in its
+// own forked process. For each N, two things are measured:
+//
+// 1. Sink post() cost, which grows with the number of SOURCEs that must be
+//    told about the write
+// 2. End-to-end write rate with every SOURCE reading every write
+//
+// Usage: node-fanout [num-writes] [max-sources]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+// Global via extern in Globals.h
+namespace oat { volatile sig_atomic_t quit = 0; }
+
+namespace bip = boost::interprocess;
+
+using Clock = std::chrono::steady_clock;
+
+static const char *address = "oat_node_fanout";
+
+static int reader(uint64_t num_writes, int ready_fd)
+{
+    oat::Source<uint64_t> source;
+    source.touch(address);
+    if (source.connect() != oat::SourceState::CONNECTED)
+        return 1;
+
+    // Tell the sink that this source will read every write
+    const char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1)
+        return 1;
+
+    int errors = 0;
+    for (uint64_t i = 0; i < num_writes; i++) {
+        if (source.wait() == oat::NodeState::END)
+            break;
+        if (*source.retrieve() != i)
+            errors++;
+        source.post();
+    }
+
+    return errors > 0;
+}
+
+static void benchmark(size_t num_sources, uint64_t num_writes)
+{
+    bip::shared_memory_object::remove((std::string(address) + "_node").c_str());
+    bip::shared_memory_object::remove((std::string(address) + "_obj").c_str());
+
+    oat::Sink<uint64_t> sink;
+    sink.bind(address);
+    uint64_t *shared = sink.retrieve();
+
+    int ready[2];
+    if (pipe(ready) != 0)
+        throw std::runtime_error("Could not create pipe.");
+
+    std::vector<pid_t> pids;
+    for (size_t i = 0; i < num_sources; i++) {
+        pid_t pid = fork();
+        if (pid == 0)
+            _exit(reader(num_writes, ready[1])); // Source releases its slot first
+        pids.push_back(pid);
+    }
+
+    // Start once all sources are connected
+    for (size_t i = 0; i < num_sources; i++) {
+        char c;
+        if (read(ready[0], &c, 1) != 1)
+            throw std::runtime_error("Source failed to connect.");
+    }
+    close(ready[0]);
+    close(ready[1]);
+
+    double post_ns = 0;
+    const auto start = Clock::now();
+
+    for (uint64_t i = 0; i < num_writes; i++) {
+
+        sink.wait();
+        *shared = i;
+
+        const auto t0 = Clock::now();
+        sink.post();
+        post_ns += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    }
+
+    // Wait for the last write to be read
+    sink.wait();
+    const double sec = std::chrono::duration<double>(Clock::now() - start).count();
+
+    int failed = 0;
+    for (auto pid : pids) {
+        int status;
+        waitpid(pid, &status, 0);
+        failed += !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+
+    std::printf("  %8zu %14.2f %17.0f %10d\n",
+                num_sources, post_ns / num_writes / 1e3, num_writes / sec, failed);
+}
+
+int main(int argc, char *argv[])
+{
+    const uint64_t num_writes = argc > 1 ? std::stoull(argv[1]) : 10000;
+    const size_t max_sources = argc > 2 ? std::stoul(argv[2]) : 128;
+
+    // Nodes must be created with enough slots
+    setenv("OAT_NODE_SLOTS", std::to_string(max_sources).c_str(), 1);
+
+    std::printf("%llu writes\n", static_cast<unsigned long long>(num_writes));
+    std::printf("  %8s %14s %17s %10s\n", "sources", "post (us)", "writes / sec", "failed");
+
+    for (size_t n = 1; n <= max_sources; n *= 2)
+        benchmark(n, num_writes);
+
+    return 0;
+}
@@ -0,0 +1,12 @@
+# Usage: posidet-accuracy.sh TYPE [CONFIGURATION]
+# Detects blobs served by 'oat frameserve synth' and compares the detected
+# positions to the true ones
+export OAT_OFFLINE=1
+type=$1
+shift
+oat posidet $type raw pos "$@" &
+oat record -p truth pos -n accuracy -o &
+sleep 1
+time oat frameserve synth raw -t truth -c test.toml synth
+wait
+python3 accuracy.py truth_accuracy.json pos_accuracy.json
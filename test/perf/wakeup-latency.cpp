@@ -0,0 +1,193 @@
+//******************************************************************************
+//* File:   wakeup-latency.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+// Cross-process wakeup latency of the node synchronization primitives.
+//
+// Compares the old bip::interprocess_semaphore path, which waited using
+// 10 ms timed_wait()s so that it could poll for quit and NodeState::END, to
+// oat::Semaphore, which blocks on a futex until post() or broadcast(). Three
+// things are measured using a forked waiter process:
+//
+// 1. post() to wakeup latency
+// 2. Latency to notice an END/quit condition
+// 3. Spurious wakeups per second while idle
+//
+// Usage: wakeup-latency [num-posts]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/sync/interprocess_semaphore.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "../../lib/shmemdf/Semaphore.h"
+
+namespace bip = boost::interprocess;
+using Clock = std::chrono::steady_clock;
+
+static constexpr size_t MAX_SAMPLES {100000};
+static constexpr size_t END_SAMPLES {50};
+
+struct Shared {
+    bip::interprocess_semaphore bip_go {0}, bip_ack {0};
+    oat::Semaphore oat_go {0}, oat_ack {0};
+    std::atomic<int> end {0};
+    std::atomic<int64_t> t0 {0};
+    std::atomic<uint64_t> loops {0};
+    int64_t latency_ns[MAX_SAMPLES];
+};
+
+static int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now().time_since_epoch()).count();
+}
+
+// Waiter side of each primitive. Returns false if END was noticed.
+static bool waitBip(Shared *s, bip::interprocess_semaphore &sem)
+{
+    boost::system_time timeout = boost::get_system_time()
+                                 + boost::posix_time::milliseconds(10);
+    while (!sem.timed_wait(timeout)) {
+        s->loops++;
+        if (s->end)
+            return false;
+        timeout = boost::get_system_time() + boost::posix_time::milliseconds(10);
+    }
+    return true;
+}
+
+static bool waitOat(Shared *s, oat::Semaphore &sem)
+{
+    // The abort condition is checked once before sleeping, which is not a
+    // wakeup
+    bool slept = false;
+    return sem.wait([s, &slept] {
+        if (slept)
+            s->loops++;
+        slept = true;
+        return s->end.load() != 0;
+    });
+}
+
+static void report(const char *name, std::vector<int64_t> v)
+{
+    std::sort(v.begin(), v.end());
+    double sum = 0;
+    for (auto x : v)
+        sum += x;
+
+    auto pct = [&v](double p) { return v[static_cast<size_t>(p * (v.size() - 1))] / 1e3; };
+    std::printf("  %-22s mean %9.1f  p50 %9.1f  p99 %9.1f  max %9.1f  (us, n=%zu)\n",
+                name, sum / v.size() / 1e3, pct(0.5), pct(0.99), pct(1.0), v.size());
+}
+
+template <typename Wait, typename Post, typename Broadcast>
+static void benchmark(const char *name, Shared *s, size_t n,
+                      Wait wait, Post post, Broadcast broadcast)
+{
+    std::printf("%s\n", name);
+
+    // 1. Post to wakeup latency
+    s->end = 0;
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (size_t i = 0; i < n; i++) {
+            wait(s, 0);
+            s->latency_ns[i] = now() - s->t0;
+            post(s, 1);
+        }
+        _exit(0);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        // Give the waiter time to block
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        s->t0 = now();
+        post(s, 0);
+        wait(s, 1);
+    }
+    waitpid(pid, nullptr, 0);
+    report("post -> wake", std::vector<int64_t>(s->latency_ns, s->latency_ns + n));
+
+    // 2. END notice latency
+    for (size_t i = 0; i < END_SAMPLES; i++) {
+        s->end = 0;
+        pid = fork();
+        if (pid == 0) {
+            wait(s, 0);
+            s->latency_ns[i] = now() - s->t0;
+            _exit(0);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        s->t0 = now();
+        s->end = 1;
+        broadcast(s);
+        waitpid(pid, nullptr, 0);
+    }
+    report("END -> notice", std::vector<int64_t>(s->latency_ns, s->latency_ns + END_SAMPLES));
+
+    // 3. Idle wakeups
+    s->end = 0;
+    s->loops = 0;
+    pid = fork();
+    if (pid == 0) {
+        wait(s, 0);
+        _exit(0);
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    const unsigned long long idle_loops = s->loops;
+    s->end = 1;
+    broadcast(s);
+    waitpid(pid, nullptr, 0);
+    std::printf("  %-22s %llu\n\n", "idle wakeups / sec", idle_loops);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n = argc > 1 ? std::min<size_t>(std::stoul(argv[1]), MAX_SAMPLES) : 10000;
+
+    const char *name = "oat_wakeup_latency";
+    bip::shared_memory_object::remove(name);
+    bip::managed_shared_memory shmem(bip::create_only, name, 1024 + sizeof(Shared) * 2);
+    Shared *s = shmem.construct<Shared>("shared")();
+
+    benchmark("bip::interprocess_semaphore with 10 ms timed_wait (previous)", s, n,
+        [](Shared *s, int i) { return waitBip(s, i == 0 ? s->bip_go : s->bip_ack); },
+        [](Shared *s, int i) { (i == 0 ? s->bip_go : s->bip_ack).post(); },
+        [](Shared *) { /* Waiters poll */ });
+
+    benchmark("oat::Semaphore futex", s, n,
+        [](Shared *s, int i) { return waitOat(s, i == 0 ? s->oat_go : s->oat_ack); },
+        [](Shared *s, int i) { (i == 0 ? s->oat_go : s->oat_ack).post(); },
+        [](Shared *s) { s->oat_go.broadcast(); });
+
+    bip::shared_memory_object::remove(name);
+    return 0;
+}
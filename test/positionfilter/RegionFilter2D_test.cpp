@@ -0,0 +1,104 @@
+//******************************************************************************
+//* File:   RegionFilter2D_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "../../src/positionfilter/RegionFilter2D.h"
+
+namespace po = boost::program_options;
+
+const std::string config_file {"/tmp/RegionFilter2D_test.toml"};
+
+// Configure a region filter from the 'filt' table of config
+static void configure(oat::RegionFilter2D &filter, const std::string &config)
+{
+    std::ofstream(config_file) << config;
+
+    po::options_description options;
+    filter.appendOptions(options);
+
+    const std::vector<std::string> args {"--config", config_file, "filt"};
+    po::variables_map vm;
+    po::store(po::command_line_parser(args).options(options).run(), vm);
+    po::notify(vm);
+
+    filter.configure(vm);
+    std::remove(config_file.c_str());
+}
+
+SCENARIO ("Region filters read regions from their own sub-table.", "[RegionFilter2D]") {
+
+    GIVEN ("A region filter") {
+
+        oat::RegionFilter2D filter("pos", "rpos");
+
+        WHEN ("Its config has scheduling options alongside a regions table") {
+
+            const std::string config =
+                "[filt]\n"
+                "mlock = true\n"
+                "cpus = [0]\n"
+                "jitter = true\n"
+                "[filt.regions]\n"
+                "R0 = [[0.0, 0.0], [10.0, 0.0], [10.0, 10.0], [0.0, 10.0]]\n"
+                "R1 = [[10.0, 0.0], [20.0, 0.0], [20.0, 10.0], [10.0, 10.0]]\n";
+
+            THEN ("Only the regions are regions") {
+                REQUIRE_NOTHROW( configure(filter, config); );
+                REQUIRE( filter.region_ids().size() == 2 );
+
+                const auto &sched
+                    = static_cast<const oat::Schedulable &>(filter).scheduling();
+                REQUIRE( sched.lock_memory );
+                REQUIRE( sched.cpus == std::vector<int>{0} );
+            }
+        }
+
+        WHEN ("Its config has a region outside of the regions table") {
+
+            const std::string config =
+                "[filt]\n"
+                "R0 = [[0.0, 0.0], [10.0, 0.0], [10.0, 10.0], [0.0, 10.0]]\n";
+
+            THEN ("Configuration shall throw") {
+                REQUIRE_THROWS( configure(filter, config); );
+            }
+        }
+
+        WHEN ("Its regions table holds something that is not a region") {
+
+            const std::string config =
+                "[filt]\n"
+                "[filt.regions]\n"
+                "R0 = 1.0\n";
+
+            THEN ("Configuration shall throw") {
+                REQUIRE_THROWS( configure(filter, config); );
+            }
+        }
+    }
+}
@@ -0,0 +1,372 @@
+//******************************************************************************
+//* File:   Channel_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../../lib/shmemdf/Channel.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+#include "../../lib/shmemdf/SourceSet.h"
+
+// Global via extern in Globals.h
+namespace oat { volatile sig_atomic_t quit = 0; }
+
+const std::string node_addr = "test_channel";
+
+// Streams are enabled the way oat run enables the streams that its stages
+// both write and read
+static void enable(const std::string &address)
+{
+    oat::Channels::instance().enable(address);
+}
+
+static bool hasNode(const std::string &address)
+{
+    return access(("/dev/shm/" + address + "_node").c_str(), F_OK) == 0;
+}
+
+SCENARIO ("Streams enabled for a channel do not use shared memory.", "[Channel]") {
+
+    GIVEN ("A bound Sink<int> and a connected Source<int> on an enabled stream") {
+
+        enable(node_addr);
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+
+        oat::Source<int> source;
+        source.touch(node_addr);
+        source.connect();
+
+        THEN ("No node is created") {
+            REQUIRE_FALSE( hasNode(node_addr) );
+        }
+    }
+
+    GIVEN ("A bound Sink<int> on a stream that is not enabled") {
+
+        oat::Sink<int> sink;
+        sink.bind("test_node");
+
+        THEN ("A node is created") {
+            REQUIRE( hasNode("test_node") );
+        }
+    }
+}
+
+SCENARIO ("Synchronous channel sources read every write in order.", "[Channel]") {
+
+    GIVEN ("A Sink<int> and two synchronous Source<int>s on a channel") {
+
+        enable(node_addr);
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+        int *shared = sink.retrieve();
+
+        oat::Source<int> source0, source1;
+        source0.touch(node_addr);
+        source1.touch(node_addr);
+        source0.connect();
+        source1.connect();
+
+        WHEN ("The sink writes 100 times while the sources read") {
+
+            const int n = 100;
+            std::thread writer([&] {
+                for (int i = 1; i <= n; i++) {
+                    sink.wait();
+                    *shared = i;
+                    sink.post();
+                }
+            });
+
+            std::vector<int> read0, read1;
+            auto read = [n](oat::Source<int> &s, std::vector<int> &read) {
+                for (int i = 0; i < n; i++) {
+                    s.wait();
+                    read.push_back(s.clone());
+                    s.post();
+                }
+            };
+
+            std::thread reader(read, std::ref(source1), std::ref(read1));
+            read(source0, read0);
+            reader.join();
+            writer.join();
+
+            THEN ("Each source reads every write once, in order") {
+                for (int i = 0; i < n; i++) {
+                    REQUIRE( read0[i] == i + 1 );
+                    REQUIRE( read1[i] == i + 1 );
+                }
+                REQUIRE( source0.write_number() == n );
+                REQUIRE( source0.dropped() == 0 );
+            }
+        }
+    }
+}
+
+SCENARIO ("Channel sinks wait for synchronous sources that are a ring behind.", "[Channel]") {
+
+    GIVEN ("A Sink<Frame> of depth 2 and a synchronous Source<Frame>") {
+
+        enable(node_addr);
+
+        oat::Sink<oat::Frame> sink;
+        sink.bind(node_addr, 100, 2);
+        oat::Frame *frame = sink.retrieve(10, 10, CV_8UC1, oat::PIX_GREY);
+
+        oat::Source<oat::Frame> source;
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink writes twice without the source reading") {
+
+            for (int i = 1; i <= 2; i++) {
+                sink.wait();
+                frame->data[0] = i;
+                sink.post();
+            }
+
+            std::atomic<bool> written {false};
+            std::thread writer([&] {
+                sink.wait();
+                frame->data[0] = 3;
+                written = true;
+                sink.post();
+            });
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+            THEN ("The third write waits until the source reads") {
+
+                REQUIRE_FALSE( written );
+
+                source.wait();
+                REQUIRE( source.retrieve()->data[0] == 1 );
+                source.post();
+                writer.join();
+
+                REQUIRE( written );
+            }
+        }
+    }
+}
+
+SCENARIO ("Channel sources read frames in place.", "[Channel, SharedFrameHeader]") {
+
+    GIVEN ("A Sink<Frame> and a synchronous Source<Frame> on a channel") {
+
+        enable(node_addr);
+
+        oat::Sink<oat::Frame> sink;
+        sink.bind(node_addr, 100 * 100 * 3, 2);
+        oat::Frame *frame = sink.retrieve(50, 50, CV_8UC3, oat::PIX_BGR);
+        frame->set_rate_hz(30);
+
+        oat::Source<oat::Frame> source;
+        source.touch(node_addr);
+        source.connect(oat::PIX_BGR);
+
+        THEN ("The source sees the sink's geometry before the first write") {
+            REQUIRE( source.parameters().rows == 50 );
+            REQUIRE( source.capacity() == 100 * 100 * 3 );
+        }
+
+        WHEN ("The sink writes a frame and then reshapes the next") {
+
+            sink.wait();
+            frame->data[0] = 1;
+            frame->incrementSampleCount();
+            const auto written = frame->data;
+            sink.post();
+
+            sink.wait();
+            frame = sink.reshape(100, 100, CV_8UC1, oat::PIX_GREY);
+            frame->data[0] = 2;
+            sink.post();
+
+            THEN ("The source reads the sink's memory with each frame's geometry") {
+
+                source.wait();
+                REQUIRE( source.retrieve()->data == written );
+                REQUIRE( source.retrieve()->data[0] == 1 );
+                REQUIRE( source.retrieve()->rows == 50 );
+                REQUIRE( source.retrieve()->sample_period_sec() == Approx(1.0 / 30) );
+                source.post();
+
+                auto lease = source.lease();
+                REQUIRE( lease->data[0] == 2 );
+                REQUIRE( lease->rows == 100 );
+                REQUIRE( source.parameters().generation == 1 );
+                REQUIRE( lease->sample_count() == 1 );
+            }
+        }
+    }
+}
+
+SCENARIO ("Lossy channel sources read the latest write.", "[Channel]") {
+
+    GIVEN ("A Sink<int> and a LOSSY Source<int> that has read write 1") {
+
+        enable(node_addr);
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+        int *shared = sink.retrieve();
+
+        int written = 0;
+        auto write = [&] {
+            sink.wait();
+            *shared = ++written;
+            sink.post();
+        };
+
+        write();
+        oat::Source<int> source;
+        source.touch(node_addr, oat::SourceMode::LOSSY);
+        source.connect();
+        REQUIRE( source.wait() == oat::NodeState::SINK_BOUND );
+        REQUIRE( source.clone() == 1 );
+
+        WHEN ("The sink writes 3 times while the source is busy") {
+
+            write();
+            write();
+            const int *held = source.retrieve();
+            write();
+
+            THEN ("The entry being read is not overwritten") {
+                REQUIRE( *held == 1 );
+            }
+
+            source.post();
+
+            AND_WHEN ("The source waits again") {
+
+                source.wait();
+                const int read = source.clone();
+                source.post();
+
+                THEN ("It reads the latest write and counts the others as dropped") {
+                    REQUIRE( read == 4 );
+                    REQUIRE( source.dropped() == 2 );
+                }
+            }
+        }
+    }
+}
+
+SCENARIO ("Channel sources read what was written before the sink left.", "[Channel]") {
+
+    GIVEN ("A synchronous Source<int> whose Sink<int> wrote once and left") {
+
+        enable(node_addr);
+
+        oat::Source<int> source;
+        source.touch(node_addr);
+
+        {
+            oat::Sink<int> sink;
+            sink.bind(node_addr);
+            source.connect();
+
+            sink.wait();
+            *sink.retrieve() = 7;
+            sink.post();
+        }
+
+        THEN ("The source reads the write and then the end of the stream") {
+
+            REQUIRE( source.wait() == oat::NodeState::SINK_BOUND );
+            REQUIRE( source.clone() == 7 );
+            source.post();
+
+            REQUIRE( source.wait() == oat::NodeState::END );
+        }
+    }
+}
+
+SCENARIO ("Channel sources can be waited on in a SourceSet.", "[Channel, SourceSet]") {
+
+    GIVEN ("Two Sink<int>s on channels and a set of their sources") {
+
+        enable("test_channel0");
+        enable("test_channel1");
+
+        oat::Sink<int> sink0, sink1;
+        sink0.bind("test_channel0");
+        sink1.bind("test_channel1");
+
+        oat::Source<int> source0, source1;
+        source0.touch("test_channel0");
+        source1.touch("test_channel1");
+        source0.connect();
+        source1.connect();
+
+        oat::SourceSet set;
+        set.add(source0);
+        set.add(source1);
+
+        WHEN ("Only the second sink writes") {
+
+            sink1.wait();
+            *sink1.retrieve() = 1;
+            sink1.post();
+
+            THEN ("Only the second source is ready") {
+                REQUIRE( set.wait() == oat::NodeState::SINK_BOUND );
+                REQUIRE( set.ready().size() == 1 );
+                REQUIRE( set.ready()[0] == 1 );
+                REQUIRE( source1.clone() == 1 );
+                source1.post();
+            }
+        }
+    }
+}
+
+SCENARIO ("A Source<T> can only use a channel with a Sink<T>.", "[Channel]") {
+
+    GIVEN ("A bound Sink<int> on a channel") {
+
+        enable(node_addr);
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+
+        WHEN ("A Source<float> touches the channel") {
+
+            oat::Source<float> source;
+
+            THEN ("The source shall throw") {
+                REQUIRE_THROWS( source.touch(node_addr) );
+            }
+        }
+    }
+}
@@ -0,0 +1,142 @@
+//******************************************************************************
+//* File:   Clock_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../lib/utility/Clock.h"
+
+static uint64_t rawNow()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Must run before anything in this process maps the clock
+SCENARIO ("Processes that use the clock at the same time share its time base.", "[Clock]") {
+
+    GIVEN ("A child process that maps the clock.") {
+
+        int to_parent[2], to_child[2];
+        REQUIRE (pipe(to_parent) == 0);
+        REQUIRE (pipe(to_child) == 0);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+
+            const uint64_t start = oat::SharedClock::instance().start_ns();
+            bool ok = write(to_parent[1], &start, sizeof(start)) == sizeof(start);
+
+            // Stay attached until the parent has read the clock
+            char done;
+            ok &= read(to_child[0], &done, 1) == 1;
+            _exit(ok ? 0 : 1);
+        }
+
+        WHEN ("This process maps the clock while the child is using it.") {
+
+            const uint64_t start = oat::SharedClock::instance().start_ns();
+
+            uint64_t child_start = 0;
+            const bool got = read(to_parent[0], &child_start,
+                                  sizeof(child_start)) == sizeof(child_start);
+            const bool released = write(to_child[1], "x", 1) == 1;
+
+            int status = -1;
+            waitpid(pid, &status, 0);
+
+            THEN ("Both see the same pipeline start.") {
+                REQUIRE (got);
+                REQUIRE (released);
+                REQUIRE (status == 0);
+                REQUIRE (child_start == start);
+            }
+        }
+
+        for (auto fd : {to_parent[0], to_parent[1], to_child[0], to_child[1]})
+            close(fd);
+    }
+}
+
+SCENARIO ("The shared clock provides one time base to all processes.", "[Clock]") {
+
+    GIVEN ("The process' view of the shared clock.") {
+
+        auto &clock = oat::SharedClock::instance();
+
+        THEN ("The pipeline has already started.") {
+            REQUIRE (clock.start_ns() <= clock.now_ns());
+        }
+
+        THEN ("The clock uses the TSC only if it has been calibrated.") {
+            if (clock.source() == oat::SharedClock::Source::TSC)
+                REQUIRE (clock.tsc_hz() > 0);
+            else
+                REQUIRE (clock.tsc_hz() == 0);
+        }
+
+        WHEN ("The clock is read repeatedly.") {
+
+            THEN ("It never runs backwards.") {
+
+                uint64_t last = clock.now_ns();
+                bool monotonic = true;
+                for (int i = 0; i < 100000; i++) {
+                    const uint64_t t = clock.now_ns();
+                    monotonic &= t >= last;
+                    last = t;
+                }
+
+                REQUIRE (monotonic);
+            }
+        }
+
+        WHEN ("The clock is read between two readings of the raw clock.") {
+
+            const uint64_t before = rawNow();
+            const uint64_t t = clock.now_ns();
+            const uint64_t after = rawNow();
+
+            THEN ("It agrees with the raw clock to within 1 ms.") {
+                REQUIRE (t + 1000000 >= before);
+                REQUIRE (t <= after + 1000000);
+            }
+        }
+
+        WHEN ("The clock is read after sleeping for 20 ms.") {
+
+            const uint64_t t0 = clock.now_ns();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            const uint64_t dt = clock.now_ns() - t0;
+
+            THEN ("At least 20 ms have elapsed.") {
+                REQUIRE (dt >= 20000000);
+                REQUIRE (dt < 1000000000);
+            }
+        }
+    }
+}
@@ -20,28 +20,56 @@
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
 
+#include <memory>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "../../lib/shmemdf/Node.h"
 
 // Global via extern in Globals.h
 namespace oat { volatile sig_atomic_t quit = 0; }
 
-SCENARIO ("Nodes can accept up to Node::NUM_SLOTS sources.", "[Node]") {
+// Nodes must be placed in storage that holds their per-slot state
+struct NodeStorage {
+
+    explicit NodeStorage(const size_t num_slots)
+    : storage(new uint64_t[oat::Node::bytes(num_slots) / sizeof(uint64_t) + 1])
+    , node(*new (storage.get()) oat::Node(num_slots))
+    {
+        // Nothing
+    }
+
+    ~NodeStorage() { node.~Node(); }
 
-    GIVEN ("A fresh Node") {
+    std::unique_ptr<uint64_t[]> storage;
+    oat::Node &node;
+};
 
-        oat::Node node;
+SCENARIO ("Nodes can accept up to Node::num_slots() sources.", "[Node]") {
+
+    GIVEN ("A fresh Node with the default number of slots") {
+
+        NodeStorage storage(oat::Node::DEFAULT_SLOTS);
+        oat::Node &node = storage.node;
+        REQUIRE (node.num_slots() == 64);
         REQUIRE (node.source_ref_count() == 0);
         REQUIRE (node.sink_state() == oat::NodeState::UNDEFINED);
 
-        WHEN ("Node::NUM_SLOTS+1 sources are added") {
+        WHEN ("Node::num_slots()+1 sources are added") {
 
-            THEN ("The Node shall return normal exit codes until the 11th") {
-                for (size_t i = 0; i <= oat::Node::NUM_SLOTS; i++) {
-                    if (i < oat::Node::NUM_SLOTS)
-                        REQUIRE (node.acquireSlot(i) == 0);
-                    else
-                        REQUIRE (node.acquireSlot(i) < 0);
+            THEN ("The Node shall return normal exit codes until the last") {
+                for (size_t i = 0; i <= node.num_slots(); i++) {
+                    size_t idx;
+                    if (i < node.num_slots()) {
+                        REQUIRE (node.acquireSlot(idx) == 0);
+                        REQUIRE (idx == i);
+                    } else {
+                        REQUIRE (node.acquireSlot(idx) < 0);
+                    }
                 }
+                REQUIRE (node.source_ref_count() == node.num_slots());
             }
         }
 
@@ -58,7 +86,7 @@ SCENARIO ("Nodes can accept up to Node::NUM_SLOTS sources.", "[Node]") {
 
             THEN ("The Node shall throw") {
                 REQUIRE_THROWS(
-                    boost::interprocess::interprocess_semaphore &s = node.read_barrier(-1);
+                    oat::Node::semaphore &s = node.read_barrier(-1);
                 );
             }
         }
@@ -70,9 +98,165 @@ SCENARIO ("Nodes can accept up to Node::NUM_SLOTS sources.", "[Node]") {
 
             THEN ("reading a greater indexed read-barrier shall throw") {
                 REQUIRE_THROWS(
-                boost::interprocess::interprocess_semaphore &s = node.read_barrier(idx+1);
+                oat::Node::semaphore &s = node.read_barrier(idx+1);
                 );
             }
         }
     }
+
+    GIVEN ("A fresh Node with 100 slots") {
+
+        NodeStorage storage(100);
+        oat::Node &node = storage.node;
+
+        WHEN ("all slots are taken and one in the middle is released") {
+
+            size_t idx;
+            for (size_t i = 0; i < node.num_slots(); i++)
+                node.acquireSlot(idx);
+            node.releaseSlot(70);
+
+            THEN ("the next source shall take the released slot") {
+                REQUIRE (node.acquireSlot(idx) == 0);
+                REQUIRE (idx == 70);
+                REQUIRE (node.acquireSlot(idx) < 0);
+            }
+        }
+    }
+
+    GIVEN ("A request for more than Node::MAX_SLOTS slots") {
+
+        THEN ("The Node shall throw") {
+            REQUIRE_THROWS( NodeStorage storage(oat::Node::MAX_SLOTS + 1); );
+        }
+    }
+}
+
+SCENARIO ("Nodes count the reads each write requires.", "[Node]") {
+
+    GIVEN ("A Node with three sources") {
+
+        NodeStorage storage(oat::Node::DEFAULT_SLOTS);
+        oat::Node &node = storage.node;
+
+        size_t a, b, c;
+        node.acquireSlot(a);
+        node.acquireSlot(b);
+        node.acquireSlot(c);
+
+        WHEN ("the sink writes") {
+
+            node.notifySinkWriteStart();
+            node.notifySinkWriteComplete();
+
+            THEN ("each source shall be admitted and posted once") {
+                for (auto i : {a, b, c}) {
+                    REQUIRE (node.admitted(i));
+                    REQUIRE (node.read_barrier(i).count() == 1);
+                }
+            }
+
+            THEN ("only the last read shall complete the write") {
+                REQUIRE_FALSE (node.notifySourceReadComplete(a));
+                REQUIRE_FALSE (node.notifySourceReadComplete(b));
+                REQUIRE (node.notifySourceReadComplete(c));
+                REQUIRE (node.read_number(a) == 1);
+            }
+
+            THEN ("a source that leaves shall forfeit its read") {
+                REQUIRE_FALSE (node.notifySourceReadComplete(a));
+                REQUIRE_FALSE (node.notifySourceReadComplete(b));
+
+                const auto free_entries = node.write_barrier.count();
+                node.releaseSlot(c);
+                REQUIRE (node.write_barrier.count() == free_entries + 1);
+            }
+        }
+
+        WHEN ("a source leaves and another takes its slot before the sink "
+              "writes again") {
+
+            node.notifySinkWriteStart();
+            node.notifySinkWriteComplete();
+            node.notifySourceReadComplete(a);
+            node.notifySourceReadComplete(b);
+            node.notifySourceReadComplete(c);
+
+            node.releaseSlot(b);
+            size_t d;
+            node.acquireSlot(d);
+            REQUIRE (d == b);
+
+            THEN ("the new source shall not be admitted until the next write "
+                  "and start reading there") {
+                REQUIRE_FALSE (node.admitted(d));
+
+                node.notifySinkWriteStart();
+                node.notifySinkWriteComplete();
+
+                REQUIRE (node.admitted(d));
+                REQUIRE (node.read_number(d) == 1);
+                REQUIRE (node.read_barrier(d).count() == 1);
+            }
+        }
+    }
+}
+
+SCENARIO ("Nodes reclaim the slots of sources whose process has died.", "[Node]") {
+
+    GIVEN ("A Node in memory shared with child processes") {
+
+        const size_t bytes = oat::Node::bytes(oat::Node::DEFAULT_SLOTS);
+        void *mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        REQUIRE (mem != MAP_FAILED);
+        oat::Node &node = *new (mem) oat::Node(oat::Node::DEFAULT_SLOTS);
+
+        size_t mine;
+        node.acquireSlot(mine);
+
+        WHEN ("a child process claims a slot and exits without releasing it") {
+
+            pid_t pid = fork();
+            if (pid == 0) {
+                size_t theirs;
+                _exit(node.acquireSlot(theirs) == 0 ? 0 : 1);
+            }
+
+            int status = -1;
+            waitpid(pid, &status, 0);
+            REQUIRE (status == 0);
+            REQUIRE (node.source_ref_count() == 2);
+
+            node.notifySinkWriteStart();
+            node.notifySinkWriteComplete();
+            const auto free_entries = node.write_barrier.count();
+
+            THEN ("only the dead source's slot shall be reclaimed, forfeiting "
+                  "its read") {
+                REQUIRE (node.reclaimDeadSources(0) == 1);
+                REQUIRE (node.source_ref_count() == 1);
+                REQUIRE (node.slot_bound(mine));
+                REQUIRE (node.write_barrier.count() == free_entries);
+                REQUIRE (node.notifySourceReadComplete(mine));
+            }
+
+            THEN ("a slot shall not be reclaimed while its heartbeat is "
+                  "fresh") {
+                REQUIRE (node.reclaimDeadSources(oat::Node::WATCHDOG_NS * 100) == 0);
+                REQUIRE (node.source_ref_count() == 2);
+            }
+        }
+
+        WHEN ("all sources are alive") {
+
+            THEN ("no slot shall be reclaimed") {
+                REQUIRE (node.reclaimDeadSources(0) == 0);
+                REQUIRE (node.source_ref_count() == 1);
+            }
+        }
+
+        node.~Node();
+        munmap(mem, bytes);
+    }
 }
@@ -0,0 +1,110 @@
+//******************************************************************************
+//* File:   Offline_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "../../lib/base/Globals.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+// OAT_OFFLINE is read once per process, so every test in this file runs
+// offline
+
+const std::string node_addr = "test";
+
+// Global via extern in Globals.h
+namespace oat { volatile sig_atomic_t quit = 0; }
+
+SCENARIO ("OAT_OFFLINE declares the number of readers of each stream.", "[Offline]") {
+
+    GIVEN ("OAT_OFFLINE=1,two=2,three=3") {
+
+        setenv("OAT_OFFLINE", "1,two=2,three=3", 1);
+        REQUIRE( oat::offline() );
+
+        THEN ("Listed streams wait for their count and others for one") {
+            REQUIRE( oat::offlineReaders("two") == 2 );
+            REQUIRE( oat::offlineReaders("three") == 3 );
+            REQUIRE( oat::offlineReaders("tw") == 1 );
+            REQUIRE( oat::offlineReaders("other") == 1 );
+        }
+    }
+
+    GIVEN ("OAT_OFFLINE=2,one=1") {
+
+        setenv("OAT_OFFLINE", "2,one=1", 1);
+
+        THEN ("The bare count applies to unlisted streams") {
+            REQUIRE( oat::offlineReaders("one") == 1 );
+            REQUIRE( oat::offlineReaders("other") == 2 );
+        }
+    }
+
+    GIVEN ("A stream count that is not a positive integer") {
+
+        setenv("OAT_OFFLINE", "1,raw=0", 1);
+
+        THEN ("Reading it shall throw") {
+            REQUIRE_THROWS_AS( oat::offlineReaders("pos"), std::runtime_error );
+        }
+    }
+}
+
+SCENARIO ("Offline, a sink's first write waits for its declared readers.", "[Offline, Sink]") {
+
+    GIVEN ("A Sink<int> whose stream declares two readers") {
+
+        setenv("OAT_OFFLINE", ("1," + node_addr + "=2").c_str(), 1);
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+
+        std::atomic<bool> waited {false};
+        std::thread writer([&sink, &waited] {
+            sink.wait();
+            waited = true;
+            sink.post();
+        });
+
+        WHEN ("One source attaches") {
+
+            oat::Source<int> source1;
+            source1.touch(node_addr);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+            THEN ("The sink keeps waiting until the second source attaches") {
+
+                REQUIRE_FALSE( waited );
+
+                oat::Source<int> source2;
+                source2.touch(node_addr);
+                writer.join();
+
+                REQUIRE( waited );
+            }
+        }
+    }
+}
@@ -0,0 +1,140 @@
+//******************************************************************************
+//* File:   Registry_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <memory>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../lib/shmemdf/Registry.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+// Global via extern in Globals.h
+namespace oat { volatile sig_atomic_t quit = 0; }
+
+const std::string node_addr = "test_registry";
+
+static bool listed(const std::string &name, oat::Registry::Entry &entry)
+{
+    for (const auto &e : oat::Registry::instance().list()) {
+        if (name == e.name) {
+            entry = e;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+SCENARIO ("The registry lists nodes while components use them.", "[Registry]") {
+
+    GIVEN ("A bound sink") {
+
+        oat::Registry::Entry e;
+        std::unique_ptr<oat::Sink<int>> sink(new oat::Sink<int>());
+        sink->bind(node_addr);
+
+        THEN ("its node shall be listed with its type and SINK") {
+            REQUIRE(listed(node_addr, e));
+            REQUIRE(std::string(e.type) == typeid(int).name());
+            REQUIRE(e.bytes == sizeof(int));
+            REQUIRE(e.sink_pid == getpid());
+            REQUIRE(e.readers == 0);
+            REQUIRE_FALSE(e.stale());
+        }
+
+        WHEN ("two sources touch the node") {
+
+            std::unique_ptr<oat::Source<int>> s0(new oat::Source<int>());
+            std::unique_ptr<oat::Source<int>> s1(new oat::Source<int>());
+            s0->touch(node_addr);
+            s1->touch(node_addr, oat::SourceMode::LOSSY);
+
+            THEN ("both shall be counted as readers") {
+                REQUIRE(listed(node_addr, e));
+                REQUIRE(e.readers == 2);
+            }
+
+            AND_WHEN ("the sink and then the sources leave") {
+
+                sink.reset();
+                REQUIRE(listed(node_addr, e));
+                REQUIRE(e.sink_pid == 0);
+
+                s0.reset();
+                REQUIRE(listed(node_addr, e));
+                REQUIRE(e.readers == 1);
+
+                s1.reset();
+
+                THEN ("the node shall no longer be listed") {
+                    REQUIRE_FALSE(listed(node_addr, e));
+                }
+            }
+        }
+
+        WHEN ("the sink leaves") {
+
+            sink.reset();
+
+            THEN ("the node shall no longer be listed") {
+                REQUIRE_FALSE(listed(node_addr, e));
+            }
+        }
+    }
+}
+
+SCENARIO ("Nodes whose components all died are stale.", "[Registry]") {
+
+    GIVEN ("A sink in a child process that exits without unbinding") {
+
+        // Make sure the registry is mapped before forking
+        oat::Registry::instance();
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            auto sink = new oat::Sink<int>();
+            sink->bind(node_addr);
+            _exit(0);
+        }
+
+        int status = -1;
+        waitpid(pid, &status, 0);
+        REQUIRE(status == 0);
+
+        oat::Registry::Entry e;
+
+        THEN ("its node shall be listed as stale until it is removed") {
+            REQUIRE(listed(node_addr, e));
+            REQUIRE(e.sink_pid == pid);
+            REQUIRE(e.stale());
+
+            oat::Registry::instance().remove(node_addr);
+            REQUIRE_FALSE(listed(node_addr, e));
+        }
+
+        oat::bip::shared_memory_object::remove((node_addr + "_node").c_str());
+        oat::bip::shared_memory_object::remove((node_addr + "_obj").c_str());
+    }
+}
@@ -0,0 +1,156 @@
+//******************************************************************************
+//* File:   Semaphore_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include "../../lib/shmemdf/Semaphore.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+// Global via extern in Globals.h
+namespace oat { volatile sig_atomic_t quit = 0; }
+
+using msec = std::chrono::milliseconds;
+const std::string node_addr = "test";
+
+SCENARIO ("Semaphores count posts and waits.", "[Semaphore]") {
+
+    GIVEN ("A semaphore with an initial count of 1") {
+
+        oat::Semaphore sem {1};
+        auto never = []{ return false; };
+
+        WHEN ("it is waited on once") {
+
+            THEN ("it shall not block and its count shall be 0") {
+                REQUIRE(sem.wait(never));
+                REQUIRE(sem.count() == 0);
+                REQUIRE_FALSE(sem.try_wait());
+            }
+        }
+
+        WHEN ("it is waited on twice on a separate thread") {
+
+            auto fut = std::async(std::launch::async,
+                                  [&sem, &never]{ sem.wait(never); sem.wait(never); });
+
+            THEN ("the second wait shall block until post()") {
+
+                std::this_thread::sleep_for(msec(5));
+                REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+                sem.post();
+
+                REQUIRE(fut.wait_for(msec(100)) == std::future_status::ready);
+            }
+        }
+    }
+
+    GIVEN ("A semaphore with an initial count of 0 and an abort flag") {
+
+        oat::Semaphore sem;
+        std::atomic<bool> abort {false};
+
+        WHEN ("a thread waits on it") {
+
+            auto fut = std::async(std::launch::async,
+                    [&sem, &abort]{ return sem.wait([&abort]{ return abort.load(); }); });
+
+            THEN ("the wait shall be abandoned after the flag is set and the "
+                  "semaphore is broadcast") {
+
+                std::this_thread::sleep_for(msec(5));
+                REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+                abort = true;
+                sem.broadcast();
+
+                REQUIRE(fut.wait_for(msec(100)) == std::future_status::ready);
+                REQUIRE_FALSE(fut.get());
+            }
+        }
+
+        WHEN ("a thread waits on it with a timeout") {
+
+            THEN ("the wait shall time out if it is never posted") {
+                const auto t0 = std::chrono::steady_clock::now();
+                REQUIRE(sem.wait_for([]{ return false; }, 10000000) == -1);
+                REQUIRE(std::chrono::steady_clock::now() - t0 >= msec(10));
+            }
+
+            THEN ("the wait shall succeed if it is posted in time") {
+                sem.post();
+                REQUIRE(sem.wait_for([]{ return false; }, 10000000) == 1);
+                REQUIRE(sem.count() == 0);
+            }
+        }
+    }
+}
+
+SCENARIO ("Blocked sources are released as soon as their sink leaves or on "
+          "shutdown.", "[Semaphore, Sink, Source]") {
+
+    GIVEN ("A source waiting on a node") {
+
+        auto sink = new oat::Sink<int>();
+        oat::Source<int> source;
+
+        sink->bind(node_addr);
+        source.touch(node_addr);
+        source.connect();
+
+        auto fut = std::async(std::launch::async, [&source]{ return source.wait(); });
+
+        WHEN ("The sink is destroyed") {
+
+            std::this_thread::sleep_for(msec(5));
+            REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+            delete sink;
+
+            THEN ("The source shall return from wait() with NodeState::END "
+                  "without polling") {
+                REQUIRE(fut.wait_for(msec(5)) == std::future_status::ready);
+                REQUIRE(fut.get() == oat::NodeState::END);
+            }
+        }
+
+        WHEN ("oat::quit is set and waiters are woken for shutdown") {
+
+            std::this_thread::sleep_for(msec(5));
+            REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+            oat::quit = 1;
+            oat::wakeForShutdown();
+
+            THEN ("The source shall return from wait()") {
+                REQUIRE(fut.wait_for(msec(5)) == std::future_status::ready);
+            }
+
+            oat::quit = 0;
+            delete sink;
+        }
+    }
+}
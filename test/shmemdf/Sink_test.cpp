@@ -155,7 +155,7 @@ SCENARIO ("Sink<SharedFrameHeader> must bind() before waiting, posting, or alloc
     GIVEN ("A single Sink<SharedFrameHeader>") {
 
         oat::Sink<oat::Frame> sink;
-        cv::Mat mat;
+        oat::Frame *frame;
         size_t cols {100};
         size_t rows {100};
         int type {1};
@@ -178,7 +178,7 @@ SCENARIO ("Sink<SharedFrameHeader> must bind() before waiting, posting, or alloc
         WHEN ("When the sink calls retrieve() before binding a segment") {
 
             THEN ("The the sink shall throw") {
-                REQUIRE_THROWS( mat = sink.retrieve(cols, rows, type, color); );
+                REQUIRE_THROWS( frame = sink.retrieve(cols, rows, type, color); );
             }
         }
     }
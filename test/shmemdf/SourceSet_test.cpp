@@ -0,0 +1,162 @@
+//******************************************************************************
+//* File:   SourceSet_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+#include "../../lib/shmemdf/SourceSet.h"
+
+// Global via extern in Globals.h
+namespace oat { volatile sig_atomic_t quit = 0; }
+
+using msec = std::chrono::milliseconds;
+
+SCENARIO ("Source sets return sources in the order they are written.", "[SourceSet]") {
+
+    GIVEN ("Two sinks and a set holding a source for each") {
+
+        oat::Sink<int> sink_a, sink_b;
+        sink_a.bind("test_a");
+        sink_b.bind("test_b");
+        int *a = sink_a.retrieve();
+        int *b = sink_b.retrieve();
+
+        oat::Source<int> source_a, source_b;
+        oat::SourceSet set;
+        source_a.touch("test_a");
+        source_b.touch("test_b");
+        REQUIRE(set.add(source_a) == 0);
+        REQUIRE(set.add(source_b) == 1);
+        source_a.connect();
+        source_b.connect();
+
+        WHEN ("the second sink writes before the first") {
+
+            sink_b.wait(); *b = 2; sink_b.post();
+
+            THEN ("the second source shall be returned first") {
+                REQUIRE(set.wait() == oat::NodeState::SINK_BOUND);
+                REQUIRE(set.ready() == std::vector<size_t>{1});
+                REQUIRE(*source_b.retrieve() == 2);
+                source_b.post();
+                REQUIRE(set.pending() == 1);
+
+                AND_THEN ("it shall not be returned again in the same round") {
+
+                    sink_b.wait(); *b = 3; sink_b.post();
+
+                    auto fut = std::async(std::launch::async,
+                                          [&set]{ return set.wait(); });
+                    std::this_thread::sleep_for(msec(5));
+                    REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+                    sink_a.wait(); *a = 1; sink_a.post();
+
+                    REQUIRE(fut.wait_for(msec(100)) == std::future_status::ready);
+                    REQUIRE(fut.get() == oat::NodeState::SINK_BOUND);
+                    REQUIRE(set.ready() == std::vector<size_t>{0});
+                    REQUIRE(*source_a.retrieve() == 1);
+                    source_a.post();
+                    REQUIRE(set.pending() == 0);
+
+                    // Next round
+                    REQUIRE(set.wait() == oat::NodeState::SINK_BOUND);
+                    REQUIRE(set.ready() == std::vector<size_t>{1});
+                    REQUIRE(*source_b.retrieve() == 3);
+                    source_b.post();
+                }
+            }
+        }
+
+        WHEN ("both sinks write before the set waits") {
+
+            sink_a.wait(); *a = 1; sink_a.post();
+            sink_b.wait(); *b = 2; sink_b.post();
+
+            THEN ("both sources shall be returned by a single wait") {
+                REQUIRE(set.wait() == oat::NodeState::SINK_BOUND);
+                auto ready = set.ready();
+                std::sort(ready.begin(), ready.end());
+                REQUIRE(ready == (std::vector<size_t>{0, 1}));
+                REQUIRE(set.pending() == 0);
+                source_a.post();
+                source_b.post();
+            }
+        }
+    }
+}
+
+SCENARIO ("Source sets are released when a sink leaves or on shutdown.", "[SourceSet]") {
+
+    GIVEN ("A set waiting on two sources") {
+
+        auto sink_a = new oat::Sink<int>();
+        oat::Sink<int> sink_b;
+        sink_a->bind("test_a");
+        sink_b.bind("test_b");
+
+        oat::Source<int> source_a, source_b;
+        oat::SourceSet set;
+        source_a.touch("test_a");
+        source_b.touch("test_b");
+        set.add(source_a);
+        set.add(source_b);
+        source_a.connect();
+        source_b.connect();
+
+        auto fut = std::async(std::launch::async, [&set]{ return set.wait(); });
+        std::this_thread::sleep_for(msec(5));
+        REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+        WHEN ("one sink is destroyed") {
+
+            delete sink_a;
+
+            THEN ("the set shall return NodeState::END") {
+                REQUIRE(fut.wait_for(msec(100)) == std::future_status::ready);
+                REQUIRE(fut.get() == oat::NodeState::END);
+                REQUIRE(set.ready() == std::vector<size_t>{0});
+            }
+        }
+
+        WHEN ("oat::quit is set and waiters are woken for shutdown") {
+
+            oat::quit = 1;
+            oat::wakeForShutdown();
+
+            THEN ("the set shall return every pending source") {
+                REQUIRE(fut.wait_for(msec(100)) == std::future_status::ready);
+                fut.get();
+                REQUIRE(set.ready().size() == 2);
+                REQUIRE(set.pending() == 0);
+            }
+
+            oat::quit = 0;
+            delete sink_a;
+        }
+    }
+}
@@ -20,8 +20,13 @@
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
 
+#include <chrono>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "../../lib/datatypes/PositionBatch.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/Source.h"
@@ -29,71 +34,41 @@
 // Global via extern in Globals.h
 namespace oat { volatile sig_atomic_t quit = 0; }
 
+namespace bip = boost::interprocess;
+
 const std::string node_addr = "test";
 
-SCENARIO ("Up to 10 sources can connect a single Node.", "[Source]") {
+SCENARIO ("Up to Node::num_slots() sources can connect a single Node.", "[Source]") {
 
-    GIVEN ("11 sources and a bound sink with common node address") {
+    GIVEN ("Node::DEFAULT_SLOTS+1 sources and a bound sink with common node address") {
 
         oat::Sink<int> sink;
 
         INFO ("The sink binds a node");
         sink.bind(node_addr);
-        oat::Source<int> s0, s1, s2, s3, s4, s5, s6, s7, s8, s9, s10;
 
-        WHEN ("sources 0 to Oat::Node:NUM_SLOTS connect a node") {
+        const size_t num_slots = oat::Node::DEFAULT_SLOTS;
+        std::vector<std::unique_ptr<oat::Source<int>>> sources;
+        for (size_t i = 0; i <= num_slots; i++)
+            sources.emplace_back(new oat::Source<int>());
+
+        WHEN ("sources 0 to Node::DEFAULT_SLOTS connect a node") {
 
-            THEN ("The first 10 connections will succeed") {
+            THEN ("The first Node::DEFAULT_SLOTS connections will succeed") {
                 REQUIRE_NOTHROW(
-                    s0.touch(node_addr);
-                    s1.touch(node_addr);
-                    s2.touch(node_addr);
-                    s3.touch(node_addr);
-                    s4.touch(node_addr);
-                    s5.touch(node_addr);
-                    s6.touch(node_addr);
-                    s7.touch(node_addr);
-                    s8.touch(node_addr);
-                    s9.touch(node_addr);
-
-                    s0.connect();
-                    s1.connect();
-                    s2.connect();
-                    s3.connect();
-                    s4.connect();
-                    s5.connect();
-                    s6.connect();
-                    s7.connect();
-                    s8.connect();
-                    s9.connect();
+                    for (size_t i = 0; i < num_slots; i++) {
+                        sources[i]->touch(node_addr);
+                        sources[i]->connect();
+                    }
                 );
             }
 
-            AND_THEN ("The oat::Node:NUM_SLOTS+1 connection shall throw") {
+            AND_THEN ("The Node::DEFAULT_SLOTS+1 connection shall throw") {
                 REQUIRE_THROWS(
-                    s0.touch(node_addr);
-                    s1.touch(node_addr);
-                    s2.touch(node_addr);
-                    s3.touch(node_addr);
-                    s4.touch(node_addr);
-                    s5.touch(node_addr);
-                    s6.touch(node_addr);
-                    s7.touch(node_addr);
-                    s8.touch(node_addr);
-                    s9.touch(node_addr);
-                    s10.touch(node_addr);
-
-                    s0.connect();
-                    s1.connect();
-                    s2.connect();
-                    s3.connect();
-                    s4.connect();
-                    s5.connect();
-                    s6.connect();
-                    s7.connect();
-                    s8.connect();
-                    s9.connect();
-                    s10.connect();
+                    for (size_t i = 0; i <= num_slots; i++) {
+                        sources[i]->touch(node_addr);
+                        sources[i]->connect();
+                    }
                 );
             }
         }
@@ -215,4 +190,497 @@ SCENARIO ("Connected sources can retrieve shared objects to mutate them.", "[Sou
 }
 
 
+SCENARIO ("Sinks and sources record telemetry that can be read without a lock.", "[Source]") {
+
+    GIVEN ("A bound Sink<int> and a connected Source<int> with common node address") {
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+
+        sink.bind(node_addr);
+        source.touch(node_addr);
+        source.connect();
+
+        INFO ("A monitor attaches to the node read-only");
+        bip::managed_shared_memory shmem(bip::open_read_only,
+                                         (node_addr + "_node").c_str());
+        const oat::Node *node = oat::Node::findReadOnly(shmem);
+        REQUIRE( node != nullptr );
+
+        WHEN ("The sink writes and the source reads 3 times") {
+
+            for (int i = 0; i < 3; i++) {
+                sink.wait();
+                sink.post();
+                source.wait();
+                source.post();
+            }
+
+            THEN ("The node and slot telemetry reflect the writes and reads") {
+                REQUIRE( node->telemetry().sink_pid == getpid() );
+                REQUIRE( node->telemetry().last_write_ns > 0 );
+                REQUIRE( node->slot_bound(0) );
+                REQUIRE( node->slot_telemetry(0).pid == getpid() );
+                REQUIRE( node->slot_telemetry(0).reads == 3 );
+                REQUIRE( node->slot_telemetry(0).read_latency_ns > 0 );
+            }
+        }
+    }
+}
+
+SCENARIO ("Waits are timed into the calling thread's process statistics.", "[Source]") {
+
+    GIVEN ("A bound Sink<int>, a lossy Source<int> and stats registered for this thread") {
+
+        oat::ProcessStats stats;
+        oat::telemetry::thread_stats() = &stats;
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+
+        // Lossy sources connect once there is something to read
+        sink.bind(node_addr);
+        sink.wait();
+        sink.post();
+        source.touch(node_addr, oat::SourceMode::LOSSY);
+        source.connect();
+
+        WHEN ("The sink writes 5 times between two reads") {
+
+            source.wait();
+            source.post();
+
+            for (int i = 0; i < 5; i++) {
+                sink.wait();
+                sink.post();
+            }
+
+            source.wait();
+            source.post();
+
+            THEN ("Both reads are timed and the 4 unseen writes are dropped") {
+                REQUIRE( stats.source_wait.count() == 2 );
+                REQUIRE( stats.drops == 4 );
+            }
+        }
+
+        oat::telemetry::thread_stats() = nullptr;
+    }
+}
+
+SCENARIO ("Lossy sources drop either the oldest or the newest writes.", "[Source]") {
+
+    const std::vector<oat::SourceMode> modes {oat::SourceMode::LOSSY,
+                                              oat::SourceMode::DROP_NEWEST};
+
+    for (const auto mode : modes) {
+
+        const bool newest = mode == oat::SourceMode::DROP_NEWEST;
+
+        GIVEN (std::string("A Sink<int> and a ")
+               + (newest ? "DROP_NEWEST" : "LOSSY") + " Source<int> that has read write 1") {
+
+            oat::Sink<int> sink;
+            oat::Source<int> source;
+
+            sink.bind(node_addr);
+            int *shared = sink.retrieve();
+
+            int written = 0;
+            auto write = [&] {
+                sink.wait();
+                *shared = ++written;
+                sink.post();
+            };
+
+            write();
+            source.touch(node_addr, mode);
+            source.connect();
+            REQUIRE( source.wait() == oat::NodeState::SINK_BOUND );
+            REQUIRE( source.clone() == 1 );
+
+            WHEN ("The sink writes 3 times while the source is busy") {
+
+                write();
+                write();
+                write();
+                source.post();
+
+                AND_WHEN ("The source waits again") {
+
+                    const uint64_t before = source.write_number();
+                    if (newest) {
+                        // Nothing new has arrived since post(), so unblock
+                        // the wait with one more write
+                        std::thread t([&] {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                            write();
+                        });
+                        source.wait();
+                        t.join();
+                    } else {
+                        source.wait();
+                    }
+
+                    const int read = source.clone();
+                    source.post();
+
+                    THEN ("Drop-oldest reads the latest write; drop-newest waits for a new one") {
+                        REQUIRE( before == 4 );
+                        REQUIRE( read == (newest ? 5 : 4) );
+                        REQUIRE( source.dropped() == (newest ? 3u : 2u) );
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO ("Latency histograms resolve quantiles to within a bucket.", "[Source]") {
+
+    GIVEN ("A histogram of the durations 1 to 1000 us") {
+
+        oat::LatencyHistogram h;
+        for (uint64_t us = 1; us <= 1000; us++)
+            h.record(us * 1000);
+
+        THEN ("Quantiles are within 7% of their true values") {
+            REQUIRE( h.count() == 1000 );
+            REQUIRE( h.max_ns() == 1000000 );
+            REQUIRE( h.mean_ns() == Approx(500500) );
+            REQUIRE( h.quantile_ns(0.5) == Approx(500000).epsilon(0.07) );
+            REQUIRE( h.quantile_ns(0.99) == Approx(990000).epsilon(0.07) );
+            REQUIRE( h.quantile_ns(1.0) == 1000000 );
+        }
+
+        THEN ("Bucket bounds tile the range without gaps") {
+            for (size_t i = 1; i < oat::LatencyHistogram::NUM_BUCKETS; i++)
+                REQUIRE( oat::LatencyHistogram::lower_ns(i)
+                         == oat::LatencyHistogram::upper_ns(i - 1) + 1 );
+        }
+    }
+}
+
+SCENARIO ("Frame sources map frame data however the sink backed it.", "[Source, SharedFrameHeader]") {
+
+    const size_t rows {1080};
+    const size_t cols {1920};
+    const size_t bytes {rows * cols * 3};
+
+    for (const std::string pages : {"default", "locked", "huge"}) {
+
+        GIVEN ("A Sink<Frame> bound with OAT_FRAME_PAGES=" + pages) {
+
+            setenv("OAT_FRAME_PAGES", pages.c_str(), 1);
+
+            oat::Sink<oat::Frame> sink;
+            sink.bind(node_addr, bytes, 2);
+            oat::Frame *frame = sink.retrieve(rows, cols, CV_8UC3, oat::PIX_BGR);
+
+            unsetenv("OAT_FRAME_PAGES");
+
+            INFO ("Huge pages fall back to locked pages when they are not available");
+            if (pages == "default")
+                REQUIRE( sink.pages() == oat::FramePages::DEFAULT );
+            else if (pages == "locked")
+                REQUIRE( sink.pages() == oat::FramePages::LOCKED );
+            else
+                REQUIRE( sink.pages() != oat::FramePages::DEFAULT );
+
+            WHEN ("The sink writes to both ring entries and a source connects") {
+
+                sink.wait();
+                frame->data[0] = 1;
+                frame->data[bytes - 1] = 2;
+                sink.post();
+
+                sink.wait();
+                frame->data[0] = 3;
+                frame->data[bytes - 1] = 4;
+
+                oat::Source<oat::Frame> source;
+                source.touch(node_addr);
+                source.connect();
+                sink.post();
+
+                THEN ("The source shall read the frames the sink wrote") {
+                    source.wait();
+                    REQUIRE( source.retrieve()->data[0] == 3 );
+                    REQUIRE( source.retrieve()->data[bytes - 1] == 4 );
+                    source.post();
+                }
+            }
+        }
+    }
+}
+
+SCENARIO ("Frame sources follow a sink that reshapes its frames.", "[Source, SharedFrameHeader]") {
+
+    GIVEN ("A Sink<Frame> with room for a 100x100 BGR frame that starts at 50x50") {
+
+        oat::Sink<oat::Frame> sink;
+        sink.bind(node_addr, 100 * 100 * 3, 2);
+        oat::Frame *frame = sink.retrieve(50, 50, CV_8UC3, oat::PIX_BGR);
+
+        oat::Source<oat::Frame> source;
+        source.touch(node_addr);
+        source.connect();
+
+        REQUIRE( source.capacity() == 100 * 100 * 3 );
+        REQUIRE( source.parameters().rows == 50 );
+
+        WHEN ("The sink writes a 50x50 frame and then a 100x100 grey frame") {
+
+            sink.wait();
+            frame->data[0] = 1;
+            sink.post();
+
+            sink.wait();
+            frame = sink.reshape(100, 100, CV_8UC1, oat::PIX_GREY);
+            frame->data[100 * 100 - 1] = 2;
+            sink.post();
+
+            THEN ("The source shall read each frame with the geometry it was written with") {
+
+                source.wait();
+                REQUIRE( source.retrieve()->rows == 50 );
+                REQUIRE( source.retrieve()->type() == CV_8UC3 );
+                REQUIRE( source.retrieve()->data[0] == 1 );
+                REQUIRE( source.parameters().generation == 0 );
+                source.post();
+
+                source.wait();
+                REQUIRE( source.retrieve()->rows == 100 );
+                REQUIRE( source.retrieve()->type() == CV_8UC1 );
+                REQUIRE( source.retrieve()->color() == oat::PIX_GREY );
+                REQUIRE( source.retrieve()->data[100 * 100 - 1] == 2 );
+                REQUIRE( source.parameters().generation == 1 );
+                source.post();
+            }
+        }
+
+        WHEN ("The sink reshapes to a frame larger than it reserved") {
+
+            sink.wait();
+
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS( sink.reshape(101, 100, CV_8UC3, oat::PIX_BGR); );
+            }
+        }
+    }
+}
+
+SCENARIO ("Frame sinks cannot retrieve a frame larger than they bound.", "[Source, SharedFrameHeader]") {
+
+    GIVEN ("A Sink<Frame> bound with room for a 10x10 grey frame") {
+
+        oat::Sink<oat::Frame> sink;
+        sink.bind(node_addr, 10 * 10);
+
+        WHEN ("The sink retrieves a 10x11 grey frame") {
+
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS_AS( sink.retrieve(10, 11, CV_8UC1, oat::PIX_GREY),
+                                   std::runtime_error );
+            }
+        }
+    }
+}
+
+SCENARIO ("Frame samples carry their capture time and trace across a node.", "[Source]") {
+
+    GIVEN ("OAT_TRACE=1 and a Sink<Frame> with a connected Source<Frame>") {
+
+        setenv("OAT_TRACE", "1", 1);
+        REQUIRE( oat::Trace::enabled() );
+
+        oat::Sink<oat::Frame> sink;
+        sink.bind(node_addr, 10 * 10);
+        oat::Frame *frame = sink.retrieve(10, 10, CV_8UC1, oat::PIX_GREY);
+
+        oat::Source<oat::Frame> source;
+        source.touch(node_addr);
+        source.connect();
+
+        oat::Trace trace;
+
+        WHEN ("The sink captures a frame") {
+
+            const uint64_t captured = oat::Sample::now_ns();
+
+            sink.wait();
+            frame->incrementSampleCount();
+            frame->set_capture_ns(captured);
+            sink.post();
+
+            THEN ("The source reads its capture time and no hops") {
+
+                source.wait();
+                REQUIRE( source.retrieve()->sample().capture_ns() == captured );
+                REQUIRE( source.trace(trace) );
+                source.post();
+
+                REQUIRE( trace.num_hops == 0 );
+            }
+        }
+
+        WHEN ("The sink continues an upstream trace") {
+
+            const uint64_t before = oat::Sample::now_ns();
+            oat::Trace upstream;
+
+            sink.wait();
+            sink.trace(upstream, "framefilt[a->b]", before);
+            sink.post();
+
+            THEN ("The source reads the hop") {
+
+                source.wait();
+                REQUIRE( source.trace(trace) );
+                source.post();
+
+                REQUIRE( trace.num_hops == 1 );
+                REQUIRE( std::string(trace.hops[0].who) == "framefilt[a->b]" );
+                REQUIRE( trace.hops[0].enter_ns == before );
+                REQUIRE( trace.hops[0].exit_ns >= before );
+            }
+        }
+
+        WHEN ("The sink continues a trace that already has MAX_HOPS hops") {
+
+            const size_t max_hops = oat::Trace::MAX_HOPS;
+            oat::Trace upstream;
+            for (size_t i = 0; i < max_hops; i++)
+                upstream.appendHop("hop", oat::Sample::now_ns(),
+                                   oat::Sample::now_ns());
+
+            sink.wait();
+            sink.trace(upstream, "framefilt[a->b]", oat::Sample::now_ns());
+            sink.post();
+
+            THEN ("The extra hop is dropped") {
+                source.wait();
+                REQUIRE( source.trace(trace) );
+                source.post();
+
+                REQUIRE( trace.num_hops == max_hops );
+                REQUIRE( std::string(trace.hops[max_hops - 1].who) == "hop" );
+            }
+        }
+
+        unsetenv("OAT_TRACE");
+    }
+
+    GIVEN ("OAT_TRACE is not set and a Sink<Frame> with a connected Source<Frame>") {
+
+        unsetenv("OAT_TRACE");
+
+        oat::Sink<oat::Frame> sink;
+        sink.bind(node_addr, 10 * 10);
+        oat::Frame *frame = sink.retrieve(10, 10, CV_8UC1, oat::PIX_GREY);
+
+        oat::Source<oat::Frame> source;
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink captures a frame") {
+
+            const uint64_t captured = oat::Sample::now_ns();
+
+            sink.wait();
+            frame->incrementSampleCount();
+            frame->set_capture_ns(captured);
+            sink.post();
+
+            THEN ("The source reads its capture time but has no trace to read") {
+                oat::Trace trace;
+                source.wait();
+                REQUIRE( source.retrieve()->sample().capture_ns() == captured );
+                REQUIRE_FALSE( source.trace(trace) );
+                source.post();
+                REQUIRE( trace.num_hops == 0 );
+            }
+        }
+    }
+}
+
+SCENARIO ("An unrecognized OAT_FRAME_PAGES is an error.", "[Source, SharedFrameHeader]") {
+
+    GIVEN ("OAT_FRAME_PAGES=small") {
+
+        setenv("OAT_FRAME_PAGES", "small", 1);
+
+        WHEN ("A Sink<Frame> allocates frames") {
+
+            oat::Sink<oat::Frame> sink;
+            sink.bind(node_addr, 100);
+
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS( sink.retrieve(10, 10, CV_8UC1, oat::PIX_GREY); );
+            }
+        }
+
+        unsetenv("OAT_FRAME_PAGES");
+    }
+}
+
+SCENARIO ("Position batches cross a node in a single write.", "[Source]") {
+
+    GIVEN ("A bound Sink<PositionBatch> and a connected Source<PositionBatch>") {
+
+        oat::Sink<oat::PositionBatch> sink;
+        oat::Source<oat::PositionBatch> source;
+
+        sink.bind(node_addr, node_addr);
+        oat::PositionBatch *shared = sink.retrieve();
+
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink writes a batch of 10 positions") {
+
+            oat::PositionBatch batch("internal");
+            for (int i = 0; i < 10; i++) {
+                oat::Position2D p("p");
+                p.position_valid = true;
+                p.position = oat::Point2D(i, -i);
+                batch.push_back(p);
+            }
+
+            sink.wait();
+            *shared = batch;
+            sink.post();
+
+            THEN ("The source reads all 10 positions after one wait()") {
+
+                REQUIRE( source.wait() == oat::NodeState::SINK_BOUND );
+                oat::PositionBatch read("read");
+                read = *source.retrieve();
+                source.post();
+
+                REQUIRE( read.size() == 10 );
+                for (size_t i = 0; i < read.size(); i++) {
+                    REQUIRE( read[i].position_valid );
+                    REQUIRE( read[i].position.x == i );
+                    REQUIRE( read[i].position.y == -static_cast<double>(i) );
+                }
+
+                INFO ("The copy keeps its own label");
+                REQUIRE( std::string(read.label()) == "read" );
+            }
+        }
+
+        WHEN ("A batch is filled past its capacity") {
+
+            oat::PositionBatch batch("internal");
+            while (!batch.full())
+                batch.push_back(oat::Position2D("p"));
+
+            THEN ("push_back() shall throw") {
+                REQUIRE_THROWS( batch.push_back(oat::Position2D("p")); );
+            }
+        }
+    }
+}
+
 // TODO: specialization tests
@@ -23,6 +23,11 @@
 #include <chrono>
 #include <future>
 #include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/Source.h"
@@ -72,6 +77,30 @@ namespace oat { volatile sig_atomic_t quit = 0; }
 //            3. A source connects
 //            4. The source attempts to enter the critical section
 //        - Then, the source shall block until the sink enters/exits the critical section
+//
+//### A frame sink with a ring of depth N may run N writes ahead of its slowest source
+//- Given a Sink<Frame> bound with depth 3 and a connected Source<Frame>
+//    - When the sink writes 3 frames that the source has not read
+//        - Then, the sink shall block on its 4th wait until the source post()s
+//        - Then, the source shall read the frames in the order they were written
+//
+//### Lossy sources never hold back the sink
+//- Given a sink, a synchronous source, and a lossy source
+//    - When the sink writes and only the synchronous source reads
+//        - Then, the sink shall be able to write again
+//        - Then, the lossy source shall read the most recent write
+//
+//### Frame leases post their source when they are destroyed
+//- Given a Sink<Frame> bound with depth 2 and a connected Source<Frame>
+//    - When the source holds a lease on the first frame
+//        - Then, the lease shall view the shared frame without copying it
+//        - Then, the sink shall be able to write the second frame
+//        - Then, the sink shall block on its third wait until the lease is destroyed
+//
+//### A sink can fan out to every slot of a node while sources come and go
+//- Given a sink and Node::DEFAULT_SLOTS sources reading on their own threads
+//    - When half of the sources leave part way through and are replaced
+//        - Then, every source shall read consecutive writes, in order, until it leaves
 
 using msec = std::chrono::milliseconds;
 const std::string node_addr = "test";
@@ -525,3 +554,305 @@ SCENARIO ("Sources attaching or detaching during source or sink wait() periods "
         }
     }
 }
+
+SCENARIO ("A frame sink with a ring of depth N may run N writes ahead of its "
+          "slowest source.", "[Sink, Source, Concurrency, Frame]") {
+
+    GIVEN ("A Sink<Frame> bound with depth 3 and a connected Source<Frame>") {
+
+        const size_t depth {3};
+        oat::Sink<oat::Frame> sink;
+        oat::Source<oat::Frame> source;
+
+        sink.bind(node_addr, 100, depth);
+        oat::Frame *frame = sink.retrieve(10, 10, CV_8UC1, oat::PIX_GREY);
+
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink writes 3 frames that the source has not read") {
+
+            for (size_t i = 0; i < depth; i++) {
+                REQUIRE_NOTHROW(sink.wait());
+                frame->data[0] = static_cast<unsigned char>(i);
+                frame->incrementSampleCount();
+                REQUIRE_NOTHROW(sink.post());
+            }
+
+            THEN ("The sink shall block on its 4th wait until the source post()s") {
+
+                auto fut = std::async(std::launch::async, [&sink]{ sink.wait(); });
+
+                // Pause for 5 ms
+                std::this_thread::sleep_for(msec(5));
+
+                // Check to see that the sink has not stopped waiting
+                auto status = fut.wait_for(msec(0));
+                REQUIRE(status != std::future_status::ready);
+
+                REQUIRE_NOTHROW(source.wait());
+                REQUIRE_NOTHROW(source.post());
+
+                // Give sufficient time for wait to release
+                std::this_thread::sleep_for(msec(1));
+                status = fut.wait_for(msec(0));
+                REQUIRE(status == std::future_status::ready);
+                REQUIRE_NOTHROW(sink.post());
+            }
+
+            THEN ("The source shall read the frames in the order they were "
+                  "written") {
+
+                for (size_t i = 0; i < depth; i++) {
+                    REQUIRE_NOTHROW(source.wait());
+                    REQUIRE(source.retrieve()->data[0] == i);
+                    REQUIRE(source.retrieve()->sample_count() == i + 1);
+                    REQUIRE_NOTHROW(source.post());
+                }
+            }
+        }
+    }
+}
+
+SCENARIO ("Lossy sources never hold back the sink.", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink, a synchronous source, and a lossy source") {
+
+        oat::Sink<int> sink;
+        oat::Source<int> source, lossy;
+
+        sink.bind(node_addr);
+        int *shared = sink.retrieve();
+
+        source.touch(node_addr);
+        lossy.touch(node_addr, oat::SourceMode::LOSSY);
+        source.connect();
+
+        WHEN ("The sink writes and only the synchronous source reads") {
+
+            for (int i = 1; i <= 3; i++) {
+                REQUIRE_NOTHROW(sink.wait());
+                *shared = i;
+                REQUIRE_NOTHROW(sink.post());
+                REQUIRE_NOTHROW(source.wait());
+                REQUIRE_NOTHROW(source.post());
+            }
+
+            THEN ("The sink shall be able to write again") {
+
+                auto fut = std::async(std::launch::async, [&sink]{ sink.wait(); });
+                REQUIRE(fut.wait_for(msec(5)) == std::future_status::ready);
+                REQUIRE_NOTHROW(sink.post());
+            }
+
+            THEN ("The lossy source shall read the most recent write") {
+
+                REQUIRE(lossy.connect() == oat::SourceState::CONNECTED);
+                REQUIRE_NOTHROW(lossy.wait());
+                REQUIRE(lossy.clone() == 3);
+                REQUIRE_NOTHROW(lossy.post());
+
+                // No new writes, so the next wait() blocks
+                auto fut = std::async(std::launch::async, [&lossy]{ lossy.wait(); });
+                std::this_thread::sleep_for(msec(5));
+                REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+                REQUIRE_NOTHROW(sink.wait());
+                *shared = 4;
+                REQUIRE_NOTHROW(sink.post());
+
+                REQUIRE(fut.wait_for(msec(5)) == std::future_status::ready);
+                REQUIRE(lossy.clone() == 4);
+                REQUIRE_NOTHROW(lossy.post());
+            }
+        }
+    }
+}
+
+SCENARIO ("Frame leases post their source when they are destroyed.",
+          "[Sink, Source, Concurrency, Frame]") {
+
+    GIVEN ("A Sink<Frame> bound with depth 2 and a connected Source<Frame>") {
+
+        oat::Sink<oat::Frame> sink;
+        oat::Source<oat::Frame> source;
+
+        sink.bind(node_addr, 100, 2);
+        oat::Frame *frame = sink.retrieve(10, 10, CV_8UC1, oat::PIX_GREY);
+
+        source.touch(node_addr);
+        source.connect();
+
+        REQUIRE_NOTHROW(sink.wait());
+        frame->data[0] = 42;
+        REQUIRE_NOTHROW(sink.post());
+
+        WHEN ("The source holds a lease on the first frame") {
+
+            auto lease = source.lease();
+            REQUIRE(lease.state() == oat::NodeState::SINK_BOUND);
+
+            THEN ("The lease shall view the shared frame without copying it") {
+                REQUIRE(lease->data == source.retrieve()->data);
+                REQUIRE(lease->data[0] == 42);
+            }
+
+            THEN ("The sink shall be able to write the second frame") {
+
+                REQUIRE_NOTHROW(sink.wait());
+                REQUIRE(frame->data != lease->data);
+                frame->data[0] = 43;
+                REQUIRE_NOTHROW(sink.post());
+                REQUIRE(lease->data[0] == 42);
+            }
+
+            THEN ("The sink shall block on its third wait until the lease is "
+                  "destroyed") {
+
+                REQUIRE_NOTHROW(sink.wait());
+                REQUIRE_NOTHROW(sink.post());
+
+                auto fut = std::async(std::launch::async, [&sink]{ sink.wait(); });
+                std::this_thread::sleep_for(msec(5));
+                REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+                {
+                    auto moved = std::move(lease);
+                }
+
+                REQUIRE(fut.wait_for(msec(5)) == std::future_status::ready);
+                REQUIRE_NOTHROW(sink.post());
+
+                // The source can lease the next frame
+                REQUIRE(source.lease().state() == oat::NodeState::SINK_BOUND);
+            }
+        }
+    }
+}
+
+SCENARIO ("A sink can fan out to every slot of a node while sources come and "
+          "go.", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink and Node::DEFAULT_SLOTS sources reading on their own "
+           "threads") {
+
+        const size_t num_sources = oat::Node::DEFAULT_SLOTS;
+        const int num_writes = 200;
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+        int *shared = sink.retrieve();
+
+        // Reads up to max_reads consecutive writes and returns the number of
+        // reads that were out of order
+        auto reader = [](int max_reads) {
+            oat::Source<int> source;
+            source.touch(node_addr);
+            source.connect();
+
+            int errors = 0, last = -1;
+            for (int i = 0; i < max_reads; i++) {
+                if (source.wait() == oat::NodeState::END)
+                    break;
+                int value = source.clone();
+                if (last >= 0 && value != last + 1)
+                    errors++;
+                last = value;
+                source.post();
+            }
+
+            return errors;
+        };
+
+        WHEN ("Half of the sources leave part way through and are replaced") {
+
+            std::vector<std::future<int>> readers;
+            for (size_t i = 0; i < num_sources; i++)
+                readers.push_back(std::async(std::launch::async, reader,
+                                             i % 2 ? num_writes / 4 : num_writes));
+
+            auto writer = std::async(std::launch::async, [&] {
+                for (int i = 0; i < num_writes; i++) {
+                    sink.wait();
+                    *shared = i;
+                    sink.post();
+
+                    // Replace sources that have left
+                    if (i == num_writes / 2) {
+                        for (size_t j = 1; j < num_sources; j += 2)
+                            readers.push_back(std::async(std::launch::async,
+                                                         reader, num_writes / 4));
+                    }
+                }
+            });
+
+            THEN ("Every source shall read consecutive writes, in order, "
+                  "until it leaves") {
+
+                REQUIRE(writer.wait_for(std::chrono::seconds(20))
+                        == std::future_status::ready);
+
+                // Release sources that are still waiting
+                oat::quit = 1;
+                oat::wakeForShutdown();
+
+                int errors = 0;
+                for (auto &r : readers)
+                    errors += r.get();
+                REQUIRE(errors == 0);
+
+                oat::quit = 0;
+            }
+        }
+    }
+}
+
+SCENARIO ("A sink recovers from a source whose process is killed while it "
+          "owes a read.", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink and a source in a child process") {
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+        int *shared = sink.retrieve();
+
+        int ready[2];
+        REQUIRE (pipe(ready) == 0);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            oat::Source<int> source;
+            source.touch(node_addr);
+            source.connect();
+            const bool ok = write(ready[1], "x", 1) == 1;
+
+            // Die holding the slot
+            raise(SIGKILL);
+            _exit(ok ? 0 : 1);
+        }
+
+        char c;
+        REQUIRE (read(ready[0], &c, 1) == 1);
+        close(ready[0]);
+        close(ready[1]);
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        REQUIRE (WIFSIGNALED(status));
+
+        WHEN ("The sink writes and the dead source never reads") {
+
+            REQUIRE_NOTHROW(sink.wait());
+            *shared = 1;
+            REQUIRE_NOTHROW(sink.post());
+
+            THEN ("The sink shall be able to write again after the watchdog "
+                  "releases the source's slot") {
+
+                auto fut = std::async(std::launch::async, [&sink]{ sink.wait(); });
+                REQUIRE(fut.wait_for(msec(2000)) == std::future_status::ready);
+                REQUIRE_NOTHROW(sink.post());
+            }
+        }
+    }
+}